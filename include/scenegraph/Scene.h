@@ -6,6 +6,8 @@
 #include <scenegraph/SceneObject.h>
 #include <scenegraph/Component.h>
 #include <scenegraph/SceneString.h>
+#include <scenegraph/spatial/SpatialGrid2D.h>
+#include <scenegraph/spatial/BoundingVolumeHierarchy.h>
 
 #include <memory>
 #include <string_view>
@@ -49,6 +51,30 @@ public:
 	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
 	bool ForEachObject(Handler&& handler) noexcept;
 	
+	// Index of world bounds of objects with Bounds2DComponent, updated by Bounds2DComponent::UpdateHierarchy
+	SpatialGrid2D& GetSpatialIndex2D() noexcept;
+	
+	// void Handler(SceneObject sceneObject, bool& stop)
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QueryPoint(Vector2 p, Handler&& handler) noexcept;
+	
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QueryRect(const Rect& r, Handler&& handler) noexcept;
+	
+	// Hierarchy of world bounds of objects with BoundsComponent, updated by BoundsComponent::UpdateHierarchy
+	BoundingVolumeHierarchy& GetSpatialIndex3D() noexcept;
+	
+	// void Handler(SceneObject sceneObject, bool& stop)
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QueryFrustum(const Frustum& frustum, Handler&& handler) noexcept;
+	
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QuerySphere(const Sphere& sphere, Handler&& handler) noexcept;
+	
+	// void Handler(SceneObject sceneObject, float distance, bool& stop)
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, float, bool&>>>
+	bool RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, Handler&& handler) noexcept;
+	
 private:
 	using EnumObjectsCallback = void(*)(SceneObject sceneObject, bool& stop, void* context);
 	
@@ -56,6 +82,8 @@ private:
 	
 private:
 	std::unique_ptr<SceneNode> _root;
+	std::unique_ptr<SpatialGrid2D> _spatialIndex2D;
+	std::unique_ptr<BoundingVolumeHierarchy> _spatialIndex3D;
 };
 
 #include "Scene.inl"
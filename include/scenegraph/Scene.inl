@@ -16,3 +16,28 @@ bool Scene::ForEachObject(Handler&& handler) noexcept {
 		},
 		std::addressof(handler));
 }
+
+template <typename Handler, typename>
+bool Scene::QueryPoint(Vector2 p, Handler&& handler) noexcept {
+	return GetSpatialIndex2D().QueryPoint(p, std::forward<Handler>(handler));
+}
+
+template <typename Handler, typename>
+bool Scene::QueryRect(const Rect& r, Handler&& handler) noexcept {
+	return GetSpatialIndex2D().QueryRect(r, std::forward<Handler>(handler));
+}
+
+template <typename Handler, typename>
+bool Scene::QueryFrustum(const Frustum& frustum, Handler&& handler) noexcept {
+	return GetSpatialIndex3D().QueryFrustum(frustum, std::forward<Handler>(handler));
+}
+
+template <typename Handler, typename>
+bool Scene::QuerySphere(const Sphere& sphere, Handler&& handler) noexcept {
+	return GetSpatialIndex3D().QuerySphere(sphere, std::forward<Handler>(handler));
+}
+
+template <typename Handler, typename>
+bool Scene::RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, Handler&& handler) noexcept {
+	return GetSpatialIndex3D().RayCast(origin, direction, maxDistance, std::forward<Handler>(handler));
+}
@@ -2,9 +2,16 @@
 
 #include <scenegraph/gpu/Buffer.h>
 #include <scenegraph/gpu/TransferBuffer.h>
+#include <scenegraph/gpu/GpuDevice.h>
 
 #include <memory>
 
+enum class GpuBackend {
+	Sdl,
+	// Headless device keeping resources in memory, for tests and benchmarks without a GPU
+	Null
+};
+
 ///
 /// System context
 ///
@@ -14,9 +21,11 @@ public:
 	
 	~SystemContext();
 	
-	bool Initialize();
+	bool Initialize(GpuBackend backend = GpuBackend::Sdl);
 	void Finalize();
 	
+	GpuDevice* GetGpuDevice() const noexcept { return _gpuDevice.get(); }
+	
 	Buffer CreateBuffer() noexcept;
 	TransferBuffer CreateTransferBuffer() noexcept;
 	
@@ -32,6 +41,7 @@ private:
 	bool _initialized = false;
 	void* _device = nullptr;
 	void* _window = nullptr;
+	std::unique_ptr<GpuDevice> _gpuDevice;
 	
 	inline static std::unique_ptr<SystemContext> _instance;
 };
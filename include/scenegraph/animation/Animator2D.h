@@ -0,0 +1,119 @@
+#pragma once
+
+#include <scenegraph/animation/Easing.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Transform2DComponent;
+class ThreadPool;
+
+// Animated field of Transform2D
+enum class Transform2DChannel : uint8_t {
+	ScaleX,
+	ScaleY,
+	ShearX,
+	ShearY,
+	Rotation,
+	TranslationX,
+	TranslationY,
+};
+
+///
+/// Keyframe animation of local transforms of Transform2DComponent
+///
+/// Clips are immutable sets of keyframe tracks shared by any number of playing instances. Keyframes of all clips
+/// live in one array and playing instances in another dense one, so playing does not allocate once arrays have
+/// grown. Update evaluates instances in chunks, in parallel when given a thread pool. A component is animated by
+/// at most one instance, which is found by the id kept in the component, so playing a clip on an animated component
+/// replaces the old instance. Only components with changed values are written and marked dirty. Targets must outlive
+/// their instances, stop instances before removing the components.
+///
+class Animator2D {
+public:
+	using ClipId = uint32_t;
+	using InstanceId = uint32_t;
+	
+	static constexpr ClipId kInvalidClip = UINT32_MAX;
+	static constexpr InstanceId kInvalidInstance = UINT32_MAX;
+	
+	struct Keyframe {
+		float time;
+		float value;
+		// Easing of the segment from this keyframe to the next one
+		Easing easing;
+	};
+	
+	struct Track {
+		Transform2DChannel channel;
+		// Sorted by time
+		const Keyframe* keyframes;
+		size_t count;
+	};
+	
+	Animator2D() = default;
+	
+	Animator2D(const Animator2D&) = delete;
+	Animator2D& operator=(const Animator2D&) = delete;
+	
+	// Duration of the clip is the time of its last keyframe. Returns kInvalidClip for empty or unsorted tracks
+	ClipId CreateClip(const Track* tracks, size_t count) noexcept;
+	float GetClipDuration(ClipId clip) const noexcept;
+	
+	// Negative speed plays the clip backwards from its end
+	InstanceId Play(ClipId clip, Transform2DComponent* target, bool loop = false, float speed = 1) noexcept;
+	void Stop(InstanceId instance) noexcept;
+	bool IsPlaying(InstanceId instance) const noexcept;
+	
+	size_t Size() const noexcept { return _instances.size(); }
+	
+	// Advances all instances by delta time in seconds and removes finished ones, must be called by the thread pumping the pool
+	void Update(float dt, ThreadPool* threadPool = nullptr) noexcept;
+	
+private:
+	struct Clip {
+		uint32_t firstTrack;
+		uint32_t trackCount;
+		float duration;
+	};
+	
+	struct ClipTrack {
+		uint32_t firstKeyframe;
+		uint32_t keyframeCount;
+		Transform2DChannel channel;
+	};
+	
+	// Instance ids are slot indices with generation in the high bits, so ids of stopped instances go stale
+	static constexpr uint32_t kSlotBits = 24;
+	static constexpr uint32_t kSlotMask = (1u << kSlotBits) - 1;
+	
+	struct Slot {
+		uint32_t index;
+		uint32_t generation;
+	};
+	
+	struct Instance {
+		Transform2DComponent* target;
+		ClipId clip;
+		float time;
+		float speed;
+		bool loop;
+		bool finished;
+	};
+	
+	void Evaluate(size_t begin, size_t end, float dt) noexcept;
+	float Sample(const ClipTrack& track, float time) const noexcept;
+	void Remove(size_t index) noexcept;
+	
+private:
+	std::vector<Clip> _clips;
+	std::vector<ClipTrack> _tracks;
+	std::vector<Keyframe> _keyframes;
+	
+	std::vector<Instance> _instances;
+	// Dense index to id and slot of id to dense index
+	std::vector<InstanceId> _instanceIds;
+	std::vector<Slot> _slots;
+	std::vector<uint32_t> _freeSlots;
+};
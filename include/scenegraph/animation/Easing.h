@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+enum class Easing : uint8_t {
+	Step,       // Holds the start value until the end of the segment
+	Linear,
+	QuadIn,
+	QuadOut,
+	QuadInOut,
+	CubicIn,
+	CubicOut,
+	CubicInOut,
+	SineInOut,
+	BackOut,    // Overshoots the end value before settling
+};
+
+// Maps normalized time in [0, 1] to interpolation factor, 0 at the start and 1 at the end
+float Ease(Easing easing, float t) noexcept;
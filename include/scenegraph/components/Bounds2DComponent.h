@@ -0,0 +1,42 @@
+#pragma once
+
+#include <scenegraph/Component.h>
+#include <scenegraph/SceneObject.h>
+#include <scenegraph/math/Rect.h>
+#include <scenegraph/spatial/SpatialGrid2D.h>
+
+#include <vector>
+
+///
+/// Bounds of a 2D scene object in its local space
+///
+/// World bounds are the local ones transformed by the world transform of Transform2DComponent of the object
+/// or its nearest parent. Subtree bounds also enclose bounds of all children, objects without the component
+/// pass bounds of their children through, so culling skips whole subtrees outside the view.
+/// World bounds are also kept in the spatial index of the scene for point and rectangle queries.
+///
+class Bounds2DComponent final : public ComponentImpl<Bounds2DComponent> {
+public:
+	DEFINE_COMPONENT_TYPE(Bounds2DComponent)
+	
+	Rect localBounds = RectMakeEmpty();
+	
+	const Rect& GetWorldBounds() const noexcept { return _worldBounds; }
+	const Rect& GetSubtreeBounds() const noexcept { return _subtreeBounds; }
+	
+	// Updates world and subtree bounds of all children of the root bottom-up, world transforms must be applied first
+	static void UpdateHierarchy(SceneObject root) noexcept;
+	// Appends children of the root with world bounds intersecting the view in preorder
+	static void Cull(SceneObject root, const Rect& view, std::vector<SceneObject>& visible) noexcept;
+
+private:
+	friend Super;
+	
+	void Added(SceneObject sceneObject) noexcept;
+	void Removed(SceneObject sceneObject) noexcept;
+	
+private:
+	SpatialGrid2D::ProxyId _proxy = SpatialGrid2D::kInvalidProxy;
+	Rect _worldBounds = RectMakeEmpty();
+	Rect _subtreeBounds = RectMakeEmpty();
+};
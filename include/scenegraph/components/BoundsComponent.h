@@ -0,0 +1,48 @@
+#pragma once
+
+#include <scenegraph/Component.h>
+#include <scenegraph/SceneObject.h>
+#include <scenegraph/math/AABB.h>
+#include <scenegraph/math/Sphere.h>
+#include <scenegraph/spatial/BoundingVolumeHierarchy.h>
+
+#include <vector>
+
+struct Frustum;
+
+///
+/// Bounds of a 3D scene object in its local space
+///
+/// World bounds are the local ones transformed by the world matrix of TransformComponent of the object
+/// or its nearest parent. Subtree bounds also enclose bounds of all children, objects without the component
+/// pass bounds of their children through, so culling skips whole subtrees outside the frustum. Non-empty world bounds are also kept in the bounding
+/// volume hierarchy of the scene for frustum, sphere and ray queries.
+///
+class BoundsComponent final : public ComponentImpl<BoundsComponent> {
+public:
+	DEFINE_COMPONENT_TYPE(BoundsComponent)
+	
+	AABB localBounds = AABBMakeEmpty();
+	
+	const AABB& GetWorldBounds() const noexcept { return _worldBounds; }
+	const Sphere& GetWorldSphere() const noexcept { return _worldSphere; }
+	const AABB& GetSubtreeBounds() const noexcept { return _subtreeBounds; }
+	
+	// Updates world and subtree bounds of all children of the root bottom-up, world matrices must be updated first
+	static void UpdateHierarchy(SceneObject root) noexcept;
+	// Appends children of the root with world bounds inside or intersecting the frustum in preorder
+	static void Cull(SceneObject root, const Frustum& frustum, std::vector<SceneObject>& visible) noexcept;
+
+private:
+	friend Super;
+	
+	void Removed(SceneObject sceneObject) noexcept;
+	
+	void UpdateProxy(SceneObject sceneObject, BoundingVolumeHierarchy& index, const AABB& worldBounds) noexcept;
+	
+private:
+	BoundingVolumeHierarchy::ProxyId _proxy = BoundingVolumeHierarchy::kInvalidProxy;
+	AABB _worldBounds = AABBMakeEmpty();
+	Sphere _worldSphere = SphereMake(Vector3MakeZero(), 0);
+	AABB _subtreeBounds = AABBMakeEmpty();
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Versions of component state are taken from one counter, so they are unique among all components and never zero.
+// Components may be updated on several threads at once, versions only need to be unique
+inline uint64_t ComponentVersionNext() noexcept {
+	static constinit std::atomic<uint64_t> counter = 0;
+	return counter.fetch_add(1, std::memory_order::relaxed) + 1;
+}
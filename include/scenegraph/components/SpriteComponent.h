@@ -0,0 +1,43 @@
+#pragma once
+
+#include <scenegraph/Component.h>
+#include <scenegraph/components/ComponentVersion.h>
+#include <scenegraph/math/Vector2.h>
+#include <scenegraph/math/Rect.h>
+#include <scenegraph/imaging/Color.h>
+
+#include <cstdint>
+
+///
+/// Textured quad drawn with the world transform of Transform2DComponent of the object or its nearest parent
+///
+/// Texture and pipeline are opaque handles of the GPU backend, sprites sharing both are drawn with one call.
+/// Hidden sprites hide their children too. Writers of the fields mark the sprite dirty, which gives it a new version
+/// unique among all components, so caches of instance data can tell it changed.
+///
+class SpriteComponent final : public ComponentImpl<SpriteComponent> {
+public:
+	DEFINE_COMPONENT_TYPE(SpriteComponent)
+	
+	void* texture = nullptr;
+	void* pipeline = nullptr;
+	
+	// Size of the quad in local units and its origin in fractions of the size
+	Vector2 size = Vector2Make(1, 1);
+	Vector2 pivot = Vector2Make(0.5f, 0.5f);
+	
+	FloatColor color = FloatColorMakeWhite();
+	// Normalized texture coordinates
+	Rect textureRect = RectMake(Vector2MakeZero(), Vector2Make(1, 1));
+	
+	bool visible = true;
+	
+	void MarkDirty() noexcept { _version = ComponentVersionNext(); }
+	uint64_t GetVersion() const noexcept { return _version; }
+
+private:
+	friend Super;
+	
+private:
+	uint64_t _version = ComponentVersionNext();
+};
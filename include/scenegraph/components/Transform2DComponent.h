@@ -5,42 +5,45 @@
 #include <scenegraph/math/Transform2D.h>
 #include <scenegraph/math/Matrix32.h>
 
+#include <cstdint>
+
+///
+/// Transform of a 2D scene object relative to the nearest parent with the component
+///
+/// Writers of the local transform mark it dirty, UpdateHierarchy then recomputes world transforms only when
+/// the local one or the world transform of the parent has changed. World versions are unique among all
+/// components, so comparing the version of the parent with the remembered one also detects reparenting.
+/// Apply message recomputes the world transform unconditionally.
+///
 class Transform2DComponent final : public ComponentImpl<Transform2DComponent> {
 public:
 	DEFINE_COMPONENT_TYPE(Transform2DComponent)
 	
 	Transform2D localTransform = Transform2DMakeIdentity();
 	
+	void MarkDirty() noexcept { _dirty = true; }
+	bool IsDirty() const noexcept { return _dirty; }
+	
 	const Matrix32& GetWorldTransform() const noexcept { return _worldTransform; }
+	uint64_t GetWorldVersion() const noexcept { return _worldVersion; }
+	
+	// Updates changed world transforms of the root and all its children in preorder
+	static void UpdateHierarchy(SceneObject root) noexcept;
 
 private:
 	friend Super;
+	friend class Animator2D;
 	
-	void Apply(SceneObject sceneObject) noexcept {
-		CalculateWorldTransform(sceneObject);
-	}
+	void Apply(SceneObject sceneObject) noexcept;
 	
 private:
-	void CalculateWorldTransform(SceneObject sceneObject) noexcept {
-		_worldTransform = Matrix32MakeWithTransform2D(localTransform);
-		
-#if 0
-		sceneObject.ForEachComponentInParent<Transform2DComponent>(
-			[this](SceneObject, Transform2DComponent* parentTransform, bool& stop) {
-				_worldTransform = parentTransform->_worldTransform * _worldTransform;
-				stop = true;
-			});
-#else
-		auto parent = sceneObject;
-		while ((parent = parent.Parent())) {
-			if (auto parentTransform = parent.FindComponent<Transform2DComponent>()) {
-				_worldTransform = parentTransform->_worldTransform * _worldTransform;
-				break;
-			}
-		}
-#endif
-	}
+	void UpdateWorldTransform(const Transform2DComponent* parent, bool force) noexcept;
 	
 private:
 	Matrix32 _worldTransform = Matrix32MakeIdentity();
+	uint64_t _worldVersion = 0;
+	uint64_t _parentVersion = 0;
+	// Id of the Animator2D instance playing on the component
+	uint32_t _animationInstance = UINT32_MAX;
+	bool _dirty = true;
 };
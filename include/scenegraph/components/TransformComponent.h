@@ -1,12 +1,61 @@
 #pragma once
 
 #include <scenegraph/Component.h>
+#include <scenegraph/SceneObject.h>
 #include <scenegraph/math/Transform.h>
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/math/Quaternion.h>
+#include <scenegraph/math/Matrix43.h>
 
-class TransformComponent : public ComponentImpl<TransformComponent> {
+#include <cstdint>
+
+///
+/// Transform of a 3D scene object relative to the nearest parent with the component
+///
+/// Scale is applied first, then rotation, then translation, so matrices are affine and kept as Matrix43.
+/// Setters mark the local matrix dirty, world matrix is recomputed only when the local one or the world matrix
+/// of the parent has changed since the last update. Every recomputation takes a new world version unique among
+/// all components, so comparing the version of the parent with the remembered one also detects reparenting.
+///
+class TransformComponent final : public ComponentImpl<TransformComponent> {
 public:
 	DEFINE_COMPONENT_TYPE(TransformComponent)
-
+	
+	const Vector3& GetTranslation() const noexcept { return _translation; }
+	const Quaternion& GetRotation() const noexcept { return _rotation; }
+	const Vector3& GetScale() const noexcept { return _scale; }
+	
+	void SetTranslation(const Vector3& translation) noexcept { _translation = translation; _localDirty = true; }
+	// Rotation is expected to be normalized
+	void SetRotation(const Quaternion& rotation) noexcept { _rotation = rotation; _localDirty = true; }
+	void SetScale(const Vector3& scale) noexcept { _scale = scale; _localDirty = true; }
+	// Euler angles are converted to rotation in X, Y, Z order
+	void SetLocalTransform(const Transform& transform) noexcept;
+	
+	bool IsLocalDirty() const noexcept { return _localDirty; }
+	
+	// Matrices are valid after the last update of the hierarchy, Matrix43ToMatrix4 converts them for upload
+	const Matrix43& GetLocalMatrix() const noexcept { return _localMatrix; }
+	const Matrix43& GetWorldMatrix() const noexcept { return _worldMatrix; }
+	uint64_t GetWorldVersion() const noexcept { return _worldVersion; }
+	
+	// Updates changed world matrices of the root and all its children in preorder
+	static void UpdateHierarchy(SceneObject root) noexcept;
+	
 private:
 	friend Super;
+	
+	void Apply(SceneObject sceneObject) noexcept;
+	
+	void UpdateWorldMatrix(const TransformComponent* parent) noexcept;
+	
+private:
+	Vector3 _translation = Vector3MakeZero();
+	Quaternion _rotation = QuaternionMakeIdentity();
+	Vector3 _scale = Vector3MakeOne();
+	Matrix43 _localMatrix = Matrix43MakeIdentity();
+	Matrix43 _worldMatrix = Matrix43MakeIdentity();
+	uint64_t _worldVersion = 0;
+	uint64_t _parentVersion = 0;
+	bool _localDirty = true;
 };
@@ -19,7 +19,7 @@ enum class BufferUsage {
 ///
 class Buffer : public Resource {
 public:
-	explicit Buffer(void* device) : Resource(device)
+	explicit Buffer(GpuDevice* device) : Resource(device)
 	{
 	}
 	
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <scenegraph/gpu/Buffer.h>
+#include <scenegraph/gpu/Pipeline.h>
+#include <scenegraph/gpu/Shader.h>
+#include <scenegraph/gpu/TransferBuffer.h>
+#include <scenegraph/gpu/UploadDevice.h>
+
+#include <cstddef>
+#include <cstdint>
+
+///
+/// Backend of GPU resources, pipelines, copies and submission
+///
+/// Buffer, TransferBuffer, PipelineCache and the upload path go through it, so the render path runs against SdlGpuDevice on a GPU
+/// or against NullGpuDevice without one. Handles are opaque, those of SdlGpuDevice are SDL objects.
+///
+class GpuDevice {
+public:
+	virtual ~GpuDevice() = default;
+	
+	virtual void* CreateBuffer(BufferUsage usage, uint32_t size) noexcept = 0;
+	virtual void ReleaseBuffer(void* buffer) noexcept = 0;
+	
+	virtual void* CreateTransferBuffer(TransferBufferUsage usage, uint32_t size) noexcept = 0;
+	virtual void ReleaseTransferBuffer(void* transferBuffer) noexcept = 0;
+	
+	// Cycling gives fresh memory when the GPU may still read the buffer
+	virtual void* MapTransferBuffer(void* transferBuffer, bool cycle) noexcept = 0;
+	virtual void UnmapTransferBuffer(void* transferBuffer) noexcept = 0;
+	
+	// Formats of compiled shaders the device takes
+	virtual ShaderFormat GetShaderFormats() noexcept = 0;
+	virtual void* CreateShader(const ShaderCreateInfo& createInfo) noexcept = 0;
+	virtual void ReleaseShader(void* shader) noexcept = 0;
+	
+	virtual void* CreateGraphicsPipeline(const PipelineState& state) noexcept = 0;
+	virtual void ReleaseGraphicsPipeline(void* pipeline) noexcept = 0;
+	
+	virtual void* AcquireCommandBuffer() noexcept = 0;
+	
+	// Records all regions in one copy pass, transfer buffers of regions are handles
+	virtual void UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept = 0;
+	
+	// Submits the command buffer and returns the fence signaled on its completion
+	virtual void* Submit(void* commandBuffer) noexcept = 0;
+	virtual bool IsFenceSignaled(void* fence) noexcept = 0;
+	virtual void WaitForFence(void* fence) noexcept = 0;
+	virtual void ReleaseFence(void* fence) noexcept = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <scenegraph/gpu/GpuDevice.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+enum class NullGpuCommandType : uint8_t {
+	CreateBuffer,
+	ReleaseBuffer,
+	CreateTransferBuffer,
+	ReleaseTransferBuffer,
+	MapTransferBuffer,
+	UnmapTransferBuffer,
+	CreateShader,
+	ReleaseShader,
+	CreateGraphicsPipeline,
+	ReleaseGraphicsPipeline,
+	AcquireCommandBuffer,
+	Upload,
+	Submit
+};
+
+const char* NullGpuCommandTypeName(NullGpuCommandType type) noexcept;
+
+///
+/// Call made to NullGpuDevice, copies name their source and destination, the rest only the object
+///
+struct NullGpuCommand {
+	NullGpuCommandType type;
+	const void* object;
+	uint32_t offset;
+	const void* destination;
+	uint32_t destinationOffset;
+	uint32_t size;
+};
+
+///
+/// GPU device without a GPU, buffers are kept in memory and copies are executed on submit
+///
+/// Render code runs on machines without a GPU unchanged, so its CPU cost can be profiled and its results checked by
+/// reading buffers back. Every call is appended to the command log, which tests compare against the expected
+/// stream, recording can be turned off for benchmarks. Fences are signaled on submit.
+///
+class NullGpuDevice final : public GpuDevice {
+public:
+	NullGpuDevice() noexcept = default;
+	~NullGpuDevice() override;
+	
+	NullGpuDevice(const NullGpuDevice&) = delete;
+	NullGpuDevice& operator=(const NullGpuDevice&) = delete;
+	
+	void* CreateBuffer(BufferUsage usage, uint32_t size) noexcept override;
+	void ReleaseBuffer(void* buffer) noexcept override;
+	
+	void* CreateTransferBuffer(TransferBufferUsage usage, uint32_t size) noexcept override;
+	void ReleaseTransferBuffer(void* transferBuffer) noexcept override;
+	
+	void* MapTransferBuffer(void* transferBuffer, bool cycle) noexcept override;
+	void UnmapTransferBuffer(void* transferBuffer) noexcept override;
+	
+	ShaderFormat GetShaderFormats() noexcept override;
+	void* CreateShader(const ShaderCreateInfo& createInfo) noexcept override;
+	void ReleaseShader(void* shader) noexcept override;
+	
+	void* CreateGraphicsPipeline(const PipelineState& state) noexcept override;
+	void ReleaseGraphicsPipeline(void* pipeline) noexcept override;
+	
+	void* AcquireCommandBuffer() noexcept override;
+	
+	void UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept override;
+	
+	void* Submit(void* commandBuffer) noexcept override;
+	bool IsFenceSignaled(void* fence) noexcept override;
+	void WaitForFence(void* fence) noexcept override;
+	void ReleaseFence(void* fence) noexcept override;
+	
+	// Contents of a buffer or a transfer buffer
+	const std::byte* GetData(const void* object) const noexcept;
+	uint32_t GetSize(const void* object) const noexcept;
+	
+	// Number of buffers, transfer buffers, shaders, pipelines and command buffers not released or submitted
+	size_t GetObjectCount() const noexcept { return _memory.size() + _objects.size() + _commandBuffers.size(); }
+	
+	void SetRecording(bool recording) noexcept { _recording = recording; }
+	const std::vector<NullGpuCommand>& GetCommands() const noexcept { return _commands; }
+	void ClearCommands() noexcept { _commands.clear(); }
+	
+private:
+	struct Memory {
+		std::unique_ptr<std::byte[]> data;
+		uint32_t size;
+		bool mapped;
+	};
+	
+	void* CreateObject() noexcept;
+	void ReleaseObject(void* object) noexcept;
+	
+	void* CreateMemory(uint32_t size) noexcept;
+	void ReleaseMemory(void* object) noexcept;
+	
+	void Record(NullGpuCommandType type, const void* object, uint32_t size = 0) noexcept;
+	
+private:
+	std::unordered_map<const void*, Memory> _memory;
+	// Shaders and pipelines, which have no contents
+	std::unordered_set<const void*> _objects;
+	std::unordered_map<const void*, std::vector<UploadRegion>> _commandBuffers;
+	std::vector<NullGpuCommand> _commands;
+	uintptr_t _lastHandle = 0;
+	bool _recording = true;
+};
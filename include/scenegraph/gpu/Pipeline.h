@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class PrimitiveType : uint8_t {
+	TriangleList,
+	TriangleStrip,
+	LineList,
+	LineStrip,
+	PointList
+};
+
+enum class BlendMode : uint8_t {
+	Opaque,
+	Alpha,
+	PremultipliedAlpha,
+	Additive
+};
+
+enum class VertexElementFormat : uint8_t {
+	Invalid,
+	Float,
+	Float2,
+	Float3,
+	Float4,
+	UByte4Norm
+};
+
+///
+/// Vertex buffer bound to a slot of a pipeline
+///
+struct VertexBufferLayout {
+	uint32_t pitch = 0;
+	uint8_t slot = 0;
+	bool instanced = false;
+	
+	bool operator==(const VertexBufferLayout&) const noexcept = default;
+};
+
+///
+/// Vertex shader input read from a vertex buffer
+///
+struct VertexAttribute {
+	uint32_t offset = 0;
+	uint8_t location = 0;
+	uint8_t bufferSlot = 0;
+	VertexElementFormat format = VertexElementFormat::Invalid;
+	
+	bool operator==(const VertexAttribute&) const noexcept = default;
+};
+
+///
+/// State a graphics pipeline is created from, equal states share a pipeline
+///
+/// Shaders are device handles, which PipelineCache keeps one per shader file. The color target format is the
+/// texture format value of the backend, usually the one of the swapchain.
+///
+struct PipelineState {
+	static constexpr size_t kMaxVertexBuffers = 4;
+	static constexpr size_t kMaxVertexAttributes = 8;
+	
+	const void* vertexShader = nullptr;
+	const void* fragmentShader = nullptr;
+	uint32_t colorTargetFormat = 0;
+	PrimitiveType primitiveType = PrimitiveType::TriangleList;
+	BlendMode blendMode = BlendMode::Opaque;
+	uint8_t vertexBufferCount = 0;
+	uint8_t vertexAttributeCount = 0;
+	// Entries past the counts stay default, so they do not make equal states differ
+	VertexBufferLayout vertexBuffers[kMaxVertexBuffers] = {};
+	VertexAttribute vertexAttributes[kMaxVertexAttributes] = {};
+	
+	bool operator==(const PipelineState&) const noexcept = default;
+};
+
+uint64_t PipelineStateHash(const PipelineState& state) noexcept;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <scenegraph/gpu/Pipeline.h>
+#include <scenegraph/gpu/Shader.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class GpuDevice;
+
+///
+/// Creates shaders and graphics pipelines once and keeps them for the lifetime of the cache
+///
+/// Shaders are named by their file name without extension, like "SolidColor.frag", which also gives the stage.
+/// Compiled code is loaded in the format the device takes, counts of resources come from the reflection JSON next
+/// to it. Pipelines are looked up by the hash of their state, so materials with equal states share one pipeline and
+/// each is created once. Vertex inputs of the shader are checked against attributes of the state on creation.
+///
+class PipelineCache {
+public:
+	explicit PipelineCache(GpuDevice& device, std::string_view directory = {}) noexcept;
+	~PipelineCache();
+	
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+	
+	// Format shaders are loaded in, none when the device takes none of the compiled ones
+	ShaderFormat GetShaderFormat() const noexcept { return _format; }
+	
+	// Loads the shader from the directory on the first request, returns null when files are missing or invalid
+	void* LoadShader(std::string_view name) noexcept;
+	// Creates the shader from code in the format of the cache unless one of the name exists
+	void* AddShader(std::string_view name, std::string_view reflectionJson, const void* code, size_t codeSize) noexcept;
+	
+	// Reflection of a shader returned by the cache
+	const ShaderReflection* GetReflection(const void* shader) const noexcept;
+	
+	// Creates the pipeline of the state on the first request, returns null when creation fails
+	void* GetPipeline(const PipelineState& state) noexcept;
+	
+	size_t GetShaderCount() const noexcept { return _shaders.size(); }
+	size_t GetPipelineCount() const noexcept { return _pipelines.size(); }
+	
+	// Releases all pipelines and shaders
+	void Clear() noexcept;
+	
+private:
+	struct Shader {
+		void* handle;
+		ShaderReflection reflection;
+	};
+	
+	struct PipelineStateHasher {
+		size_t operator()(const PipelineState& state) const noexcept { return static_cast<size_t>(PipelineStateHash(state)); }
+	};
+	
+	bool Validate(const PipelineState& state) const noexcept;
+	
+private:
+	GpuDevice& _device;
+	std::string _directory;
+	ShaderFormat _format = ShaderFormat::None;
+	std::unordered_map<std::string, Shader> _shaders;
+	// Points into nodes of shaders, which do not move
+	std::unordered_map<const void*, const ShaderReflection*> _reflections;
+	std::unordered_map<PipelineState, void*, PipelineStateHasher> _pipelines;
+};
@@ -2,12 +2,14 @@
 
 #include <scenegraph/utils/NonCopyable.h>
 
+class GpuDevice;
+
 ///
 /// Resource
 ///
 class Resource : public NonCopyable {
 public:
-	explicit Resource(void* device)
+	explicit Resource(GpuDevice* device)
 		: _device(device)
 	{
 	}
@@ -29,14 +31,14 @@ public:
 		return *this;
 	}
 	
-	void* Device() const noexcept { return _device; }
+	GpuDevice* Device() const noexcept { return _device; }
 	
 	void* Handle() const noexcept { return _handle; }
 	
 	bool Valid() const noexcept { return _handle != nullptr; }
 
 protected:
-	void* _device = nullptr;
+	GpuDevice* _device = nullptr;
 	
 	void* _handle = nullptr;
 };
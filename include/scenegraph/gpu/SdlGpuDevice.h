@@ -0,0 +1,43 @@
+#pragma once
+
+#include <scenegraph/gpu/GpuDevice.h>
+
+///
+/// GPU device of SDL, does not own the SDL device
+///
+class SdlGpuDevice final : public GpuDevice {
+public:
+	explicit SdlGpuDevice(void* device) : _device(device)
+	{
+	}
+	
+	void* Handle() const noexcept { return _device; }
+	
+	void* CreateBuffer(BufferUsage usage, uint32_t size) noexcept override;
+	void ReleaseBuffer(void* buffer) noexcept override;
+	
+	void* CreateTransferBuffer(TransferBufferUsage usage, uint32_t size) noexcept override;
+	void ReleaseTransferBuffer(void* transferBuffer) noexcept override;
+	
+	void* MapTransferBuffer(void* transferBuffer, bool cycle) noexcept override;
+	void UnmapTransferBuffer(void* transferBuffer) noexcept override;
+	
+	ShaderFormat GetShaderFormats() noexcept override;
+	void* CreateShader(const ShaderCreateInfo& createInfo) noexcept override;
+	void ReleaseShader(void* shader) noexcept override;
+	
+	void* CreateGraphicsPipeline(const PipelineState& state) noexcept override;
+	void ReleaseGraphicsPipeline(void* pipeline) noexcept override;
+	
+	void* AcquireCommandBuffer() noexcept override;
+	
+	void UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept override;
+	
+	void* Submit(void* commandBuffer) noexcept override;
+	bool IsFenceSignaled(void* fence) noexcept override;
+	void WaitForFence(void* fence) noexcept override;
+	void ReleaseFence(void* fence) noexcept override;
+	
+private:
+	void* _device = nullptr;
+};
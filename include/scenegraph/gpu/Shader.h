@@ -1 +1,72 @@
 #pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+enum class ShaderStage : uint8_t {
+	Vertex,
+	Fragment
+};
+
+enum class ShaderFormat : uint8_t {
+	None,
+	SpirV = 1 << 0,
+	Dxil = 1 << 1,
+	MetalLib = 1 << 2
+};
+
+constexpr ShaderFormat operator&(ShaderFormat lhs, ShaderFormat rhs) noexcept {
+	return static_cast<ShaderFormat>(
+		static_cast<std::underlying_type_t<ShaderFormat>>(lhs) &
+		static_cast<std::underlying_type_t<ShaderFormat>>(rhs));
+}
+
+constexpr ShaderFormat operator|(ShaderFormat lhs, ShaderFormat rhs) noexcept {
+	return static_cast<ShaderFormat>(
+		static_cast<std::underlying_type_t<ShaderFormat>>(lhs) |
+		static_cast<std::underlying_type_t<ShaderFormat>>(rhs));
+}
+
+// Single format to load from formats supported by a device, none when there is no common one
+ShaderFormat ShaderFormatSelect(ShaderFormat supported) noexcept;
+// File extension of compiled shaders of the format, "spv", "dxil" or "air"
+const char* ShaderFormatExtension(ShaderFormat format) noexcept;
+
+///
+/// Input or output of a shader stage
+///
+struct ShaderVariable {
+	std::string name;
+	std::string type;
+	uint32_t location;
+};
+
+///
+/// Resources used by a compiled shader, as written by the shader compiler into a JSON file next to the shader
+///
+struct ShaderReflection {
+	uint32_t samplers = 0;
+	uint32_t storageTextures = 0;
+	uint32_t storageBuffers = 0;
+	uint32_t uniformBuffers = 0;
+	std::vector<ShaderVariable> inputs;
+	std::vector<ShaderVariable> outputs;
+};
+
+// Returns false when the JSON is malformed, unknown keys are skipped
+bool ShaderReflectionParse(std::string_view json, ShaderReflection* reflection) noexcept;
+
+///
+/// Compiled shader passed to a GPU device
+///
+struct ShaderCreateInfo {
+	const void* code;
+	size_t codeSize;
+	ShaderFormat format;
+	ShaderStage stage;
+	const ShaderReflection* reflection;
+};
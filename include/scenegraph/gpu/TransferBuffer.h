@@ -19,7 +19,7 @@ enum class BufferLockMode {
 ///
 class TransferBuffer : public Resource {
 public:
-	explicit TransferBuffer(void* device) : Resource(device)
+	explicit TransferBuffer(GpuDevice* device) : Resource(device)
 	{
 	}
 	
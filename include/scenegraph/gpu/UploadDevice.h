@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class GpuDevice;
+
+///
+/// Copy of a range of a transfer buffer into a range of a GPU buffer
+///
+struct UploadRegion {
+	void* transferBuffer;
+	uint32_t transferOffset;
+	void* buffer;
+	uint32_t bufferOffset;
+	uint32_t size;
+};
+
+///
+/// Device operations needed by UploadManager, so the allocation logic can run against a mock device in tests
+///
+class UploadDevice {
+public:
+	virtual ~UploadDevice() = default;
+	
+	virtual void* CreateTransferBuffer(uint32_t size) noexcept = 0;
+	virtual void ReleaseTransferBuffer(void* transferBuffer) noexcept = 0;
+	
+	// Mapping must not cycle the buffer, the ring itself keeps ranges in use by the GPU intact
+	virtual void* MapTransferBuffer(void* transferBuffer) noexcept = 0;
+	virtual void UnmapTransferBuffer(void* transferBuffer) noexcept = 0;
+	
+	// Records all regions in one copy pass
+	virtual void UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept = 0;
+	
+	// Submits the command buffer and returns the fence signaled on its completion
+	virtual void* Submit(void* commandBuffer) noexcept = 0;
+	virtual bool IsFenceSignaled(void* fence) noexcept = 0;
+	virtual void WaitForFence(void* fence) noexcept = 0;
+	virtual void ReleaseFence(void* fence) noexcept = 0;
+};
+
+///
+/// Upload device over the GPU device, transfer buffers are its handles
+///
+class GpuUploadDevice final : public UploadDevice {
+public:
+	explicit GpuUploadDevice(GpuDevice& device) : _device(device)
+	{
+	}
+	
+	void* CreateTransferBuffer(uint32_t size) noexcept override;
+	void ReleaseTransferBuffer(void* transferBuffer) noexcept override;
+	
+	void* MapTransferBuffer(void* transferBuffer) noexcept override;
+	void UnmapTransferBuffer(void* transferBuffer) noexcept override;
+	
+	void UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept override;
+	
+	void* Submit(void* commandBuffer) noexcept override;
+	bool IsFenceSignaled(void* fence) noexcept override;
+	void WaitForFence(void* fence) noexcept override;
+	void ReleaseFence(void* fence) noexcept override;
+	
+private:
+	GpuDevice& _device;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <scenegraph/imaging/Color.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class PixelFormat : uint8_t {
+	// Bytes r, g, b and a
+	RGBA8,
+	// 16-bit words of red, green and blue from high to low bits, alpha is dropped
+	RGB565,
+	// 16-bit words of alpha, red, green and blue from high to low bits
+	RGBA4444
+};
+
+// Bytes per pixel
+constexpr size_t PixelFormatSize(PixelFormat format) noexcept { return format == PixelFormat::RGBA8 ? 4 : 2; }
+
+// Number of levels down to 1x1
+uint32_t MipLevelCount(uint32_t width, uint32_t height) noexcept;
+
+// True when no pixel is transparent, such images lose nothing packed as RGB565
+bool ImageIsOpaque(const Color* pixels, size_t count) noexcept;
+
+// Multiplies color codes by alpha in place, textures of the codes are blended without decoding them
+void ImagePremultiplyAlpha(Color* pixels, size_t count) noexcept;
+
+///
+/// Level of a mip chain in its data
+///
+struct MipLevel {
+	uint32_t width;
+	uint32_t height;
+	size_t offset;
+	size_t size;
+};
+
+struct MipChainOptions {
+	// Levels down to 1x1, only the image otherwise
+	bool mipmaps = false;
+	// Colors are sRGB encoded, so they are filtered in linear space
+	bool srgb = true;
+	bool premultiplyAlpha = false;
+	PixelFormat format = PixelFormat::RGBA8;
+};
+
+///
+/// Decoded image with its mip levels in one buffer, laid out for a texture upload
+///
+/// Each level halves the previous one with a 2x2 box filter, the last row and column of odd sizes are dropped. Texels
+/// are filtered premultiplied in linear space, so transparent texels do not bleed their color into edges and sRGB
+/// images do not darken with distance. Levels are converted back to straight alpha and encoded, premultiplied ones then
+/// multiply the encoded colors by alpha since textures are blended without decoding, and packed into the format of
+/// the chain.
+///
+class MipChain {
+public:
+	// Returns false for an empty image
+	bool Build(const Color* pixels, uint32_t width, uint32_t height, const MipChainOptions& options = {}) noexcept;
+	
+	PixelFormat GetFormat() const noexcept { return _format; }
+	
+	size_t GetLevelCount() const noexcept { return _levels.size(); }
+	const MipLevel& GetLevel(size_t level) const noexcept { return _levels[level]; }
+	const std::byte* GetLevelData(size_t level) const noexcept { return _data.data() + _levels[level].offset; }
+	
+	// All levels one after another, largest first
+	const std::byte* GetData() const noexcept { return _data.data(); }
+	size_t GetSize() const noexcept { return _data.size(); }
+	
+private:
+	PixelFormat _format = PixelFormat::RGBA8;
+	std::vector<MipLevel> _levels;
+	std::vector<std::byte> _data;
+	// Premultiplied linear texels of the last level and the one being filtered, four floats each
+	std::vector<float> _texels;
+	std::vector<float> _filtered;
+};
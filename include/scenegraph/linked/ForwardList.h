@@ -22,9 +22,9 @@ public:
 	constexpr ForwardListNode(ForwardListNode&&) noexcept {}
 	constexpr ForwardListNode& operator=(ForwardListNode&&) noexcept { return *this; }
 
-	constexpr void Swap(ForwardListNode<Tag>& rhs) noexcept { std::swap(_next, rhs._next); }
+	constexpr void Swap(ForwardListNode& rhs) noexcept { std::swap(_next, rhs._next); }
 
-	constexpr friend void swap(ForwardListNode<Tag>& lhs, ForwardListNode<Tag>& rhs) noexcept { lhs.Swap(rhs); }
+	constexpr friend void swap(ForwardListNode& lhs, ForwardListNode& rhs) noexcept { lhs.Swap(rhs); }
 
 private:
 	template <typename T1, typename T2> friend class ForwardList;
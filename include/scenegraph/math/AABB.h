@@ -0,0 +1,71 @@
+#pragma once
+
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/math/Sphere.h>
+
+struct Matrix4;
+struct Matrix43;
+
+///
+/// Axis-aligned bounding box
+///
+struct AABB {
+	Vector3 min;
+	Vector3 max;
+};
+
+constexpr AABB AABBMake(Vector3 min, Vector3 max) { return AABB {min, max}; }
+
+constexpr AABB AABBMakeWithCenterAndExtents(Vector3 center, Vector3 extents) {
+	return AABB {center - extents, center + extents};
+}
+
+// Inverted box, union with any box gives that box
+constexpr AABB AABBMakeEmpty() {
+	constexpr float max = std::numeric_limits<float>::max();
+	return AABB {Vector3 {max, max, max}, Vector3 {-max, -max, -max}};
+}
+
+constexpr bool AABBIsEmpty(const AABB& b) { return b.min.x > b.max.x || b.min.y > b.max.y || b.min.z > b.max.z; }
+
+constexpr Vector3 AABBCenter(const AABB& b) { return (b.min + b.max) * 0.5f; }
+constexpr Vector3 AABBExtents(const AABB& b) { return (b.max - b.min) * 0.5f; }
+
+constexpr float AABBSurfaceArea(const AABB& b) {
+	auto d = b.max - b.min;
+	return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+constexpr AABB AABBUnion(const AABB& b1, const AABB& b2) { return AABB {Vector3Min(b1.min, b2.min), Vector3Max(b1.max, b2.max)}; }
+constexpr AABB AABBAddPoint(const AABB& b, const Vector3& p) { return AABB {Vector3Min(b.min, p), Vector3Max(b.max, p)}; }
+
+constexpr bool AABBContainsPoint(const AABB& b, const Vector3& p) {
+	return p.x >= b.min.x && p.x <= b.max.x && p.y >= b.min.y && p.y <= b.max.y && p.z >= b.min.z && p.z <= b.max.z;
+}
+
+constexpr bool AABBContains(const AABB& b1, const AABB& b2) { return AABBContainsPoint(b1, b2.min) && AABBContainsPoint(b1, b2.max); }
+
+constexpr bool AABBIntersect(const AABB& b1, const AABB& b2) {
+	return b1.min.x <= b2.max.x && b1.max.x >= b2.min.x &&
+		b1.min.y <= b2.max.y && b1.max.y >= b2.min.y &&
+		b1.min.z <= b2.max.z && b1.max.z >= b2.min.z;
+}
+
+// Sphere enclosing the box
+constexpr Sphere AABBBoundingSphere(const AABB& b) { return SphereMake(AABBCenter(b), Vector3Length(AABBExtents(b))); }
+
+// Bounding box of the transformed one
+AABB AABBTransform(const AABB& b, const Matrix4& m);
+AABB AABBTransform(const AABB& b, const Matrix43& m);
+
+///
+/// Structure of arrays view of boxes in center and extents form, cheapest for plane tests
+///
+struct AABBBatch {
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* extentX;
+	const float* extentY;
+	const float* extentZ;
+};
@@ -3,10 +3,15 @@
 #include <scenegraph/math/Plane.h>
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 struct Matrix4;
 struct Vector3;
 struct Sphere;
+struct AABB;
+struct SphereBatch;
+struct AABBBatch;
 
 enum class ClippingPlane { Left, Right, Top, Bottom, Near, Far };
 
@@ -23,3 +28,16 @@ void FrustumNormalize(Frustum& frustum);
 bool FrustumCullPoint(const Frustum& frustum, const Vector3& p);
 // Checks if sphere is culled by (lays outside) the frustum
 bool FrustumCullSphere(const Frustum& frustum, const Sphere& s);
+// Checks if box is culled by (lays outside) the frustum
+bool FrustumCullAABB(const Frustum& frustum, const AABB& b);
+// Checks if box lays entirely inside the frustum
+bool FrustumContainsAABB(const Frustum& frustum, const AABB& b);
+
+// Batch culling writes visibility as a bit per object (set when visible) packed into (count + 31) / 32 words,
+// or a list of visible object indices returning their number.
+// Optional plane cache keeps per object index of the plane which culled it last time (initially zeros),
+// that plane is tested first, so objects staying outside are rejected with a single plane test
+void FrustumCullSpheresToMask(const Frustum& frustum, const SphereBatch& spheres, size_t count, uint32_t* visibility, uint8_t* planeCache = nullptr);
+void FrustumCullAABBsToMask(const Frustum& frustum, const AABBBatch& boxes, size_t count, uint32_t* visibility, uint8_t* planeCache = nullptr);
+size_t FrustumCullSpheresToIndices(const Frustum& frustum, const SphereBatch& spheres, size_t count, uint32_t* indices, uint8_t* planeCache = nullptr);
+size_t FrustumCullAABBsToIndices(const Frustum& frustum, const AABBBatch& boxes, size_t count, uint32_t* indices, uint8_t* planeCache = nullptr);
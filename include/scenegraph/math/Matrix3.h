@@ -2,6 +2,6 @@
 
 struct Matrix3 {
 	float m11, m12, m13;
-	float m21, n22, m23;
+	float m21, m22, m23;
 	float m31, m32, m33;
 };
@@ -2,6 +2,8 @@
 
 #include <scenegraph/math/Transform2D.h>
 
+#include <cstddef>
+
 struct Matrix32 {
 	float a, b;
 	float c, d;
@@ -76,6 +78,11 @@ Matrix32 Matrix32Multiply(const Matrix32& m1, const Matrix32& m2);
 Matrix32 Matrix32MultiplyRotation(const Matrix32& m1, const Matrix32& m2);
 Matrix32 Matrix32Invert(const Matrix32& m, bool* invertible);
 
+// Batch versions, out[i] = Matrix32Multiply(m1[i], m2[i]). Output may be the same array as one of inputs
+void Matrix32MultiplyBatch(const Matrix32* m1, const Matrix32* m2, Matrix32* out, size_t count);
+void Matrix32MakeWithTransform2DBatch(const Transform2D* transforms, Matrix32* out, size_t count);
+void Matrix32MakeWithTransform2DBatch(const Transform2DBatch& transforms, Matrix32* out, size_t count);
+
 inline Matrix32 operator+(const Matrix32& m1, const Matrix32& m2) { return Matrix32Add(m1, m2); }
 inline Matrix32 operator-(const Matrix32& m1, const Matrix32& m2) { return Matrix32Subtract(m1, m2); }
 inline Matrix32 operator*(const Matrix32& m1, const Matrix32& m2) { return Matrix32Multiply(m1, m2); }
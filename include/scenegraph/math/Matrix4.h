@@ -1,6 +1,8 @@
 #pragma once
 
 struct Quaternion;
+struct Vector3;
+struct Transform;
 
 struct Matrix4 {
 	float m11, m12, m13, m14;
@@ -9,6 +11,16 @@ struct Matrix4 {
 	float m41, m42, m43, m44;
 };
 
+///
+/// Matrix aligned to 16 bytes for SIMD functions, same layout as Matrix4
+///
+struct alignas(16) Matrix4Aligned : Matrix4 {
+};
+
+static_assert(sizeof(Matrix4Aligned) == sizeof(Matrix4));
+
+constexpr Matrix4Aligned Matrix4AlignedMake(const Matrix4& m) { return Matrix4Aligned {m}; }
+
 constexpr Matrix4 Matrix4MakeZero() {
 	return Matrix4 {
 		0, 0, 0, 0,
@@ -74,6 +86,10 @@ constexpr Matrix4 Matrix4MakeTranslation(float tx, float ty, float tz) {
 }
 
 Matrix4 Matrix4MakeWithQuaternion(const Quaternion& q);
+// Scales, then rotates, then translates
+Matrix4 Matrix4MakeWithScaleRotationTranslation(const Vector3& scale, const Quaternion& rotation, const Vector3& translation);
+// Euler angles are applied in X, Y, Z order
+Matrix4 Matrix4MakeWithTransform(const Transform& transform);
 Matrix4 Matrix4MakeXRotation(float rad);
 Matrix4 Matrix4MakeYRotation(float rad);
 Matrix4 Matrix4MakeZRotation(float rad);
@@ -99,7 +115,12 @@ Matrix4 Matrix4Subtract(const Matrix4& m1, const Matrix4& m2);
 Matrix4 Matrix4Multiply(const Matrix4& m1, const Matrix4& m2);
 Matrix4 Matrix4Invert(const Matrix4& m, bool* invertible);
 
+// SIMD versions, results match scalar ones within rounding
+Matrix4Aligned Matrix4MultiplyAligned(const Matrix4Aligned& m1, const Matrix4Aligned& m2);
+Matrix4Aligned Matrix4InvertAligned(const Matrix4Aligned& m, bool* invertible);
+
 inline Matrix4 operator+(const Matrix4& m1, const Matrix4& m2) { return Matrix4Add(m1, m2); }
 inline Matrix4 operator-(const Matrix4& m1, const Matrix4& m2) { return Matrix4Subtract(m1, m2); }
 inline Matrix4 operator*(const Matrix4& m1, const Matrix4& m2) { return Matrix4Multiply(m1, m2); }
 inline Matrix4 operator*(const Matrix4& m, float s) { return Matrix4Scale(m, s); }
+inline Matrix4Aligned operator*(const Matrix4Aligned& m1, const Matrix4Aligned& m2) { return Matrix4MultiplyAligned(m1, m2); }
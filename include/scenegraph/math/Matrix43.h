@@ -1,8 +1,80 @@
 #pragma once
 
+struct Matrix4;
+struct Quaternion;
+struct Vector3;
+
+///
+/// Affine 3D transform, Matrix4 without the last column which is always [0 0 0 1]
+///
+/// Takes 48 bytes instead of 64, and composition takes 36 multiplications instead of 64.
+///
 struct Matrix43 {
 	float m11, m12, m13;
-	float m21, n22, m23;
+	float m21, m22, m23;
 	float m31, m32, m33;
 	float m41, m42, m43;
 };
+
+constexpr Matrix43 Matrix43MakeZero() {
+	return Matrix43 {
+		0, 0, 0,
+		0, 0, 0,
+		0, 0, 0,
+		0, 0, 0
+	};
+}
+
+constexpr Matrix43 Matrix43MakeIdentity() {
+	return Matrix43 {
+		1, 0, 0,
+		0, 1, 0,
+		0, 0, 1,
+		0, 0, 0
+	};
+}
+
+constexpr Matrix43 Matrix43Make(
+	float m11, float m12, float m13,
+	float m21, float m22, float m23,
+	float m31, float m32, float m33,
+	float m41, float m42, float m43)
+{
+	return Matrix43 {
+		m11, m12, m13,
+		m21, m22, m23,
+		m31, m32, m33,
+		m41, m42, m43
+	};
+}
+
+constexpr Matrix43 Matrix43MakeScale(float sx, float sy, float sz) {
+	return Matrix43 {
+		sx, 0, 0,
+		0, sy, 0,
+		0, 0, sz,
+		0, 0, 0
+	};
+}
+
+constexpr Matrix43 Matrix43MakeTranslation(float tx, float ty, float tz) {
+	return Matrix43 {
+		1, 0, 0,
+		0, 1, 0,
+		0, 0, 1,
+		tx, ty, tz
+	};
+}
+
+Matrix43 Matrix43MakeWithQuaternion(const Quaternion& q);
+// Scales, then rotates, then translates
+Matrix43 Matrix43MakeWithScaleRotationTranslation(const Vector3& scale, const Quaternion& rotation, const Vector3& translation);
+// Drops the last column, the matrix must be affine
+Matrix43 Matrix43MakeWithMatrix4(const Matrix4& m);
+// Full matrix for uploading and for multiplying with projections
+Matrix4 Matrix43ToMatrix4(const Matrix43& m);
+
+Matrix43 Matrix43Multiply(const Matrix43& m1, const Matrix43& m2);
+Matrix43 Matrix43Invert(const Matrix43& m, bool* invertible);
+
+inline Matrix43 operator*(const Matrix43& m1, const Matrix43& m2) { return Matrix43Multiply(m1, m2); }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <scenegraph/math/Vector2.h>
+
+struct Matrix32;
+
+///
+/// Axis-aligned rectangle
+///
+struct Rect {
+	Vector2 min;
+	Vector2 max;
+};
+
+constexpr Rect RectMake(Vector2 min, Vector2 max) { return Rect {min, max}; }
+
+constexpr Rect RectMakeWithOriginAndSize(float x, float y, float width, float height) {
+	return Rect {Vector2 {x, y}, Vector2 {x + width, y + height}};
+}
+
+// Inverted rectangle, union with any rectangle gives that rectangle
+constexpr Rect RectMakeEmpty() {
+	constexpr float max = std::numeric_limits<float>::max();
+	return Rect {Vector2 {max, max}, Vector2 {-max, -max}};
+}
+
+constexpr bool RectIsEmpty(const Rect& r) { return r.min.x > r.max.x || r.min.y > r.max.y; }
+
+constexpr Vector2 RectCenter(const Rect& r) { return (r.min + r.max) * 0.5f; }
+constexpr Vector2 RectSize(const Rect& r) { return r.max - r.min; }
+
+constexpr Rect RectUnion(const Rect& r1, const Rect& r2) { return Rect {Vector2Min(r1.min, r2.min), Vector2Max(r1.max, r2.max)}; }
+constexpr Rect RectAddPoint(const Rect& r, Vector2 p) { return Rect {Vector2Min(r.min, p), Vector2Max(r.max, p)}; }
+
+constexpr bool RectContainsPoint(const Rect& r, Vector2 p) {
+	return p.x >= r.min.x && p.x <= r.max.x && p.y >= r.min.y && p.y <= r.max.y;
+}
+
+constexpr bool RectContains(const Rect& r1, const Rect& r2) { return RectContainsPoint(r1, r2.min) && RectContainsPoint(r1, r2.max); }
+
+constexpr bool RectIntersect(const Rect& r1, const Rect& r2) {
+	return r1.min.x <= r2.max.x && r1.max.x >= r2.min.x && r1.min.y <= r2.max.y && r1.max.y >= r2.min.y;
+}
+
+// Bounding rectangle of the transformed one
+Rect RectTransform(const Rect& r, const Matrix32& m);
@@ -16,3 +16,13 @@ constexpr Sphere SphereMake(Vector3 origin, float radius) {
 
 constexpr float SphereDistance(const Sphere& s1, const Sphere& s2) { return Vector3Distance(s1.origin, s2.origin) - (s1.radius + s2.radius); }
 constexpr bool SphereIntersect(const Sphere& s1, const Sphere& s2) { return SphereDistance(s1, s2) < 0; }
+
+///
+/// Structure of arrays view of spheres
+///
+struct SphereBatch {
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* radius;
+};
@@ -9,3 +9,18 @@ struct Transform2D {
 
 constexpr Transform2D Transform2DMakeZero() { return {}; }
 constexpr Transform2D Transform2DMakeIdentity() { return { .sx = 1, .sy = 1 }; }
+
+///
+/// Structure of arrays view of transforms
+///
+/// Shear arrays may be null when none of the transforms is sheared.
+///
+struct Transform2DBatch {
+	const float* sx;
+	const float* sy;
+	const float* shearX;
+	const float* shearY;
+	const float* rad;
+	const float* tx;
+	const float* ty;
+};
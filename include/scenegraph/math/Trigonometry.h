@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// Vectorized sine and cosine of an array of angles in radians.
+// Max absolute error is 8e-8 for |rad| <= 8192, accuracy degrades for larger angles (1e-6 at 65536)
+void SinCosBatch(const float* rad, float* sin, float* cos, size_t count);
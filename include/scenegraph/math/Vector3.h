@@ -3,8 +3,10 @@
 #include <scenegraph/utils/FloatUtils.h>
 
 #include <cmath>
+#include <cstddef>
 
 struct Matrix4;
+struct Matrix43;
 struct Quaternion;
 
 struct Vector3 {
@@ -58,6 +60,13 @@ Vector3 Vector3Rotate(const Vector3& v, const Quaternion& q);
 Vector3 Vector3Rotate(const Vector3& v, const Matrix4& m);
 Vector3 Vector3Transform(const Vector3& v, const Matrix4& m);
 Vector3 Vector3TransformAndProjectCoord(const Vector3& v, const Matrix4& m);
+Vector3 Vector3Rotate(const Vector3& v, const Matrix43& m);
+Vector3 Vector3Transform(const Vector3& v, const Matrix43& m);
+
+// Array versions transforming count points by one matrix. Output may be the same array as input
+void Vector3TransformArray(const Vector3* v, const Matrix4& m, Vector3* out, size_t count);
+void Vector3TransformArray(const Vector3* v, const Matrix43& m, Vector3* out, size_t count);
+void Vector3TransformAndProjectCoordArray(const Vector3* v, const Matrix4& m, Vector3* out, size_t count);
 
 constexpr Vector3 operator+(const Vector3& v1, const Vector3& v2) { return Vector3Add(v1, v2); }
 constexpr Vector3 operator-(const Vector3& v1, const Vector3& v2) { return Vector3Subtract(v1, v2); }
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <scenegraph/utils/ScopeGuard.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Define to 1 for the build (CMake option SCENEGRAPH_TRACE) to record zones
+#ifndef SCENEGRAPH_TRACE_ENABLED
+#define SCENEGRAPH_TRACE_ENABLED 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Monotonic clock in nanoseconds for platforms without a usable counter
+uint64_t TraceTimestampFallback() noexcept;
+
+// Raw CPU timestamp counter, converted to time on export
+inline uint64_t TraceTimestamp() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+	return __rdtsc();
+#elif defined(__aarch64__)
+	uint64_t ticks;
+	__asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	return TraceTimestampFallback();
+#endif
+}
+
+// Thread name is copied, zone names must be string literals or otherwise outlive the trace
+void TraceSetThreadName(const char* name) noexcept;
+void TraceRecord(const char* name, uint64_t begin, uint64_t end) noexcept;
+
+// Writes and consumes all recorded zones as Chrome trace_event JSON (chrome://tracing, Perfetto)
+bool TraceWriteChromeJson(FILE* file) noexcept;
+// Drops all recorded zones
+void TraceClear() noexcept;
+// Buffers of running threads and of exited ones with zones left to write, exited threads give theirs to new ones
+size_t TraceGetThreadBufferCount() noexcept;
+
+///
+/// Scoped zone
+///
+class TraceZone {
+public:
+	explicit TraceZone(const char* name) noexcept
+		: _name(name)
+		, _begin(TraceTimestamp())
+	{
+	}
+
+	TraceZone(const TraceZone&) = delete;
+	TraceZone& operator=(const TraceZone&) = delete;
+
+	~TraceZone() { TraceRecord(_name, _begin, TraceTimestamp()); }
+
+private:
+	const char* _name;
+	uint64_t _begin;
+};
+
+#if SCENEGRAPH_TRACE_ENABLED
+	#define TRACE_ZONE(name) TraceZone UNIQUE_VARIABLE(traceZone_){name}
+	#define TRACE_THREAD_NAME(name) TraceSetThreadName(name)
+#else
+	#define TRACE_ZONE(name) (void)0
+	#define TRACE_THREAD_NAME(name) (void)0
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <scenegraph/render/SpriteInstance.h>
+#include <scenegraph/imaging/Color.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+///
+/// Compact record of the instance stream, matches PackedSpriteData of PullPackedSpriteBatch.vert.hlsl
+///
+/// Translation stays in full precision, the linear part of the transform is in half floats. Texture coordinates are
+/// an index in SpriteRectTable and the pivot is quantized to 1/255, so it must be within [0, 1].
+///
+struct PackedSpriteInstance {
+	float tx, ty;
+	uint16_t a, b, c, d;
+	Color color;
+	uint16_t rectIndex;
+	uint8_t pivotX;
+	uint8_t pivotY;
+};
+
+static_assert(sizeof(PackedSpriteInstance) == 24);
+
+///
+/// Texture rectangle of packed instances in the layout of SpriteInstance
+///
+struct SpriteRect {
+	float u, v, w, h;
+};
+
+///
+/// Deduplicated texture rectangles referenced by packed instances, uploaded as a separate buffer
+///
+/// Rectangles of atlas pages change rarely, so the table is kept between frames and cleared only with the atlas.
+///
+class SpriteRectTable {
+public:
+	static constexpr size_t kMaxRects = UINT16_MAX + 1;
+	
+	void Clear() noexcept;
+	
+	// Returns index of the rectangle, adding it when it is new
+	uint16_t Add(const SpriteRect& rect) noexcept;
+	
+	const std::vector<SpriteRect>& GetRects() const noexcept { return _rects; }
+	
+private:
+	static uint64_t Hash(const SpriteRect& rect) noexcept;
+	
+private:
+	std::vector<SpriteRect> _rects;
+	// Rectangles by hash of their bits, collisions are resolved by comparing with the table
+	std::unordered_multimap<uint64_t, uint16_t> _indices;
+	// Neighbouring sprites usually share the rectangle
+	uint16_t _lastIndex = 0;
+};
+
+// Packs instances, adding their texture rectangles to the table
+void SpriteInstancePack(const SpriteInstance* instances, PackedSpriteInstance* out, size_t count, SpriteRectTable& rects) noexcept;
+
+SpriteInstance SpriteInstanceUnpack(const PackedSpriteInstance& instance, const SpriteRectTable& rects) noexcept;
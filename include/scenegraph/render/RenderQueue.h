@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+///
+/// 64-bit sort key of a draw item
+///
+/// Layer is in the top byte and is sorted first. Next bit selects the order inside the layer: opaque keys sort by
+/// pipeline, texture, sampler and then depth, so state changes are minimal, blended keys sort by depth first and keep
+/// the draw order, merging only neighbours with the same state. Smaller depth draws first.
+///
+using RenderSortKey = uint64_t;
+
+constexpr uint32_t kRenderKeyPipelineBits = 10;
+constexpr uint32_t kRenderKeyTextureBits = 14;
+constexpr uint32_t kRenderKeySamplerBits = 4;
+constexpr uint32_t kRenderKeyDepthBits = 27;
+
+constexpr uint32_t kRenderKeyMaxPipelines = 1u << kRenderKeyPipelineBits;
+constexpr uint32_t kRenderKeyMaxTextures = 1u << kRenderKeyTextureBits;
+constexpr uint32_t kRenderKeyMaxSamplers = 1u << kRenderKeySamplerBits;
+constexpr uint32_t kRenderKeyMaxDepth = (1u << kRenderKeyDepthBits) - 1;
+
+constexpr uint32_t kRenderKeyStateBits = kRenderKeyPipelineBits + kRenderKeyTextureBits + kRenderKeySamplerBits;
+constexpr RenderSortKey kRenderKeyBlendedBit = RenderSortKey{1} << 55;
+
+constexpr RenderSortKey RenderKeyMakeState(uint32_t pipeline, uint32_t texture, uint32_t sampler) noexcept {
+	assert(pipeline < kRenderKeyMaxPipelines && texture < kRenderKeyMaxTextures && sampler < kRenderKeyMaxSamplers);
+	return (RenderSortKey{pipeline} << (kRenderKeyTextureBits + kRenderKeySamplerBits)) |
+		(RenderSortKey{texture} << kRenderKeySamplerBits) | sampler;
+}
+
+constexpr RenderSortKey RenderKeyMakeOpaque(uint8_t layer, uint32_t pipeline, uint32_t texture, uint32_t sampler, uint32_t depth) noexcept {
+	assert(depth <= kRenderKeyMaxDepth);
+	return (RenderSortKey{layer} << 56) | (RenderKeyMakeState(pipeline, texture, sampler) << kRenderKeyDepthBits) | depth;
+}
+
+constexpr RenderSortKey RenderKeyMakeBlended(uint8_t layer, uint32_t depth, uint32_t pipeline, uint32_t texture, uint32_t sampler) noexcept {
+	assert(depth <= kRenderKeyMaxDepth);
+	return (RenderSortKey{layer} << 56) | kRenderKeyBlendedBit |
+		(RenderSortKey{depth} << kRenderKeyStateBits) | RenderKeyMakeState(pipeline, texture, sampler);
+}
+
+// Maps depth in [0, 1] to the key range, NaN to 0. The product is taken in double, in float the maximum depth
+// rounds up to 2^27 and overflows into the next field
+constexpr uint32_t RenderKeyQuantizeDepth(float depth) noexcept {
+	if (!(depth > 0)) {
+		return 0;
+	}
+	auto d = depth < 1 ? static_cast<double>(depth) : 1.0;
+	return static_cast<uint32_t>(d * kRenderKeyMaxDepth);
+}
+
+constexpr uint8_t RenderKeyGetLayer(RenderSortKey key) noexcept {
+	return static_cast<uint8_t>(key >> 56);
+}
+
+// Pipeline, texture and sampler bits, equal for items drawn with the same state
+constexpr uint32_t RenderKeyGetState(RenderSortKey key) noexcept {
+	auto shift = (key & kRenderKeyBlendedBit) ? 0 : kRenderKeyDepthBits;
+	return static_cast<uint32_t>(key >> shift) & ((1u << kRenderKeyStateBits) - 1);
+}
+
+constexpr uint32_t RenderKeyGetPipeline(RenderSortKey key) noexcept {
+	return RenderKeyGetState(key) >> (kRenderKeyTextureBits + kRenderKeySamplerBits);
+}
+
+constexpr uint32_t RenderKeyGetTexture(RenderSortKey key) noexcept {
+	return (RenderKeyGetState(key) >> kRenderKeySamplerBits) & (kRenderKeyMaxTextures - 1);
+}
+
+constexpr uint32_t RenderKeyGetSampler(RenderSortKey key) noexcept {
+	return RenderKeyGetState(key) & (kRenderKeyMaxSamplers - 1);
+}
+
+///
+/// State bound before a draw because it differs from the previous one
+///
+enum class RenderBind : uint8_t {
+	None     = 0,
+	Pipeline = 1 << 0,
+	Texture  = 1 << 1,
+	Sampler  = 1 << 2
+};
+
+constexpr RenderBind operator&(RenderBind lhs, RenderBind rhs) noexcept {
+	return static_cast<RenderBind>(
+		static_cast<std::underlying_type_t<RenderBind>>(lhs) &
+		static_cast<std::underlying_type_t<RenderBind>>(rhs));
+}
+
+constexpr RenderBind operator|(RenderBind lhs, RenderBind rhs) noexcept {
+	return static_cast<RenderBind>(
+		static_cast<std::underlying_type_t<RenderBind>>(lhs) |
+		static_cast<std::underlying_type_t<RenderBind>>(rhs));
+}
+
+///
+/// Draw call of a range of instances, with the state to bind before it
+///
+struct RenderDraw {
+	void* pipeline;
+	void* texture;
+	void* sampler;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+	RenderBind binds;
+};
+
+///
+/// Orders draw items of a frame by sort keys and turns them into draws with minimal state changes
+///
+/// Pipelines, textures and samplers are registered once and referenced by ids in keys. Items are added every frame
+/// with a key and a range of instances, Sort orders them with a radix sort and merges neighbours with the same state
+/// and adjacent instance ranges into one draw. Buffers are kept between frames and do not allocate once grown.
+///
+class RenderQueue {
+public:
+	// Return the id of the object for keys, registering it when it is new
+	uint32_t RegisterPipeline(void* pipeline) noexcept { return Register(_pipelines, pipeline, kRenderKeyMaxPipelines); }
+	uint32_t RegisterTexture(void* texture) noexcept { return Register(_textures, texture, kRenderKeyMaxTextures); }
+	uint32_t RegisterSampler(void* sampler) noexcept { return Register(_samplers, sampler, kRenderKeyMaxSamplers); }
+	
+	// Removes items and draws, registered objects are kept
+	void Clear() noexcept;
+	
+	void Add(RenderSortKey key, uint32_t firstInstance, uint32_t instanceCount) noexcept;
+	
+	void Sort() noexcept;
+	
+	size_t Size() const noexcept { return _keys.size(); }
+	
+	// Valid after sort, original indices of items in sorted order
+	const std::vector<uint32_t>& GetSortedItems() const noexcept { return _sortedItems; }
+	const std::vector<RenderDraw>& GetDraws() const noexcept { return _draws; }
+	
+private:
+	struct InstanceRange {
+		uint32_t first;
+		uint32_t count;
+	};
+	
+	struct SortEntry {
+		RenderSortKey key;
+		uint32_t item;
+	};
+	
+	static uint32_t Register(std::vector<void*>& objects, void* object, uint32_t maxCount) noexcept;
+	
+	void RadixSort() noexcept;
+	void MergeDraws() noexcept;
+	
+private:
+	std::vector<void*> _pipelines;
+	std::vector<void*> _textures;
+	std::vector<void*> _samplers;
+	std::vector<RenderSortKey> _keys;
+	std::vector<InstanceRange> _ranges;
+	// Ping-pong buffers of the radix sort
+	std::vector<SortEntry> _entries;
+	std::vector<SortEntry> _tempEntries;
+	std::vector<RenderSortKey> _sortedKeys;
+	std::vector<uint32_t> _sortedItems;
+	std::vector<RenderDraw> _draws;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///
+/// Rectangle of texels in an atlas page
+///
+struct AtlasRect {
+	uint32_t x, y;
+	uint32_t width, height;
+};
+
+///
+/// Packs rectangles into a page of fixed size with the skyline bottom-left heuristic
+///
+/// The skyline is the upper contour of placed rectangles, a rectangle goes where its top ends lowest. Gaps left
+/// under a rectangle placed over a lower part of the skyline and freed rectangles are kept in a list of free
+/// rectangles, which is tried first with the best area fit, the rest of the used free rectangle is split in two.
+/// Freed neighbours with a common edge are merged back, so the page does not fragment into slivers, and free
+/// rectangles smaller than any inserted one are dropped.
+///
+class SkylinePacker {
+public:
+	explicit SkylinePacker(uint32_t width = 0, uint32_t height = 0) noexcept { Reset(width, height); }
+	
+	// Removes all rectangles
+	void Reset(uint32_t width, uint32_t height) noexcept;
+	
+	// Returns false when the rectangle does not fit
+	bool Insert(uint32_t width, uint32_t height, AtlasRect* rect) noexcept;
+	
+	// Rectangle must be the one returned by insert, freeing the last one resets the packer
+	void Free(const AtlasRect& rect) noexcept;
+	
+	uint32_t GetWidth() const noexcept { return _width; }
+	uint32_t GetHeight() const noexcept { return _height; }
+	uint64_t GetUsedArea() const noexcept { return _usedArea; }
+	float GetOccupancy() const noexcept;
+	
+private:
+	struct Segment {
+		uint32_t x, y;
+		uint32_t width;
+	};
+	
+	bool InsertFree(uint32_t width, uint32_t height, AtlasRect* rect) noexcept;
+	bool InsertSkyline(uint32_t width, uint32_t height, AtlasRect* rect) noexcept;
+	
+	// Top of the skyline under the span starting at the segment, false when the rectangle does not fit
+	bool Fit(size_t segment, uint32_t width, uint32_t height, uint32_t* y) const noexcept;
+	
+	void AddFreeRect(AtlasRect rect) noexcept;
+	
+private:
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	uint64_t _usedArea = 0;
+	// Smallest rectangle sizes inserted since reset
+	uint32_t _minWidth = UINT32_MAX;
+	uint32_t _minHeight = UINT32_MAX;
+	// Segments ordered by x, they cover the page width without gaps
+	std::vector<Segment> _skyline;
+	std::vector<AtlasRect> _freeRects;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <scenegraph/SceneObject.h>
+#include <scenegraph/render/SpriteInstance.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SpriteComponent;
+class ThreadPool;
+class UploadManager;
+
+// Instance of the sprite, size scales the unit quad before the world transform
+SpriteInstance SpriteInstanceMake(const SpriteComponent& sprite, const Matrix32& worldTransform) noexcept;
+
+///
+/// Run of consecutive instances sharing texture and pipeline, drawn with one call
+///
+struct SpriteBatch {
+	void* texture;
+	void* pipeline;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+};
+
+///
+/// Builds the sprite instance stream of a frame from the scene
+///
+/// Instances are emitted in draw order with world transforms of Transform2DComponent, which must be updated first.
+/// A new batch starts only when texture or pipeline changes, so the stream stays valid for any order of sprites.
+/// Buffers are kept between frames and do not allocate once grown.
+///
+/// Gather only collects sprites and batches, the instances are then written in chunks of kChunkSize on the thread
+/// pool, straight into upload memory when uploading. Every chunk has its fixed place in the stream, so the result
+/// does not depend on scheduling.
+///
+class SpriteBatcher {
+public:
+	static constexpr size_t kChunkSize = 1024;
+	
+	void Clear() noexcept;
+	
+	// Appends visible sprites of children of the root in preorder
+	void Build(SceneObject root) noexcept;
+	// Appends visible sprites of objects in the given order, e.g. results of Bounds2DComponent::Cull. Sprites under
+	// hidden ones are skipped as in the scene walk, which costs a walk up the parents of each object
+	void Build(const SceneObject* objects, size_t count) noexcept;
+	
+	// Same as build, but leave writing instances to Write or Upload
+	void Gather(SceneObject root) noexcept;
+	void Gather(const SceneObject* objects, size_t count) noexcept;
+	
+	// Writes instances of all sprites, runs on the calling thread without pool
+	void Write(SpriteInstance* instances, ThreadPool* pool = nullptr) const noexcept;
+	// Writes instances of all sprites into upload memory for the buffer at offset
+	void Upload(UploadManager& uploads, void* buffer, uint32_t offset, ThreadPool* pool = nullptr) const noexcept;
+	
+	size_t Size() const noexcept { return _items.size(); }
+	
+	// Instances of built sprites
+	const std::vector<SpriteInstance>& GetInstances() const noexcept { return _instances; }
+	const std::vector<SpriteBatch>& GetBatches() const noexcept { return _batches; }
+	
+private:
+	struct Item {
+		const SpriteComponent* sprite;
+		const Matrix32* worldTransform;
+	};
+	
+	struct PathEntry {
+		const Matrix32* worldTransform;
+		bool hidden;
+	};
+	
+	void AppendChildren(SceneObject root, bool write) noexcept;
+	void AppendObjects(const SceneObject* objects, size_t count, bool write) noexcept;
+	void Append(const SpriteComponent& sprite, const Matrix32& worldTransform, bool write) noexcept;
+	// Writes instances of items from first to last, the first one at the start of the array
+	void WriteRange(SpriteInstance* instances, size_t first, size_t last) const noexcept;
+	
+private:
+	std::vector<Item> _items;
+	std::vector<SpriteInstance> _instances;
+	std::vector<SpriteBatch> _batches;
+	// Path of the scene walk, kept to avoid allocations
+	std::vector<PathEntry> _path;
+};
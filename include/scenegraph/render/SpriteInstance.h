@@ -0,0 +1,19 @@
+#pragma once
+
+#include <scenegraph/math/Matrix32.h>
+#include <scenegraph/imaging/Color.h>
+
+///
+/// Per sprite record of the instance stream, matches SpriteData of PullSpriteBatch.vert.hlsl
+///
+/// Unit quad offset by the pivot is transformed by the matrix, texture coordinates span the rectangle.
+///
+struct SpriteInstance {
+	Matrix32 transform;
+	float pivotX;
+	float pivotY;
+	FloatColor color;
+	float texU, texV, texW, texH;
+};
+
+static_assert(sizeof(SpriteInstance) == 64);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <scenegraph/SceneObject.h>
+#include <scenegraph/render/SpriteInstance.h>
+#include <scenegraph/render/SpriteBatcher.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SpriteComponent;
+class Transform2DComponent;
+class UploadManager;
+
+///
+/// Range of instance slots rewritten since the last upload
+///
+struct SpriteDirtyRange {
+	uint32_t first;
+	uint32_t count;
+};
+
+///
+/// Persistent sprite instance stream mirrored in a GPU buffer, each visible sprite owns a slot between frames
+///
+/// Slots follow the draw order of the scene walk. A slot is rewritten only when the world version of the transform
+/// of its sprite or the version of the sprite has changed, and a different sprite at a slot, e.g. after insertion,
+/// removal or hiding, rewrites slots from there on. Rewritten slots form dirty ranges and Upload copies only those,
+/// so sprites which do not move cost no upload bandwidth. World transforms must be updated first.
+///
+class SpriteInstanceBuffer {
+public:
+	// Ranges closer than this are uploaded together, a few clean slots are cheaper than another copy region
+	static constexpr uint32_t kMergeGap = 8;
+	
+	// Updates slots of visible sprites of children of the root in preorder
+	void Update(SceneObject root) noexcept;
+	
+	// Uploads dirty ranges into the buffer and clears them
+	void Upload(UploadManager& uploads, void* buffer) noexcept;
+	
+	// Marks all slots dirty, e.g. when the GPU buffer was recreated
+	void Invalidate() noexcept;
+	
+	const std::vector<SpriteInstance>& GetInstances() const noexcept { return _instances; }
+	const std::vector<SpriteBatch>& GetBatches() const noexcept { return _batches; }
+	const std::vector<SpriteDirtyRange>& GetDirtyRanges() const noexcept { return _dirtyRanges; }
+	
+private:
+	struct Slot {
+		const SpriteComponent* sprite;
+		uint64_t spriteVersion;
+		uint64_t worldVersion;
+	};
+	
+	struct PathEntry {
+		const Transform2DComponent* transform;
+		bool hidden;
+	};
+	
+	void Write(const SpriteComponent& sprite, const Transform2DComponent* transform) noexcept;
+	void MarkDirty(uint32_t slot) noexcept;
+	
+private:
+	std::vector<SpriteInstance> _instances;
+	std::vector<Slot> _slots;
+	std::vector<SpriteBatch> _batches;
+	std::vector<SpriteDirtyRange> _dirtyRanges;
+	// Path of the scene walk, kept to avoid allocations
+	std::vector<PathEntry> _path;
+	// Number of slots written by the current update
+	uint32_t _count = 0;
+};
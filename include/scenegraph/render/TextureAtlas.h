@@ -0,0 +1,78 @@
+#pragma once
+
+#include <scenegraph/render/SkylinePacker.h>
+#include <scenegraph/imaging/Color.h>
+#include <scenegraph/math/Rect.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+///
+/// Places RGBA images into shared pages, so sprites of different images are drawn with one texture
+///
+/// Pages are square and kept in memory, images are copied into them with a border of padding texels repeating
+/// their edges, so filtering does not bleed neighbours in. Regions are inserted and removed at any time, space of
+/// removed regions is reused and a page is whole again once its last region is removed. Changed texels of each
+/// page are tracked by a dirty rectangle, which is uploaded to the page texture and cleared by the owner of textures.
+///
+class TextureAtlas {
+public:
+	using RegionId = uint32_t;
+	
+	static constexpr RegionId kInvalidRegion = ~RegionId{0};
+	static constexpr uint32_t kDefaultPageSize = 2048;
+	static constexpr uint32_t kDefaultPadding = 1;
+	
+	explicit TextureAtlas(uint32_t pageSize = kDefaultPageSize, uint32_t padding = kDefaultPadding, uint32_t maxPages = UINT32_MAX) noexcept;
+	
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+	
+	// Copies the image into a page, returns invalid region when it is larger than a page or pages are exhausted
+	RegionId Insert(const Color* pixels, uint32_t width, uint32_t height) noexcept;
+	void Remove(RegionId region) noexcept;
+	
+	// Number of live regions
+	size_t Size() const noexcept { return _regions.size() - _freeCount; }
+	
+	uint32_t GetPage(RegionId region) const noexcept { return _regions[region].page; }
+	// Texels of the image without padding
+	const AtlasRect& GetRect(RegionId region) const noexcept { return _regions[region].rect; }
+	// Normalized texture coordinates for SpriteComponent::textureRect
+	Rect GetTextureRect(RegionId region) const noexcept;
+	
+	uint32_t GetPageSize() const noexcept { return _pageSize; }
+	size_t GetPageCount() const noexcept { return _pages.size(); }
+	const Color* GetPagePixels(uint32_t page) const noexcept { return _pages[page]->pixels.get(); }
+	float GetPageOccupancy(uint32_t page) const noexcept { return _pages[page]->packer.GetOccupancy(); }
+	
+	// Texels changed since the last clear, empty when width is zero
+	const AtlasRect& GetDirtyRect(uint32_t page) const noexcept { return _pages[page]->dirtyRect; }
+	void ClearDirtyRects() noexcept;
+	
+private:
+	struct Page {
+		SkylinePacker packer;
+		std::unique_ptr<Color[]> pixels;
+		AtlasRect dirtyRect;
+	};
+	
+	struct Region {
+		uint32_t page;
+		AtlasRect rect;
+		RegionId nextFree;
+	};
+	
+	void CopyPixels(Page& page, const AtlasRect& rect, const Color* pixels) noexcept;
+	
+private:
+	uint32_t _pageSize = 0;
+	uint32_t _padding = 0;
+	uint32_t _maxPages = 0;
+	std::vector<std::unique_ptr<Page>> _pages;
+	std::vector<Region> _regions;
+	RegionId _freeHead = kInvalidRegion;
+	size_t _freeCount = 0;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <scenegraph/gpu/Buffer.h>
+#include <scenegraph/gpu/UploadDevice.h>
+#include <scenegraph/utils/NonCopyable.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+///
+/// Suballocates per-frame upload data from a persistent ring of transfer memory
+///
+/// Each frame starts with BeginFrame, which waits while the maximum number of frames is in flight and returns
+/// ranges of completed frames to the ring. Upload returns memory for the data to copy, adjacent uploads into the same
+/// buffer are merged, and Flush records all of them in one copy pass. EndFrame submits the command buffer and keeps
+/// its fence. When the ring is full it grows to the next power of two, the old transfer buffer is released once
+/// the frames using it complete.
+///
+/// Upload may be called from work threads to fill parts of the frame data in parallel, the rest is for the thread
+/// recording the frame. Reserve before such uploads keeps the ring from growing on a work thread.
+///
+class UploadManager : public NonCopyableNonMovable {
+public:
+	static constexpr uint32_t kDefaultCapacity = 64 * 1024;
+	static constexpr uint32_t kDefaultFramesInFlight = 3;
+	static constexpr uint32_t kDefaultAlignment = 16;
+	
+	explicit UploadManager(UploadDevice& device, uint32_t capacity = kDefaultCapacity, uint32_t maxFramesInFlight = kDefaultFramesInFlight) noexcept;
+	~UploadManager();
+	
+	void BeginFrame() noexcept;
+	
+	// Makes sure uploads of size bytes in total fit without growing the ring and maps it
+	void Reserve(uint32_t size, uint32_t alignment = kDefaultAlignment) noexcept;
+	
+	// Returns memory to write size bytes copied to the buffer at offset on flush, valid until the flush.
+	// Alignment must be a power of two. Thread-safe
+	void* Upload(void* buffer, uint32_t offset, uint32_t size, uint32_t alignment = kDefaultAlignment) noexcept;
+	void* Upload(const Buffer& buffer, uint32_t offset, uint32_t size, uint32_t alignment = kDefaultAlignment) noexcept {
+		return Upload(buffer.Handle(), offset, size, alignment);
+	}
+	
+	// Records pending uploads in one copy pass, must precede render passes reading the buffers
+	void Flush(void* commandBuffer) noexcept;
+	
+	// Flushes what is left and submits the command buffer
+	void EndFrame(void* commandBuffer) noexcept;
+	
+	// Waits for all frames in flight, e.g. before destroying the buffers
+	void WaitIdle() noexcept;
+	
+	uint32_t GetCapacity() const noexcept { return _capacity; }
+	size_t GetFramesInFlight() const noexcept { return _frames.size(); }
+	size_t GetPendingRegionCount() const noexcept { return _regions.size(); }
+	
+private:
+	struct Frame {
+		void* fence;
+		void* transferBuffer;
+		uint64_t serial;
+		uint64_t head;
+	};
+	
+	struct RetiredBuffer {
+		void* transferBuffer;
+		uint64_t serial;
+		bool mapped;
+	};
+	
+	bool Allocate(uint32_t size, uint32_t alignment, uint32_t* offset) noexcept;
+	void Map() noexcept;
+	void Grow(uint32_t size, uint32_t alignment) noexcept;
+	void CompleteFrame() noexcept;
+	void ReleaseRetiredBuffers() noexcept;
+	
+private:
+	UploadDevice& _device;
+	void* _transferBuffer = nullptr;
+	std::byte* _mappedData = nullptr;
+	uint32_t _capacity = 0;
+	uint32_t _maxFramesInFlight = 0;
+	// Positions grow monotonically, offsets in the buffer are taken modulo capacity
+	uint64_t _head = 0;
+	uint64_t _tail = 0;
+	// Serial of the last submitted and the last completed frame
+	uint64_t _serial = 0;
+	uint64_t _completedSerial = 0;
+	std::vector<UploadRegion> _regions;
+	std::vector<Frame> _frames;
+	std::vector<RetiredBuffer> _retiredBuffers;
+	// Guards allocation and regions for uploads from work threads
+	std::mutex _mutex;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <scenegraph/SceneObject.h>
+#include <scenegraph/math/AABB.h>
+#include <scenegraph/math/Sphere.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+
+struct Frustum;
+
+///
+/// Dynamic bounding volume hierarchy of 3D bounds for frustum, ray and sphere queries
+///
+/// Inserted proxies descend to the sibling with the cheapest surface area increase. Moved proxies are
+/// only marked, Refit then updates their ancestors until bounds stop changing, so a frame costs time
+/// proportional to the number of moved proxies. As refitted trees lose quality, the tree is rebuilt
+/// top-down with binned surface area heuristic once changes since the last build outnumber the proxies twice.
+///
+class BoundingVolumeHierarchy {
+public:
+	using ProxyId = uint32_t;
+	
+	static constexpr ProxyId kInvalidProxy = ~ProxyId{0};
+	
+	BoundingVolumeHierarchy() = default;
+	
+	BoundingVolumeHierarchy(const BoundingVolumeHierarchy&) = delete;
+	BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy&) = delete;
+	
+	// Number of live proxies
+	size_t Size() const noexcept { return _proxies.size() - _freeCount; }
+	
+	ProxyId Insert(SceneObject sceneObject, const AABB& bounds) noexcept;
+	// Takes effect in queries after Refit
+	void Move(ProxyId proxy, const AABB& bounds) noexcept;
+	void Remove(ProxyId proxy) noexcept;
+	void Clear() noexcept;
+	
+	// Propagates moved bounds up the tree, rebuilds it when too many changes accumulated
+	void Refit() noexcept;
+	// Builds the tree from scratch with surface area heuristic
+	void Rebuild() noexcept;
+	
+	const AABB& GetBounds(ProxyId proxy) const noexcept { return _proxies[proxy].bounds; }
+	SceneObject GetSceneObject(ProxyId proxy) const noexcept { return _proxies[proxy].sceneObject; }
+	
+	// Sum of surface areas of internal nodes relative to the root, lower is better
+	float Cost() const noexcept;
+	
+	// void Handler(SceneObject, bool& stop), returns true if stopped
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QueryFrustum(const Frustum& frustum, Handler&& handler) noexcept;
+	
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QuerySphere(const Sphere& sphere, Handler&& handler) noexcept;
+	
+	// void Handler(SceneObject, float distance, bool& stop), reports boxes hit within max distance in no particular order.
+	// Distance is measured in units of direction length
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, float, bool&>>>
+	bool RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, Handler&& handler) noexcept;
+	
+private:
+	using QueryCallback = void(*)(SceneObject sceneObject, bool& stop, void* context);
+	using RayCastCallback = void(*)(SceneObject sceneObject, float distance, bool& stop, void* context);
+	
+	using NodeIndex = int32_t;
+	static constexpr NodeIndex kNullNode = -1;
+	
+	struct Node {
+		AABB bounds;
+		NodeIndex parent;
+		NodeIndex children[2];
+		// Leaf nodes only
+		ProxyId proxy;
+		bool moved;
+		
+		bool IsLeaf() const noexcept { return children[0] == kNullNode; }
+	};
+	
+	struct StackEntry {
+		NodeIndex node;
+		// Node is known to be inside the query volume
+		bool inside;
+	};
+	
+	struct Proxy {
+		AABB bounds;
+		SceneObject sceneObject;
+		NodeIndex leaf;
+		ProxyId nextFree;
+	};
+	
+	bool QueryFrustum(const Frustum& frustum, QueryCallback callback, void* context) noexcept;
+	bool QuerySphere(const Sphere& sphere, QueryCallback callback, void* context) noexcept;
+	bool RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, RayCastCallback callback, void* context) noexcept;
+	
+	NodeIndex AllocateNode() noexcept;
+	void FreeNode(NodeIndex node) noexcept;
+	
+	void InsertLeaf(NodeIndex leaf) noexcept;
+	void RemoveLeaf(NodeIndex leaf) noexcept;
+	void RefitAncestors(NodeIndex node) noexcept;
+	
+	NodeIndex Build(NodeIndex* leaves, size_t count) noexcept;
+	
+private:
+	std::vector<Node> _nodes;
+	NodeIndex _root = kNullNode;
+	NodeIndex _freeNode = kNullNode;
+	
+	std::vector<Proxy> _proxies;
+	ProxyId _freeProxy = kInvalidProxy;
+	size_t _freeCount = 0;
+	
+	std::vector<NodeIndex> _movedLeaves;
+	size_t _changesSinceBuild = 0;
+	
+	// Traversal stack reused by queries
+	std::vector<StackEntry> _stack;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+template <typename Handler, typename>
+bool BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, Handler&& handler) noexcept {
+	return QueryFrustum(frustum,
+		+[](SceneObject sceneObject, bool& stop, void* context) {
+			std::invoke(std::forward<Handler>(*static_cast<Handler*>(context)), sceneObject, stop);
+		},
+		std::addressof(handler));
+}
+
+template <typename Handler, typename>
+bool BoundingVolumeHierarchy::QuerySphere(const Sphere& sphere, Handler&& handler) noexcept {
+	return QuerySphere(sphere,
+		+[](SceneObject sceneObject, bool& stop, void* context) {
+			std::invoke(std::forward<Handler>(*static_cast<Handler*>(context)), sceneObject, stop);
+		},
+		std::addressof(handler));
+}
+
+template <typename Handler, typename>
+bool BoundingVolumeHierarchy::RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, Handler&& handler) noexcept {
+	return RayCast(origin, direction, maxDistance,
+		+[](SceneObject sceneObject, float distance, bool& stop, void* context) {
+			std::invoke(std::forward<Handler>(*static_cast<Handler*>(context)), sceneObject, distance, stop);
+		},
+		std::addressof(handler));
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <scenegraph/SceneObject.h>
+#include <scenegraph/math/Rect.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+///
+/// Uniform hash grid of 2D bounds for point and rectangle queries
+///
+/// Each proxy is registered in every cell its bounds overlap. Updating bounds which stay in the same
+/// cells costs only a store, so moving objects are cheap as long as they are small relative to cells.
+/// Proxies spanning too many cells are kept in a separate list checked by every query. Cells left empty
+/// are kept for objects coming back and are pruned at once when they outnumber the occupied ones.
+///
+class SpatialGrid2D {
+public:
+	using ProxyId = uint32_t;
+	
+	static constexpr ProxyId kInvalidProxy = ~ProxyId{0};
+	static constexpr int kMaxCellsPerProxy = 16;
+	// Empty cells are never pruned below this count
+	static constexpr size_t kMinPrunedCells = 1024;
+	
+	explicit SpatialGrid2D(float cellSize = 128.0f) noexcept;
+	
+	SpatialGrid2D(const SpatialGrid2D&) = delete;
+	SpatialGrid2D& operator=(const SpatialGrid2D&) = delete;
+	
+	float CellSize() const noexcept { return _cellSize; }
+	// Number of live proxies
+	size_t Size() const noexcept { return _proxies.size() - _freeCount; }
+	// Number of cells in the hash, including empty ones
+	size_t GetCellCount() const noexcept { return _cells.size(); }
+	
+	// Empty bounds keep proxy out of queries until updated
+	ProxyId Insert(SceneObject sceneObject, const Rect& bounds) noexcept;
+	void Update(ProxyId proxy, const Rect& bounds) noexcept;
+	void Remove(ProxyId proxy) noexcept;
+	void Clear() noexcept;
+	// Prunes empty cells
+	void Compact() noexcept;
+	
+	const Rect& GetBounds(ProxyId proxy) const noexcept { return _proxies[proxy].bounds; }
+	SceneObject GetSceneObject(ProxyId proxy) const noexcept { return _proxies[proxy].sceneObject; }
+	
+	// void Handler(SceneObject, bool& stop), returns true if stopped
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QueryPoint(Vector2 p, Handler&& handler) noexcept;
+	
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, SceneObject, bool&>>>
+	bool QueryRect(const Rect& r, Handler&& handler) noexcept;
+	
+private:
+	using QueryCallback = void(*)(SceneObject sceneObject, bool& stop, void* context);
+	
+	struct CellRange {
+		int32_t minX, minY, maxX, maxY;
+		
+		bool operator==(const CellRange&) const noexcept = default;
+		bool Empty() const noexcept { return minX > maxX; }
+		bool Oversized() const noexcept;
+	};
+	
+	struct Proxy {
+		Rect bounds;
+		SceneObject sceneObject;
+		CellRange cells;
+		uint32_t queryStamp;
+		ProxyId nextFree;
+	};
+	
+	bool QueryPoint(Vector2 p, QueryCallback callback, void* context) noexcept;
+	bool QueryRect(const Rect& r, QueryCallback callback, void* context) noexcept;
+	
+	CellRange GetCellRange(const Rect& bounds) const noexcept;
+	
+	void Link(ProxyId proxy, const CellRange& cells) noexcept;
+	void Unlink(ProxyId proxy, const CellRange& cells) noexcept;
+	
+	static uint64_t CellKey(int32_t x, int32_t y) noexcept {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+	
+private:
+	float _cellSize;
+	float _inverseCellSize;
+	
+	std::vector<Proxy> _proxies;
+	ProxyId _freeHead = kInvalidProxy;
+	size_t _freeCount = 0;
+	
+	std::unordered_map<uint64_t, std::vector<ProxyId>> _cells;
+	size_t _emptyCellCount = 0;
+	std::vector<ProxyId> _oversized;
+	
+	// Proxies overlapping several cells are reported once per query
+	uint32_t _queryStamp = 0;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+template <typename Handler, typename>
+bool SpatialGrid2D::QueryPoint(Vector2 p, Handler&& handler) noexcept {
+	return QueryPoint(p,
+		+[](SceneObject sceneObject, bool& stop, void* context) {
+			std::invoke(std::forward<Handler>(*static_cast<Handler*>(context)), sceneObject, stop);
+		},
+		std::addressof(handler));
+}
+
+template <typename Handler, typename>
+bool SpatialGrid2D::QueryRect(const Rect& r, Handler&& handler) noexcept {
+	return QueryRect(r,
+		+[](SceneObject sceneObject, bool& stop, void* context) {
+			std::invoke(std::forward<Handler>(*static_cast<Handler*>(context)), sceneObject, stop);
+		},
+		std::addressof(handler));
+}
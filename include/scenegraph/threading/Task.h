@@ -0,0 +1,322 @@
+#pragma once
+
+#include <scenegraph/threading/WorkThread.h>
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+
+///
+/// Task promise base
+///
+/// Owns the pipe task used to hop between threads, so switching threads costs no allocation
+/// beyond the coroutine frame itself. Callback in resumes the coroutine on the work thread,
+/// callback out resumes it on the thread which pumps WorkThread::TryPop (the main thread).
+/// Tasks awaited on a work thread start there too and hop back through the same work thread.
+///
+class TaskPromiseBase {
+public:
+	struct FinalAwaiter {
+		bool await_ready() const noexcept { return false; }
+
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+			return handle.promise().Finish();
+		}
+
+		void await_resume() const noexcept {}
+	};
+
+	std::suspend_always initial_suspend() const noexcept { return {}; }
+	FinalAwaiter final_suspend() const noexcept { return {}; }
+
+	void unhandled_exception() const noexcept { std::terminate(); }
+
+	bool Done() const noexcept { return _done; }
+
+	// Work thread the awaiting task runs on, if any, is where this task starts
+	void SetContinuation(std::coroutine_handle<> continuation, WorkThread* workThread = nullptr) noexcept {
+		_continuation = continuation;
+		_workThread = workThread;
+	}
+
+	// Work thread the task runs on, null on the main thread
+	WorkThread* GetWorkThread() const noexcept { return _workThread; }
+
+	// Suspends on the current thread and resumes on the work thread
+	bool SwitchToWorkThread(WorkThread& thread, std::coroutine_handle<> handle) noexcept {
+		// The pipe task can not be queued twice, go back to the main thread first
+		assert(!_inFlight);
+		if (_inFlight) {
+			return false;
+		}
+
+		_handle = handle;
+		Push(thread, &TaskPromiseBase::ResumeIn);
+		return true;
+	}
+
+	// Suspends on the work thread and resumes on the main thread, no-op if already there
+	bool SwitchToMainThread(std::coroutine_handle<> handle) noexcept {
+		if (!_workThread) {
+			return false;
+		}
+
+		_resumeOnOut = true;
+		_handle = handle;
+		PushOut();
+		return true;
+	}
+
+private:
+	void Push(WorkThread& thread, void (*callbackIn)(void*)) noexcept {
+		_inFlight = true;
+		_workThread = &thread;
+		_pipeTask = {
+			.callbackIn = callbackIn,
+			.callbackOut = &TaskPromiseBase::ResumeOut,
+			.param = this
+		};
+		thread.Push(&_pipeTask);
+	}
+
+	// Hands the task back to the main thread, either with the pipe task being executed or with a new one when the
+	// task was started by another one on the work thread
+	void PushOut() noexcept {
+		if (!_inFlight) {
+			Push(*_workThread, nullptr);
+		}
+	}
+
+	std::coroutine_handle<> Finish() noexcept {
+		// Complete on the main thread when the task runs on a work thread
+		if (_workThread) {
+			_finishOnOut = true;
+			PushOut();
+			return std::noop_coroutine();
+		}
+
+		_done = true;
+		return _continuation ? _continuation : std::noop_coroutine();
+	}
+
+	static void ResumeIn(void* param) noexcept {
+		static_cast<TaskPromiseBase*>(param)->_handle.resume();
+	}
+
+	static void ResumeOut(void* param) noexcept {
+		auto promise = static_cast<TaskPromiseBase*>(param);
+		promise->_inFlight = false;
+		promise->_workThread = nullptr;
+
+		if (std::exchange(promise->_finishOnOut, false)) {
+			promise->_done = true;
+			if (auto continuation = promise->_continuation) {
+				continuation.resume();
+			}
+		}
+		else if (std::exchange(promise->_resumeOnOut, false)) {
+			promise->_handle.resume();
+		}
+	}
+
+private:
+	PipeTask _pipeTask;
+	std::coroutine_handle<> _handle;
+	std::coroutine_handle<> _continuation;
+	WorkThread* _workThread = nullptr;
+	bool _inFlight = false;
+	bool _resumeOnOut = false;
+	bool _finishOnOut = false;
+	bool _done = false;
+};
+
+template <typename T> class Task;
+
+///
+/// Task promise
+///
+template <typename T>
+class TaskPromise final : public TaskPromiseBase {
+public:
+	Task<T> get_return_object() noexcept;
+
+	template <typename U>
+	void return_value(U&& value) noexcept { _value.emplace(std::forward<U>(value)); }
+
+	T& Result() noexcept { assert(_value); return *_value; }
+
+private:
+	std::optional<T> _value;
+};
+
+template <>
+class TaskPromise<void> final : public TaskPromiseBase {
+public:
+	Task<void> get_return_object() noexcept;
+
+	void return_void() const noexcept {}
+
+	void Result() const noexcept {}
+};
+
+///
+/// Task is a lazily started coroutine
+///
+/// Starts on Start() or when awaited, and always completes on the main thread, i.e. the one
+/// which pumps WorkThread::TryPop, even if it was last resumed or awaited on a work thread.
+///
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+	using promise_type = TaskPromise<T>;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	Task() = default;
+
+	explicit Task(Handle handle) noexcept
+		: _handle(handle)
+	{
+	}
+
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	Task(Task&& rhs) noexcept
+		: _handle(std::exchange(rhs._handle, {}))
+		, _started(std::exchange(rhs._started, false))
+	{
+	}
+
+	Task& operator=(Task&& rhs) noexcept {
+		if (&rhs != this) {
+			Destroy();
+			_handle = std::exchange(rhs._handle, {});
+			_started = std::exchange(rhs._started, false);
+		}
+		return *this;
+	}
+
+	~Task() { Destroy(); }
+
+	bool Valid() const noexcept { return static_cast<bool>(_handle); }
+
+	void Start() noexcept {
+		assert(_handle && !_started);
+		if (_handle && !std::exchange(_started, true)) {
+			_handle.resume();
+		}
+	}
+
+	bool Done() const noexcept { return _handle && _handle.promise().Done(); }
+
+	decltype(auto) Result() noexcept {
+		assert(Done());
+		return _handle.promise().Result();
+	}
+
+	auto operator co_await() && noexcept {
+		assert(!_started);
+		_started = true;
+		return Awaiter{_handle};
+	}
+
+private:
+	struct Awaiter {
+		Handle handle;
+
+		bool await_ready() const noexcept { return !handle || handle.promise().Done(); }
+
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> continuation) noexcept {
+			if constexpr (std::is_base_of_v<TaskPromiseBase, Promise>) {
+				handle.promise().SetContinuation(continuation, continuation.promise().GetWorkThread());
+			}
+			else {
+				handle.promise().SetContinuation(continuation);
+			}
+			return handle;
+		}
+
+		decltype(auto) await_resume() noexcept {
+			if constexpr (std::is_void_v<T>) {
+				return;
+			}
+			else {
+				return std::move(handle.promise().Result());
+			}
+		}
+	};
+
+	void Destroy() noexcept {
+		if (_handle) {
+			// Destroying a task queued in a work thread leaves a dangling pipe task
+			assert(!_started || _handle.promise().Done());
+			_handle.destroy();
+			_handle = {};
+			_started = false;
+		}
+	}
+
+private:
+	Handle _handle;
+	bool _started = false;
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+	return Task<T>{Task<T>::Handle::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+	return Task<void>{Task<void>::Handle::from_promise(*this)};
+}
+
+///
+/// Awaiter resuming the task on the work thread
+///
+class WorkThreadAwaiter {
+public:
+	explicit WorkThreadAwaiter(WorkThread& thread) noexcept
+		: _thread(thread)
+	{
+	}
+
+	bool await_ready() const noexcept { return false; }
+
+	template <typename Promise>
+	bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+		static_assert(std::is_base_of_v<TaskPromiseBase, Promise>);
+		return handle.promise().SwitchToWorkThread(_thread, handle);
+	}
+
+	void await_resume() const noexcept {}
+
+private:
+	WorkThread& _thread;
+};
+
+///
+/// Awaiter resuming the task on the main thread
+///
+class MainThreadAwaiter {
+public:
+	bool await_ready() const noexcept { return false; }
+
+	template <typename Promise>
+	bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+		static_assert(std::is_base_of_v<TaskPromiseBase, Promise>);
+		return handle.promise().SwitchToMainThread(handle);
+	}
+
+	void await_resume() const noexcept {}
+};
+
+// co_await SwitchToWorkThread(thread);
+inline WorkThreadAwaiter SwitchToWorkThread(WorkThread& thread) noexcept { return WorkThreadAwaiter{thread}; }
+
+// co_await SwitchToMainThread();
+inline MainThreadAwaiter SwitchToMainThread() noexcept { return MainThreadAwaiter{}; }
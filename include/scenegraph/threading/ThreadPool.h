@@ -0,0 +1,98 @@
+#pragma once
+
+#include <scenegraph/threading/WorkThread.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+
+///
+/// Pool of work threads with data-parallel loops
+///
+/// Must be owned and pumped by a single thread (the main thread). ParallelFor and ParallelReduce
+/// split the range into grain sized chunks which are handed out dynamically to the work threads
+/// and to the calling thread, so uneven chunks balance themselves.
+///
+class ThreadPool {
+public:
+	// Hardware concurrency minus the calling thread
+	static size_t DefaultThreadCount() noexcept;
+
+	explicit ThreadPool(size_t threadCount = DefaultThreadCount(), const WorkThreadOptions& options = {}) noexcept;
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	size_t ThreadCount() const noexcept { return _threads.size(); }
+	WorkThread& GetThread(size_t index) noexcept { return *_threads[index]; }
+
+	// Sum of all thread counters
+	WorkThreadStats GetStats() const noexcept;
+
+	// Pushes task to the next thread in round-robin order
+	void Push(PipeTask* task) noexcept;
+	// Pops the first completed task from any thread
+	PipeTask* TryPop() noexcept;
+
+	void WaitAll() noexcept;
+
+	// void Handler(size_t begin, size_t end)
+	template <typename Handler, typename = std::enable_if_t<std::is_invocable_v<Handler, size_t, size_t>>>
+	void ParallelFor(size_t begin, size_t end, size_t grain, Handler&& handler) noexcept;
+
+	// T Map(size_t begin, size_t end), T Reduce(T, T)
+	// Chunk results are combined in range order, so the result does not depend on scheduling
+	template <typename T, typename Map, typename Reduce>
+	T ParallelReduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Reduce&& reduce) noexcept;
+
+private:
+	using ParallelForCallback = void(*)(size_t begin, size_t end, void* context);
+
+	void ParallelFor(size_t begin, size_t end, size_t grain, ParallelForCallback callback, void* context) noexcept;
+
+private:
+	std::vector<std::unique_ptr<WorkThread>> _threads;
+	std::unique_ptr<PipeTask[]> _parallelTasks;
+	size_t _nextThread = 0;
+	bool _inParallelFor = false;
+};
+
+template <typename Handler, typename>
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain, Handler&& handler) noexcept {
+	ParallelFor(begin, end, grain,
+		+[](size_t first, size_t last, void* context) {
+			std::invoke(*static_cast<std::remove_reference_t<Handler>*>(context), first, last);
+		},
+		std::addressof(handler));
+}
+
+template <typename T, typename Map, typename Reduce>
+T ThreadPool::ParallelReduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Reduce&& reduce) noexcept {
+	if (begin >= end) {
+		return identity;
+	}
+
+	if (grain == 0) {
+		grain = 1;
+	}
+
+	auto chunkCount = (end - begin + grain - 1) / grain;
+	if (chunkCount == 1) {
+		return std::invoke(reduce, std::move(identity), std::invoke(map, begin, end));
+	}
+
+	std::vector<T> results(chunkCount, identity);
+
+	ParallelFor(begin, end, grain, [&](size_t first, size_t last) {
+		results[(first - begin) / grain] = std::invoke(map, first, last);
+	});
+
+	T result = std::move(identity);
+	for (auto& value : results) {
+		result = std::invoke(reduce, std::move(result), std::move(value));
+	}
+
+	return result;
+}
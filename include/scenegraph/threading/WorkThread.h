@@ -1,7 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
+#include <string>
 #include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 struct PipeTask {
 	PipeTask* next = nullptr;
@@ -17,7 +22,10 @@ class Pipe {
 public:
 	Pipe() = default;
 	
+	// Pushes chain of tasks linked through next
 	void Push(PipeTask* task) noexcept;
+	// Pushes chain of tasks from head to tail without walking it
+	void Push(PipeTask* head, PipeTask* tail) noexcept;
 	
 	PipeTask* Peek() noexcept;
 	PipeTask* TryPop() noexcept;
@@ -33,6 +41,91 @@ private:
 	std::atomic_flag _busy = ATOMIC_FLAG_INIT;
 };
 
+///
+/// Chain of tasks pushed at once
+///
+/// Costs one atomic exchange and at most one wake-up regardless of its size.
+/// Tasks are executed in the order they were added.
+///
+class PipeTaskBatch {
+public:
+	PipeTaskBatch() = default;
+	
+	PipeTaskBatch(const PipeTaskBatch&) = delete;
+	PipeTaskBatch& operator=(const PipeTaskBatch&) = delete;
+	
+	void Add(PipeTask* task) noexcept {
+		// Pipe reverses pushed chain, so prepend to keep the order
+		task->next = _head;
+		_head = task;
+		if (!_tail) {
+			_tail = task;
+		}
+		++_size;
+	}
+	
+	bool Empty() const noexcept { return !_head; }
+	size_t Size() const noexcept { return _size; }
+	
+	PipeTask* Head() const noexcept { return _head; }
+	PipeTask* Tail() const noexcept { return _tail; }
+	
+	void Clear() noexcept {
+		_head = nullptr;
+		_tail = nullptr;
+		_size = 0;
+	}
+	
+private:
+	PipeTask* _head = nullptr;
+	PipeTask* _tail = nullptr;
+	size_t _size = 0;
+};
+
+///
+/// Arena of tasks reset once per frame
+///
+/// Tasks are allocated in pages which are kept on reset, so after warming up there are no
+/// allocations. Tasks must be popped back before reset.
+///
+class PipeTaskArena {
+public:
+	static constexpr size_t kPageSize = 256;
+	
+	PipeTaskArena() = default;
+	
+	PipeTaskArena(const PipeTaskArena&) = delete;
+	PipeTaskArena& operator=(const PipeTaskArena&) = delete;
+	
+	PipeTask* New(void (*callbackIn)(void*), void (*callbackOut)(void*), void* param) noexcept;
+	
+	void Reset() noexcept;
+	
+	size_t Size() const noexcept { return _size; }
+	
+private:
+	std::vector<std::unique_ptr<PipeTask[]>> _pages;
+	size_t _size = 0;
+};
+
+enum class WorkThreadPriority {
+	Low,    // Background work, e.g. I/O
+	Normal,
+	High    // Latency sensitive work, e.g. render preparation
+};
+
+struct WorkThreadOptions {
+	const char* name = nullptr;  // Truncated to 15 characters on Linux
+	uint64_t affinityMask = 0;   // Bit per CPU, 0 lets the thread run on any CPU. Ignored on Apple platforms
+	WorkThreadPriority priority = WorkThreadPriority::Normal;
+};
+
+struct WorkThreadStats {
+	uint64_t tasksExecuted = 0;
+	uint64_t busyNanoseconds = 0;
+	uint64_t idleNanoseconds = 0;
+};
+
 ///
 /// Work thread with task queue
 ///
@@ -40,20 +133,34 @@ class WorkThread {
 public:
 	WorkThread() = default;
 	
+	explicit WorkThread(const WorkThreadOptions& options) noexcept;
+	
 	~WorkThread();
 	
 	void Push(PipeTask* task) noexcept;
+	// Pushes all tasks in the batch and clears it
+	void Push(PipeTaskBatch& batch) noexcept;
 	PipeTask* TryPop() noexcept;
 	
 	void WaitOne() noexcept;
 	void WaitAll() noexcept;
 	
+	// Counters are updated by the thread as it goes and may be read from any thread
+	WorkThreadStats GetStats() const noexcept;
+	
 private:
 	void ThreadBody() noexcept;
+	void ApplyOptions() noexcept;
 
 private:
 	Pipe _incoming;
 	Pipe _outcoming;
+	std::string _name;
+	uint64_t _affinityMask = 0;
+	WorkThreadPriority _priority = WorkThreadPriority::Normal;
+	std::atomic<uint64_t> _tasksExecuted = 0;
+	std::atomic<uint64_t> _busyNanoseconds = 0;
+	std::atomic<uint64_t> _idleNanoseconds = 0;
 	std::thread _thread{&WorkThread::ThreadBody, this};
 	std::atomic_flag _stop = ATOMIC_FLAG_INIT;
 };
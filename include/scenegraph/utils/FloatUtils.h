@@ -2,6 +2,8 @@
 
 #include <scenegraph/utils/BitUtils.h>
 
+#include <cstdint>
+
 constexpr int FloatsDifferenceULPs(float a, float b) {
 	// Make aInt lexicographically ordered as a two's-complement int
 	int aInt = BitCast<int>(a);
@@ -40,3 +42,41 @@ constexpr float Lerp(float a, float b, float s) {
 	assert(s >= 0 && s <= 1);
 	return DifferenceOfProducts(b, s, a, s - 1.0f);
 }
+
+// Converts to IEEE half precision rounding to nearest even, out of range values become infinity
+constexpr uint16_t FloatToHalf(float x) {
+	auto f = BitCast<uint32_t>(x);
+	auto sign = f & 0x80000000u;
+	f ^= sign;
+	
+	uint32_t h;
+	if (f >= 0x47800000u) {
+		// Infinity or NaN
+		h = f > 0x7f800000u ? 0x7e00u : 0x7c00u;
+	}
+	else if (f < 0x38800000u) {
+		// Subnormal or zero, adding 0.5 shifts the mantissa into place and rounds it
+		h = BitCast<uint32_t>(BitCast<float>(f) + 0.5f) - 0x3f000000u;
+	}
+	else {
+		// Rebias exponent and round mantissa to nearest even
+		auto mantissaOdd = (f >> 13) & 1;
+		h = (f + 0xc8000fffu + mantissaOdd) >> 13;
+	}
+	
+	return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+constexpr float HalfToFloat(uint16_t h) {
+	auto sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+	auto exponent = (h >> 10) & 0x1fu;
+	auto mantissa = static_cast<uint32_t>(h & 0x3ffu);
+	
+	if (exponent == 0) {
+		auto value = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+		return sign ? -value : value;
+	}
+	
+	auto bits = exponent == 0x1f ? 0x7f800000u | (mantissa << 13) : ((exponent + 112) << 23) | (mantissa << 13);
+	return BitCast<float>(sign | bits);
+}
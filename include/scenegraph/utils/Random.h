@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+///
+/// Linear congruential generator giving the same sequence on every platform, e.g. for test data
+///
+/// Low bits of the state are weak, values are taken from the high 24 bits.
+///
+class Random {
+public:
+	explicit Random(uint32_t seed = 1) noexcept : _state(seed)
+	{
+	}
+	
+	// Next state with all its bits
+	uint32_t Next() noexcept {
+		_state = _state * 1664525u + 1013904223u;
+		return _state;
+	}
+	
+	// Uniform in [min, max)
+	float NextFloat(float min, float max) noexcept {
+		return min + (max - min) * static_cast<float>(Next() >> 8) / static_cast<float>(1 << 24);
+	}
+	
+	// Uniform in [min, max], slightly biased for large ranges
+	uint32_t NextUint(uint32_t min, uint32_t max) noexcept {
+		return min + (Next() >> 8) % (max - min + 1);
+	}
+	
+private:
+	uint32_t _state;
+};
@@ -0,0 +1,73 @@
+struct PackedSpriteData
+{
+    float2 Position;
+    uint TransformAB;
+    uint TransformCD;
+    uint Color;
+    uint RectIndexPivot;
+};
+
+struct Output
+{
+    float2 TexCoord : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+    float4 Position : SV_Position;
+};
+
+StructuredBuffer<PackedSpriteData> DataBuffer : register(t0, space0);
+StructuredBuffer<float4> RectBuffer : register(t1, space0);
+
+cbuffer UniformBlock : register(b0, space1)
+{
+    float4x4 ViewProjectionMatrix : packoffset(c0);
+};
+
+static const uint triangleIndices[6] = {0, 1, 2, 3, 2, 1};
+static const float2 vertexPos[4] = {
+    {0.0f, 0.0f},
+    {1.0f, 0.0f},
+    {0.0f, 1.0f},
+    {1.0f, 1.0f}
+};
+
+float4 UintToColor(dword color) {
+    float s = 1.0f / 255.0f;
+    return float4(
+        ((color >>  0) & 0xff) * s,
+        ((color >>  8) & 0xff) * s,
+        ((color >> 16) & 0xff) * s,
+        ((color >> 24) & 0xff) * s);
+}
+
+Output main(uint id : SV_VertexID)
+{
+    uint spriteIndex = id / 6;
+    uint vert = triangleIndices[id % 6];
+    PackedSpriteData sprite = DataBuffer[spriteIndex];
+
+    // Half floats of the linear part, rectangle index and unorm8 pivot
+    float2x2 transform = float2x2(
+        f16tof32(sprite.TransformAB), f16tof32(sprite.TransformAB >> 16),
+        f16tof32(sprite.TransformCD), f16tof32(sprite.TransformCD >> 16));
+    float4 rect = RectBuffer[sprite.RectIndexPivot & 0xffff];
+    float2 pivot = float2((sprite.RectIndexPivot >> 16) & 0xff, sprite.RectIndexPivot >> 24) * (1.0f / 255.0f);
+
+    float2 texcoord[4] = {
+        { rect.x,          rect.y          },
+        { rect.x + rect.z, rect.y          },
+        { rect.x,          rect.y + rect.w },
+        { rect.x + rect.z, rect.y + rect.w }
+    };
+
+    float2 coord = vertexPos[vert] - pivot;
+    
+    coord = mul(coord, transform) + sprite.Position;
+    
+    Output output;
+
+    output.Position = mul(ViewProjectionMatrix, float4(coord, 0.0f, 1.0f));
+    output.TexCoord = texcoord[vert];
+    output.Color = UintToColor(sprite.Color);
+ 
+    return output;
+}
@@ -4,7 +4,36 @@
 #include <scenegraph/memory/PoolAllocator.h>
 #include <scenegraph/memory/MonotonicAllocator.h>
 #include <scenegraph/utils/IteratorUtils.h>
+#include <scenegraph/utils/Random.h>
+#include <scenegraph/threading/ThreadPool.h>
+#include <scenegraph/math/Matrix32.h>
+#include <scenegraph/math/Matrix4.h>
+#include <scenegraph/math/Matrix43.h>
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/math/Transform.h>
+#include <scenegraph/math/Frustum.h>
+#include <scenegraph/math/Sphere.h>
+#include <scenegraph/math/AABB.h>
+#include <scenegraph/spatial/SpatialGrid2D.h>
+#include <scenegraph/spatial/BoundingVolumeHierarchy.h>
+#include <scenegraph/animation/Animator2D.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/components/SpriteComponent.h>
+#include <scenegraph/render/SpriteBatcher.h>
+#include <scenegraph/render/RenderQueue.h>
+#include <scenegraph/render/PackedSpriteInstance.h>
+#include <scenegraph/render/SpriteInstanceBuffer.h>
+#include <scenegraph/render/UploadManager.h>
+#include <scenegraph/render/TextureAtlas.h>
+#include <scenegraph/imaging/MipChain.h>
+#include <scenegraph/gpu/NullGpuDevice.h>
+#include <scenegraph/gpu/PipelineCache.h>
+#include <scenegraph/Scene.h>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 class Node : public ForwardListNode<Node> {
@@ -217,4 +246,783 @@ static void BM_StdAllocator(benchmark::State& state) {
 }
 BENCHMARK(BM_StdAllocator)->RangeMultiplier(2)->Range(1 << 8, 1 << 16);
 
+static void SqrtRange(std::vector<float>& values, size_t begin, size_t end) {
+	for (auto i = begin; i < end; ++i) {
+		values[i] = std::sqrt(values[i] + 1.0f);
+	}
+}
+
+static void BM_SerialFor(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<float> values(size);
+	for (auto _ : state) {
+		SqrtRange(values, 0, size);
+		benchmark::DoNotOptimize(values.data());
+	}
+}
+BENCHMARK(BM_SerialFor)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_ParallelFor(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<float> values(size);
+	ThreadPool pool;
+	for (auto _ : state) {
+		pool.ParallelFor(0, size, 4096, [&](size_t begin, size_t end) { SqrtRange(values, begin, end); });
+		benchmark::DoNotOptimize(values.data());
+	}
+}
+BENCHMARK(BM_ParallelFor)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void DrainWorkThread(WorkThread& thread, int64_t count) {
+	for (int64_t popped = 0; popped < count;) {
+		thread.WaitOne();
+		while (thread.TryPop()) {
+			++popped;
+		}
+	}
+}
+
+static void BM_WorkThreadPush(benchmark::State& state) {
+	const auto size = state.range();
+	WorkThread thread;
+	std::vector<PipeTask> tasks(static_cast<size_t>(size));
+	for (auto _ : state) {
+		for (auto& task : tasks) {
+			thread.Push(&task);
+		}
+		DrainWorkThread(thread, size);
+	}
+	state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_WorkThreadPush)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_WorkThreadPushBatch(benchmark::State& state) {
+	const auto size = state.range();
+	WorkThread thread;
+	PipeTaskArena arena;
+	for (auto _ : state) {
+		PipeTaskBatch batch;
+		for (int64_t i = 0; i < size; ++i) {
+			batch.Add(arena.New(nullptr, nullptr, nullptr));
+		}
+		thread.Push(batch);
+		DrainWorkThread(thread, size);
+		arena.Reset();
+	}
+	state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_WorkThreadPushBatch)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_Matrix32Multiply(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Matrix32> m1(size, Matrix32MakeRotation(0.5f)), m2(size, Matrix32MakeTranslation(1, 2)), out(size);
+	for (auto _ : state) {
+		for (size_t i = 0; i < size; ++i) {
+			out[i] = Matrix32Multiply(m1[i], m2[i]);
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Matrix32Multiply)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Matrix32MultiplyBatch(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Matrix32> m1(size, Matrix32MakeRotation(0.5f)), m2(size, Matrix32MakeTranslation(1, 2)), out(size);
+	for (auto _ : state) {
+		Matrix32MultiplyBatch(m1.data(), m2.data(), out.data(), size);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Matrix32MultiplyBatch)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Matrix32MakeWithTransform2D(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Transform2D> transforms(size, Transform2D{.sx = 2, .sy = 3, .shearX = 0, .shearY = 0, .rad = 0.5f, .tx = 10, .ty = 20});
+	std::vector<Matrix32> out(size);
+	for (auto _ : state) {
+		for (size_t i = 0; i < size; ++i) {
+			out[i] = Matrix32MakeWithTransform2D(transforms[i]);
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Matrix32MakeWithTransform2D)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Matrix32MakeWithTransform2DBatch(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Transform2D> transforms(size, Transform2D{.sx = 2, .sy = 3, .shearX = 0, .shearY = 0, .rad = 0.5f, .tx = 10, .ty = 20});
+	std::vector<Matrix32> out(size);
+	for (auto _ : state) {
+		Matrix32MakeWithTransform2DBatch(transforms.data(), out.data(), size);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Matrix32MakeWithTransform2DBatch)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Matrix32MakeWithTransform2DBatchSoA(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<float> sx(size, 2), sy(size, 3), rad(size, 0.5f), tx(size, 10), ty(size, 20);
+	Transform2DBatch transforms{sx.data(), sy.data(), nullptr, nullptr, rad.data(), tx.data(), ty.data()};
+	std::vector<Matrix32> out(size);
+	for (auto _ : state) {
+		Matrix32MakeWithTransform2DBatch(transforms, out.data(), size);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Matrix32MakeWithTransform2DBatchSoA)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Matrix4Multiply(benchmark::State& state) {
+	auto m1 = Matrix4MakeXRotation(0.5f);
+	auto m2 = Matrix4MakeTranslation(1, 2, 3);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m1);
+		auto out = Matrix4Multiply(m1, m2);
+		benchmark::DoNotOptimize(out);
+	}
+}
+BENCHMARK(BM_Matrix4Multiply);
+
+static void BM_Matrix4MultiplyAligned(benchmark::State& state) {
+	auto m1 = Matrix4AlignedMake(Matrix4MakeXRotation(0.5f));
+	auto m2 = Matrix4AlignedMake(Matrix4MakeTranslation(1, 2, 3));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m1);
+		auto out = Matrix4MultiplyAligned(m1, m2);
+		benchmark::DoNotOptimize(out);
+	}
+}
+BENCHMARK(BM_Matrix4MultiplyAligned);
+
+static void BM_Matrix4Invert(benchmark::State& state) {
+	auto m = Matrix4Multiply(Matrix4MakeXRotation(0.5f), Matrix4MakeTranslation(1, 2, 3));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m);
+		auto out = Matrix4Invert(m, nullptr);
+		benchmark::DoNotOptimize(out);
+	}
+}
+BENCHMARK(BM_Matrix4Invert);
+
+static void BM_Matrix4InvertAligned(benchmark::State& state) {
+	auto m = Matrix4AlignedMake(Matrix4Multiply(Matrix4MakeXRotation(0.5f), Matrix4MakeTranslation(1, 2, 3)));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m);
+		auto out = Matrix4InvertAligned(m, nullptr);
+		benchmark::DoNotOptimize(out);
+	}
+}
+BENCHMARK(BM_Matrix4InvertAligned);
+
+static void BM_Matrix43Multiply(benchmark::State& state) {
+	auto m1 = Matrix43MakeWithMatrix4(Matrix4MakeXRotation(0.5f));
+	auto m2 = Matrix43MakeTranslation(1, 2, 3);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m1);
+		auto out = Matrix43Multiply(m1, m2);
+		benchmark::DoNotOptimize(out);
+	}
+}
+BENCHMARK(BM_Matrix43Multiply);
+
+static void BM_Matrix43Invert(benchmark::State& state) {
+	auto m = Matrix43MakeWithMatrix4(Matrix4Multiply(Matrix4MakeXRotation(0.5f), Matrix4MakeTranslation(1, 2, 3)));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(m);
+		auto out = Matrix43Invert(m, nullptr);
+		benchmark::DoNotOptimize(out);
+	}
+}
+BENCHMARK(BM_Matrix43Invert);
+
+// World transforms of a hierarchy where every object has four children, parents precede children
+template <typename Matrix>
+static void ComposeHierarchy(benchmark::State& state, const Matrix& local) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Matrix> locals(size, local), worlds(size);
+	for (auto _ : state) {
+		worlds[0] = locals[0];
+		for (size_t i = 1; i < size; ++i) {
+			worlds[i] = locals[i] * worlds[(i - 1) / 4];
+		}
+		benchmark::DoNotOptimize(worlds.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range());
+}
+
+static void BM_Matrix4ComposeHierarchy(benchmark::State& state) {
+	ComposeHierarchy(state, Matrix4MakeWithTransform(Transform {1, 1, 1, 0.1f, 0.2f, 0.3f, 1, 2, 3}));
+}
+BENCHMARK(BM_Matrix4ComposeHierarchy)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Matrix43ComposeHierarchy(benchmark::State& state) {
+	ComposeHierarchy(state, Matrix43MakeWithMatrix4(Matrix4MakeWithTransform(Transform {1, 1, 1, 0.1f, 0.2f, 0.3f, 1, 2, 3})));
+}
+BENCHMARK(BM_Matrix43ComposeHierarchy)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Vector3Transform(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Vector3> points(size, Vector3Make(1, 2, 3)), out(size);
+	auto m = Matrix4Multiply(Matrix4MakeXRotation(0.5f), Matrix4MakeTranslation(1, 2, 3));
+	for (auto _ : state) {
+		for (size_t i = 0; i < size; ++i) {
+			out[i] = Vector3Transform(points[i], m);
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Vector3Transform)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_Vector3TransformArray(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<Vector3> points(size, Vector3Make(1, 2, 3)), out(size);
+	auto m = Matrix4Multiply(Matrix4MakeXRotation(0.5f), Matrix4MakeTranslation(1, 2, 3));
+	for (auto _ : state) {
+		Vector3TransformArray(points.data(), m, out.data(), size);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Vector3TransformArray)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+// Spheres are spread around the camera, most of them are culled. Stored in order along x axis
+// like spatially sorted scenes, so neighbours tend to be culled by the same plane
+struct CullingSpheres {
+	std::vector<float> x, y, z, radius;
+	
+	explicit CullingSpheres(size_t size) : x(size), y(size), z(size), radius(size) {
+		Random random;
+		for (size_t i = 0; i < size; ++i) {
+			x[i] = random.NextFloat(-100.0f, 100.0f);
+			y[i] = random.NextFloat(-100.0f, 100.0f);
+			z[i] = random.NextFloat(-100.0f, 100.0f);
+			radius[i] = random.NextFloat(0.1f, 5.0f);
+		}
+		std::sort(x.begin(), x.end());
+	}
+};
+
+static Frustum BenchmarkFrustum() {
+	auto frustum = FrustumMakeWithMatrix(Matrix4MakePerspectiveFieldOfView(1.0f, 1.5f, 1.0f, 100.0f));
+	FrustumNormalize(frustum);
+	return frustum;
+}
+
+static void BM_FrustumCullSphere(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	CullingSpheres spheres{size};
+	std::vector<uint32_t> indices(size);
+	auto frustum = BenchmarkFrustum();
+	for (auto _ : state) {
+		size_t count = 0;
+		for (size_t i = 0; i < size; ++i) {
+			if (!FrustumCullSphere(frustum, SphereMake(Vector3Make(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]))) {
+				indices[count++] = static_cast<uint32_t>(i);
+			}
+		}
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_FrustumCullSphere)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_FrustumCullSpheresToIndices(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	CullingSpheres spheres{size};
+	std::vector<uint32_t> indices(size);
+	std::vector<uint8_t> planeCache(static_cast<size_t>(state.range(1)) ? size : 0);
+	auto frustum = BenchmarkFrustum();
+	for (auto _ : state) {
+		auto count = FrustumCullSpheresToIndices(frustum, {spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data()},
+			size, indices.data(), planeCache.empty() ? nullptr : planeCache.data());
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_FrustumCullSpheresToIndices)->ArgsProduct({benchmark::CreateRange(1 << 10, 1 << 20, 8), {0, 1}});
+
+// Objects of 32x32 spread uniformly over a square, density is kept constant as the count grows
+static std::vector<Rect> RandomRects(size_t count) {
+	auto side = std::sqrt(static_cast<float>(count)) * 64.0f;
+	Random random;
+	std::vector<Rect> rects(count);
+	for (auto& r : rects) {
+		r = RectMakeWithOriginAndSize(random.NextFloat(0, side), random.NextFloat(0, side), 32, 32);
+	}
+	return rects;
+}
+
+static void BM_LinearQueryRect(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto rects = RandomRects(size);
+	auto view = RectMakeWithOriginAndSize(0, 0, 512, 512);
+	for (auto _ : state) {
+		size_t hits = 0;
+		for (auto& r : rects) {
+			hits += RectIntersect(r, view);
+		}
+		benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LinearQueryRect)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_SpatialGrid2DQueryRect(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	SpatialGrid2D grid;
+	for (auto& r : RandomRects(size)) {
+		grid.Insert(SceneObject{}, r);
+	}
+	auto view = RectMakeWithOriginAndSize(0, 0, 512, 512);
+	for (auto _ : state) {
+		size_t hits = 0;
+		grid.QueryRect(view, [&hits](SceneObject, bool&) { ++hits; });
+		benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpatialGrid2DQueryRect)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_SpatialGrid2DUpdate(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto rects = RandomRects(size);
+	SpatialGrid2D grid;
+	for (auto& r : rects) {
+		grid.Insert(SceneObject{}, r);
+	}
+	// Every object moves by a few pixels per frame, a part of them crosses cell borders
+	float offset = 0;
+	for (auto _ : state) {
+		offset = offset > 64 ? 0 : offset + 3;
+		for (size_t i = 0; i < size; ++i) {
+			auto& r = rects[i];
+			grid.Update(static_cast<SpatialGrid2D::ProxyId>(i), RectMake(r.min + Vector2Make(offset, 0), r.max + Vector2Make(offset, 0)));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_SpatialGrid2DUpdate)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+// Boxes spread over a cube, density is kept constant as the count grows
+static std::vector<AABB> RandomBoxes(size_t count) {
+	auto side = std::cbrt(static_cast<float>(count)) * 8.0f;
+	Random random;
+	std::vector<AABB> boxes(count);
+	for (auto& b : boxes) {
+		auto center = Vector3Make(random.NextFloat(-side, side), random.NextFloat(-side, side), random.NextFloat(-side, side));
+		b = AABBMakeWithCenterAndExtents(center, Vector3Make(random.NextFloat(0.5f, 2), random.NextFloat(0.5f, 2), random.NextFloat(0.5f, 2)));
+	}
+	return boxes;
+}
+
+// Narrow frustum looking along z from the origin, sees a fixed volume regardless of the box count
+static Frustum NarrowFrustum() {
+	auto frustum = FrustumMakeWithMatrix(Matrix4MakePerspectiveFieldOfView(0.5f, 1.5f, 1.0f, 50.0f));
+	FrustumNormalize(frustum);
+	return frustum;
+}
+
+static void BM_FrustumCullAABB(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto boxes = RandomBoxes(size);
+	auto frustum = NarrowFrustum();
+	for (auto _ : state) {
+		size_t visible = 0;
+		for (auto& b : boxes) {
+			visible += !FrustumCullAABB(frustum, b);
+		}
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrustumCullAABB)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static void BM_BoundingVolumeHierarchyQueryFrustum(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	BoundingVolumeHierarchy bvh;
+	for (auto& b : RandomBoxes(size)) {
+		bvh.Insert(SceneObject{}, b);
+	}
+	bvh.Rebuild();
+	auto frustum = NarrowFrustum();
+	for (auto _ : state) {
+		size_t visible = 0;
+		bvh.QueryFrustum(frustum, [&visible](SceneObject, bool&) { ++visible; });
+		benchmark::DoNotOptimize(visible);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BoundingVolumeHierarchyQueryFrustum)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+// One percent of boxes move per frame
+static void BM_BoundingVolumeHierarchyRefit(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto boxes = RandomBoxes(size);
+	BoundingVolumeHierarchy bvh;
+	for (auto& b : boxes) {
+		bvh.Insert(SceneObject{}, b);
+	}
+	bvh.Rebuild();
+	size_t first = 0;
+	for (auto _ : state) {
+		for (size_t i = first; i < size; i += 100) {
+			auto& b = boxes[i];
+			b = AABBMake(b.min + Vector3Make(0.1f, 0, 0), b.max + Vector3Make(0.1f, 0, 0));
+			bvh.Move(static_cast<BoundingVolumeHierarchy::ProxyId>(i), b);
+		}
+		bvh.Refit();
+		first = (first + 1) % 100;
+	}
+	state.SetItemsProcessed(state.iterations() * state.range() / 100);
+}
+BENCHMARK(BM_BoundingVolumeHierarchyRefit)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+static std::vector<Transform2DComponent*> AddTransforms2D(Scene& scene, size_t count) {
+	std::vector<Transform2DComponent*> transforms;
+	for (size_t i = 0; i < count; ++i) {
+		transforms.push_back(scene.AddObject().AddComponent<Transform2DComponent>());
+	}
+	return transforms;
+}
+
+static void BM_Animator2DUpdate(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range(0));
+	auto scene = std::make_unique<Scene>();
+	auto transforms = AddTransforms2D(*scene, size);
+	
+	const Animator2D::Keyframe position[] = {{0, 0, Easing::QuadInOut}, {0.5f, 100, Easing::Linear}, {1, 0, Easing::Linear}};
+	const Animator2D::Keyframe rotation[] = {{0, 0, Easing::Linear}, {1, 6.28f, Easing::Linear}};
+	const Animator2D::Track tracks[] = {
+		{Transform2DChannel::TranslationX, position, 3},
+		{Transform2DChannel::TranslationY, position, 3},
+		{Transform2DChannel::Rotation, rotation, 2}
+	};
+	
+	Animator2D animator;
+	auto clip = animator.CreateClip(tracks, 3);
+	for (size_t i = 0; i < size; ++i) {
+		animator.Play(clip, transforms[i], true, 1 + static_cast<float>(i % 16) / 16);
+	}
+	
+	ThreadPool pool;
+	for (auto _ : state) {
+		animator.Update(1.0f / 60, state.range(1) ? &pool : nullptr);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Animator2DUpdate)->ArgsProduct({{1 << 10, 1 << 14, 1 << 17}, {0, 1}});
+
+// Recomputing every world transform with Apply message, the path before dirty tracking
+static void BM_Transform2DBroadcastApply(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto scene = std::make_unique<Scene>();
+	AddTransforms2D(*scene, size);
+	
+	ComponentMessageParams params;
+	for (auto _ : state) {
+		scene->GetRootObject().BroadcastMessage(ComponentMessages::Apply, params);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Transform2DBroadcastApply)->RangeMultiplier(8)->Range(1 << 10, 1 << 17);
+
+// Every tenth transform changes per frame
+static void BM_Transform2DUpdateHierarchy(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto scene = std::make_unique<Scene>();
+	auto transforms = AddTransforms2D(*scene, size);
+	
+	for (auto _ : state) {
+		for (size_t i = 0; i < size; i += 10) {
+			transforms[i]->localTransform.tx += 1;
+			transforms[i]->MarkDirty();
+		}
+		Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_Transform2DUpdateHierarchy)->RangeMultiplier(8)->Range(1 << 10, 1 << 17);
+
+// Groups of a hundred sprites under a transformed parent, texture changes every 1000 sprites. Returns transforms of
+// the groups
+static std::vector<Transform2DComponent*> AddSprites(Scene& scene, size_t count) {
+	static int textures[4];
+	
+	std::vector<Transform2DComponent*> groups;
+	SceneObject group;
+	for (size_t i = 0; i < count; ++i) {
+		if (i % 100 == 0) {
+			group = scene.AddObject();
+			groups.push_back(group.AddComponent<Transform2DComponent>());
+			groups.back()->localTransform.rad = 0.1f;
+		}
+		auto object = group.AppendChild();
+		object.AddComponent<Transform2DComponent>()->localTransform.tx = static_cast<float>(i % 100);
+		object.AddComponent<SpriteComponent>()->texture = &textures[i / 1000 % 4];
+	}
+	Transform2DComponent::UpdateHierarchy(scene.GetRootObject());
+	return groups;
+}
+
+///
+/// Uploads through the null device into a storage buffer, commands are not recorded
+///
+struct NullUploadTarget {
+	NullGpuDevice device;
+	GpuUploadDevice uploadDevice{device};
+	UploadManager uploads{uploadDevice};
+	Buffer buffer{&device};
+	
+	explicit NullUploadTarget(size_t size) {
+		device.SetRecording(false);
+		buffer.Create(BufferUsage::GraphicsStorageRead, static_cast<uint32_t>(size));
+	}
+	
+	void EndFrame() { uploads.EndFrame(device.AcquireCommandBuffer()); }
+};
+
+static void BM_SpriteBatcherBuild(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto scene = std::make_unique<Scene>();
+	AddSprites(*scene, size);
+	
+	SpriteBatcher batcher;
+	for (auto _ : state) {
+		batcher.Clear();
+		batcher.Build(scene->GetRootObject());
+		benchmark::DoNotOptimize(batcher.GetInstances().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_SpriteBatcherBuild)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Same scene where one group in a hundred moves per frame and only its sprites are uploaded
+static void BM_SpriteInstanceBufferUpdate(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto scene = std::make_unique<Scene>();
+	auto groups = AddSprites(*scene, size);
+	NullUploadTarget target(size * sizeof(SpriteInstance));
+	
+	SpriteInstanceBuffer buffer;
+	buffer.Update(scene->GetRootObject());
+	target.uploads.BeginFrame();
+	buffer.Upload(target.uploads, target.buffer.Handle());
+	target.EndFrame();
+	
+	size_t frame = 0;
+	size_t uploaded = 0;
+	for (auto _ : state) {
+		for (size_t i = frame++ % 100; i < groups.size(); i += 100) {
+			groups[i]->localTransform.tx += 1;
+			groups[i]->MarkDirty();
+		}
+		Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+		buffer.Update(scene->GetRootObject());
+		for (auto& range : buffer.GetDirtyRanges()) {
+			uploaded += range.count * sizeof(SpriteInstance);
+		}
+		target.uploads.BeginFrame();
+		buffer.Upload(target.uploads, target.buffer.Handle());
+		target.EndFrame();
+	}
+	target.uploads.WaitIdle();
+	state.SetItemsProcessed(state.iterations() * state.range());
+	state.counters["uploaded"] = benchmark::Counter(static_cast<double>(uploaded), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SpriteInstanceBufferUpdate)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Instances written straight into upload memory, with and without the thread pool
+static void BM_SpriteBatcherUpload(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range(0));
+	auto scene = std::make_unique<Scene>();
+	AddSprites(*scene, size);
+	NullUploadTarget target(size * sizeof(SpriteInstance));
+	ThreadPool pool;
+	
+	SpriteBatcher batcher;
+	for (auto _ : state) {
+		batcher.Clear();
+		batcher.Gather(scene->GetRootObject());
+		target.uploads.BeginFrame();
+		batcher.Upload(target.uploads, target.buffer.Handle(), 0, state.range(1) ? &pool : nullptr);
+		target.EndFrame();
+	}
+	target.uploads.WaitIdle();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpriteBatcherUpload)->ArgsProduct({{10000, 100000}, {0, 1}});
+
+// Opaque items with 64 pipelines, 1024 textures and 4 samplers in random order, as after culling
+static std::vector<RenderSortKey> RandomRenderKeys(size_t count) {
+	Random random;
+	std::vector<RenderSortKey> keys(count);
+	for (auto& key : keys) {
+		key = RenderKeyMakeOpaque(0, random.NextUint(0, 63), random.NextUint(0, 1023), random.NextUint(0, 3), random.Next() >> 8 & kRenderKeyMaxDepth);
+	}
+	return keys;
+}
+
+static void BM_RenderQueueSort(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto keys = RandomRenderKeys(size);
+	
+	RenderQueue queue;
+	int objects[1024];
+	for (auto& object : objects) {
+		queue.RegisterTexture(&object);
+	}
+	
+	for (auto _ : state) {
+		queue.Clear();
+		for (size_t i = 0; i < size; ++i) {
+			queue.Add(keys[i], static_cast<uint32_t>(i), 1);
+		}
+		queue.Sort();
+		benchmark::DoNotOptimize(queue.GetDraws().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_RenderQueueSort)->Arg(100000)->Arg(300000)->Arg(1000000);
+
+// Comparison sort of the same items for reference
+static void BM_RenderKeysStdSort(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	auto keys = RandomRenderKeys(size);
+	std::vector<uint32_t> items(size);
+	
+	for (auto _ : state) {
+		std::iota(items.begin(), items.end(), 0u);
+		std::sort(items.begin(), items.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+		benchmark::DoNotOptimize(items.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+}
+BENCHMARK(BM_RenderKeysStdSort)->Arg(100000)->Arg(300000)->Arg(1000000);
+
+// Sprites of an atlas with 64 rectangles, neighbours often share one
+static void BM_SpriteInstancePack(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	std::vector<SpriteInstance> instances(size);
+	for (size_t i = 0; i < size; ++i) {
+		instances[i] = SpriteInstance {
+			.transform = Matrix32Multiply(Matrix32MakeScale(32, 32), Matrix32MakeRotation(static_cast<float>(i) * 0.01f)),
+			.pivotX = 0.5f,
+			.pivotY = 0.5f,
+			.color = FloatColorMakeWhite(),
+			.texU = static_cast<float>(i / 16 % 64) / 64,
+			.texV = 0,
+			.texW = 1.0f / 64,
+			.texH = 1
+		};
+	}
+	
+	std::vector<PackedSpriteInstance> packed(size);
+	SpriteRectTable rects;
+	for (auto _ : state) {
+		SpriteInstancePack(instances.data(), packed.data(), size, rects);
+		benchmark::DoNotOptimize(packed.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+	state.SetBytesProcessed(state.iterations() * state.range() * static_cast<int64_t>(sizeof(SpriteInstance)));
+}
+BENCHMARK(BM_SpriteInstancePack)->Arg(10000)->Arg(100000);
+
+// Random sizes from 8 to 64 texels until the page of 2048 is full
+static void BM_SkylinePackerFill(benchmark::State& state) {
+	Random random;
+	
+	SkylinePacker packer;
+	size_t count = 0;
+	for (auto _ : state) {
+		packer.Reset(2048, 2048);
+		AtlasRect rect;
+		while (packer.Insert(random.NextUint(8, 64), random.NextUint(8, 64), &rect)) {
+			++count;
+		}
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(count));
+	state.counters["occupancy"] = packer.GetOccupancy();
+}
+BENCHMARK(BM_SkylinePackerFill);
+
+// Atlas with thousands of images where a tenth is replaced by images of other sizes per iteration
+static void BM_TextureAtlasChurn(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	Random random;
+	
+	std::vector<Color> pixels(64 * 64, ColorMakeWhite());
+	TextureAtlas atlas;
+	std::vector<TextureAtlas::RegionId> regions;
+	for (size_t i = 0; i < size; ++i) {
+		regions.push_back(atlas.Insert(pixels.data(), random.NextUint(8, 64), random.NextUint(8, 64)));
+	}
+	
+	for (auto _ : state) {
+		for (size_t i = 0; i < size / 10; ++i) {
+			auto& region = regions[random.NextUint(0, static_cast<uint32_t>(size) - 1)];
+			atlas.Remove(region);
+			region = atlas.Insert(pixels.data(), random.NextUint(8, 64), random.NextUint(8, 64));
+		}
+		atlas.ClearDirtyRects();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range() / 10);
+	state.counters["pages"] = static_cast<double>(atlas.GetPageCount());
+}
+BENCHMARK(BM_TextureAtlasChurn)->Arg(1000)->Arg(4000);
+
+// Mip chain of a translucent 1024x1024 image, premultiplied, in each packed format
+static void BM_MipChainBuild(benchmark::State& state) {
+	const uint32_t size = 1024;
+	const auto format = static_cast<PixelFormat>(state.range());
+	Random random;
+	std::vector<Color> pixels(size_t{size} * size);
+	for (auto& pixel : pixels) {
+		pixel.value = random.Next();
+	}
+	
+	MipChain chain;
+	for (auto _ : state) {
+		chain.Build(pixels.data(), size, size, {.mipmaps = true, .premultiplyAlpha = true, .format = format});
+		benchmark::DoNotOptimize(chain.GetData());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chain.GetSize()));
+}
+BENCHMARK(BM_MipChainBuild)->DenseRange(0, 2);
+
+// Pipelines of materials looked up by state, eight distinct states shared by all materials
+static void BM_PipelineCacheGetPipeline(benchmark::State& state) {
+	const auto size = static_cast<size_t>(state.range());
+	
+	NullGpuDevice device;
+	device.SetRecording(false);
+	PipelineCache cache(device);
+	const char code[] = "code";
+	auto vertexShader = cache.AddShader("Sprite.vert", R"({ "storage_buffers": 1, "uniform_buffers": 1, "inputs": [] })", code, sizeof(code));
+	auto fragmentShader = cache.AddShader("Sprite.frag", R"({ "samplers": 1, "inputs": [] })", code, sizeof(code));
+	
+	std::vector<PipelineState> materials(size);
+	for (size_t i = 0; i < size; ++i) {
+		materials[i].vertexShader = vertexShader;
+		materials[i].fragmentShader = fragmentShader;
+		materials[i].blendMode = static_cast<BlendMode>(i % 4);
+		materials[i].primitiveType = i / 4 % 2 ? PrimitiveType::TriangleStrip : PrimitiveType::TriangleList;
+	}
+	
+	for (auto _ : state) {
+		for (auto& material : materials) {
+			benchmark::DoNotOptimize(cache.GetPipeline(material));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range());
+	state.counters["pipelines"] = static_cast<double>(cache.GetPipelineCount());
+}
+BENCHMARK(BM_PipelineCacheGetPipeline)->Arg(1000);
+
 BENCHMARK_MAIN();
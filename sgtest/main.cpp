@@ -5,8 +5,50 @@
 #include <scenegraph/memory/PoolAllocator.h>
 #include <scenegraph/memory/MonotonicAllocator.h>
 #include <scenegraph/utils/ScopeGuard.h>
+#include <scenegraph/utils/FloatUtils.h>
+#include <scenegraph/utils/Random.h>
+#include <scenegraph/threading/Task.h>
+#include <scenegraph/threading/ThreadPool.h>
+#include <scenegraph/profiling/Trace.h>
+#include <scenegraph/math/Matrix32.h>
+#include <scenegraph/math/Trigonometry.h>
+#include <scenegraph/math/Matrix4.h>
+#include <scenegraph/math/Matrix43.h>
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/math/Frustum.h>
+#include <scenegraph/math/Sphere.h>
+#include <scenegraph/math/AABB.h>
+#include <scenegraph/math/Rect.h>
+#include <scenegraph/math/Quaternion.h>
+#include <scenegraph/math/Transform.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/components/Bounds2DComponent.h>
+#include <scenegraph/components/BoundsComponent.h>
+#include <scenegraph/components/TransformComponent.h>
+#include <scenegraph/components/SpriteComponent.h>
+#include <scenegraph/render/SpriteBatcher.h>
+#include <scenegraph/render/UploadManager.h>
+#include <scenegraph/render/RenderQueue.h>
+#include <scenegraph/render/PackedSpriteInstance.h>
+#include <scenegraph/render/SpriteInstanceBuffer.h>
+#include <scenegraph/render/TextureAtlas.h>
+#include <scenegraph/imaging/MipChain.h>
+#include <scenegraph/gpu/NullGpuDevice.h>
+#include <scenegraph/gpu/PipelineCache.h>
+#include <scenegraph/spatial/SpatialGrid2D.h>
+#include <scenegraph/spatial/BoundingVolumeHierarchy.h>
+#include <scenegraph/animation/Animator2D.h>
+#include <scenegraph/animation/Easing.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <numeric>
 #include <string>
+#include <vector>
+#include <thread>
 
 class Node : public ForwardListNode<Node> {
 public:
@@ -560,3 +602,2016 @@ TEST(ScopeGuard, Exit) {
 	EXPECT_EQ(out, "31");
 #endif
 }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static Task<int> Add(int a, int b) {
+	co_return a + b;
+}
+
+static Task<int> AddTwice(int a, int b) {
+	int c = co_await Add(a, b);
+	co_return co_await Add(c, c);
+}
+
+static Task<std::thread::id> SwitchThreads(WorkThread& thread, std::thread::id* workThreadId) {
+	co_await SwitchToWorkThread(thread);
+	*workThreadId = std::this_thread::get_id();
+	co_await SwitchToMainThread();
+	co_return std::this_thread::get_id();
+}
+
+static Task<> FinishOnWorkThread(WorkThread& thread, std::thread::id* workThreadId) {
+	co_await SwitchToWorkThread(thread);
+	*workThreadId = std::this_thread::get_id();
+}
+
+static Task<std::thread::id> AwaitWorkThreadTask(WorkThread& thread, std::thread::id* workThreadId) {
+	co_await FinishOnWorkThread(thread, workThreadId);
+	co_return std::this_thread::get_id();
+}
+
+static Task<std::thread::id> GetThreadId() {
+	co_return std::this_thread::get_id();
+}
+
+static Task<std::thread::id> GetMainThreadId() {
+	co_await SwitchToMainThread();
+	co_return std::this_thread::get_id();
+}
+
+static Task<std::thread::id> AwaitOnWorkThread(WorkThread& thread, std::thread::id* workThreadId, std::thread::id* mainThreadId) {
+	co_await SwitchToWorkThread(thread);
+	*mainThreadId = co_await GetMainThreadId();
+	co_await SwitchToWorkThread(thread);
+	*workThreadId = co_await GetThreadId();
+	co_return std::this_thread::get_id();
+}
+
+template <typename T>
+static void RunUntilDone(Task<T>& task, WorkThread& thread) {
+	task.Start();
+	while (!task.Done()) {
+		thread.WaitOne();
+		while (thread.TryPop()) {
+		}
+	}
+}
+
+TEST(Task, Await) {
+	auto task = AddTwice(1, 2);
+	EXPECT_FALSE(task.Done());
+	task.Start();
+	ASSERT_TRUE(task.Done());
+	EXPECT_EQ(task.Result(), 6);
+}
+
+TEST(Task, SwitchThreads) {
+	WorkThread thread;
+	std::thread::id workThreadId;
+	
+	auto task = SwitchThreads(thread, &workThreadId);
+	RunUntilDone(task, thread);
+	
+	EXPECT_NE(workThreadId, std::thread::id{});
+	EXPECT_NE(workThreadId, std::this_thread::get_id());
+	EXPECT_EQ(task.Result(), std::this_thread::get_id());
+}
+
+TEST(Task, FinishOnMainThread) {
+	WorkThread thread;
+	std::thread::id workThreadId;
+	
+	auto task = AwaitWorkThreadTask(thread, &workThreadId);
+	RunUntilDone(task, thread);
+	
+	EXPECT_NE(workThreadId, std::this_thread::get_id());
+	EXPECT_EQ(task.Result(), std::this_thread::get_id());
+}
+
+TEST(Task, AwaitOnWorkThread) {
+	WorkThread thread;
+	std::thread::id workThreadId;
+	std::thread::id mainThreadId;
+	
+	// Tasks awaited on the work thread start there and complete on the main thread
+	auto task = AwaitOnWorkThread(thread, &workThreadId, &mainThreadId);
+	RunUntilDone(task, thread);
+	
+	EXPECT_EQ(mainThreadId, std::this_thread::get_id());
+	EXPECT_NE(workThreadId, std::thread::id{});
+	EXPECT_NE(workThreadId, std::this_thread::get_id());
+	EXPECT_EQ(task.Result(), std::this_thread::get_id());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+TEST(WorkThread, Stats) {
+	WorkThread thread({.name = "sgtest", .priority = WorkThreadPriority::Low});
+	
+	int counter = 0;
+	PipeTask tasks[3];
+	for (auto& task : tasks) {
+		task.callbackIn = [](void* param) { ++*static_cast<int*>(param); };
+		task.param = &counter;
+		thread.Push(&task);
+	}
+	
+	for (int popped = 0; popped < 3;) {
+		thread.WaitOne();
+		while (thread.TryPop()) {
+			++popped;
+		}
+	}
+	
+	auto stats = thread.GetStats();
+	EXPECT_EQ(counter, 3);
+	EXPECT_EQ(stats.tasksExecuted, 3u);
+}
+
+TEST(WorkThread, PushBatch) {
+	WorkThread thread;
+	PipeTaskArena arena;
+	
+	std::vector<int> order;
+	order.reserve(1000);
+	
+	PipeTaskBatch batch;
+	for (int i = 0; i < 1000; ++i) {
+		batch.Add(arena.New(nullptr, [](void* param) { ++*static_cast<int*>(param); }, &order.emplace_back(i)));
+	}
+	EXPECT_EQ(batch.Size(), 1000u);
+	EXPECT_EQ(arena.Size(), 1000u);
+	
+	thread.Push(batch);
+	EXPECT_TRUE(batch.Empty());
+	
+	// Tasks complete in the order they were added
+	int expected = 0;
+	while (expected < 1000) {
+		thread.WaitOne();
+		while (auto task = thread.TryPop()) {
+			EXPECT_EQ(static_cast<int*>(task->param) - order.data(), expected++);
+		}
+	}
+	EXPECT_EQ(order.back(), 1000);
+	
+	arena.Reset();
+	EXPECT_EQ(arena.Size(), 0u);
+}
+
+TEST(ThreadPool, ParallelFor) {
+	ThreadPool pool(3);
+	
+	std::vector<int> counts(1000);
+	pool.ParallelFor(0, counts.size(), 7, [&](size_t begin, size_t end) {
+		EXPECT_LE(end - begin, 7u);
+		for (auto i = begin; i < end; ++i) {
+			++counts[i];
+		}
+	});
+	
+	for (auto count : counts) {
+		EXPECT_EQ(count, 1);
+	}
+}
+
+TEST(ThreadPool, ParallelForNested) {
+	ThreadPool pool(2);
+	
+	std::vector<int> counts(64 * 64);
+	pool.ParallelFor(0, 64, 1, [&](size_t row, size_t) {
+		pool.ParallelFor(0, 64, 8, [&](size_t begin, size_t end) {
+			for (auto i = begin; i < end; ++i) {
+				++counts[row * 64 + i];
+			}
+		});
+	});
+	
+	for (auto count : counts) {
+		EXPECT_EQ(count, 1);
+	}
+}
+
+TEST(ThreadPool, ParallelReduce) {
+	ThreadPool pool(3);
+	
+	auto sum = pool.ParallelReduce(size_t{1}, size_t{100001}, 100, size_t{0},
+		[](size_t begin, size_t end) {
+			size_t value = 0;
+			for (auto i = begin; i < end; ++i) {
+				value += i;
+			}
+			return value;
+		},
+		[](size_t a, size_t b) { return a + b; });
+	EXPECT_EQ(sum, size_t{100000} * 100001 / 2);
+	
+	// Chunk results are combined in order
+	auto digits = pool.ParallelReduce(size_t{0}, size_t{10}, 1, std::string{},
+		[](size_t begin, size_t) { return std::to_string(begin); },
+		[](std::string a, const std::string& b) { return a + b; });
+	EXPECT_EQ(digits, "0123456789");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static std::string WriteTrace() {
+	std::string json;
+	if (auto file = tmpfile()) {
+		EXPECT_TRUE(TraceWriteChromeJson(file));
+		json.resize(static_cast<size_t>(ftell(file)));
+		rewind(file);
+		EXPECT_EQ(fread(json.data(), 1, json.size(), file), json.size());
+		fclose(file);
+	}
+	return json;
+}
+
+TEST(Trace, WriteChromeJson) {
+	TraceClear();
+	
+	WorkThread thread;
+	PipeTask task{
+		.callbackIn = [](void*) {
+			TraceSetThreadName("sgtest worker");
+			TraceZone zone{"worker zone"};
+		}
+	};
+	thread.Push(&task);
+	
+	{
+		TraceZone zone{"main \"zone\""};
+		while (!thread.TryPop()) {
+			thread.WaitOne();
+		}
+	}
+	
+	auto json = WriteTrace();
+	EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+	EXPECT_NE(json.find("\"name\":\"worker zone\",\"ph\":\"X\""), std::string::npos);
+	EXPECT_NE(json.find("\"name\":\"main \\\"zone\\\"\""), std::string::npos);
+	EXPECT_NE(json.find("\"args\":{\"name\":\"sgtest worker\"}"), std::string::npos);
+	
+	// Written zones are consumed
+	json = WriteTrace();
+	EXPECT_EQ(json.find("zone"), std::string::npos);
+}
+
+TEST(Trace, ReuseThreadBuffers) {
+	auto record = [] {
+		std::thread([] {
+			TraceSetThreadName("sgtest thread");
+			TraceZone zone{"thread zone"};
+		}).join();
+	};
+	
+	// Zones of an exited thread are kept until they are written
+	WriteTrace();
+	record();
+	auto count = TraceGetThreadBufferCount();
+	auto json = WriteTrace();
+	EXPECT_NE(json.find("\"name\":\"thread zone\""), std::string::npos);
+	
+	// Then its buffer goes to the next thread
+	for (int i = 0; i < 8; ++i) {
+		record();
+		EXPECT_NE(WriteTrace().find("\"args\":{\"name\":\"sgtest thread\"}"), std::string::npos);
+	}
+	EXPECT_EQ(TraceGetThreadBufferCount(), count);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static std::vector<Transform2D> RandomTransforms2D(size_t count) {
+	std::vector<Transform2D> transforms(count);
+	Random random;
+	for (auto& transform : transforms) {
+		transform = {
+			.sx = random.NextFloat(0.1f, 4.0f),
+			.sy = random.NextFloat(0.1f, 4.0f),
+			.shearX = 0,
+			.shearY = 0,
+			.rad = random.NextFloat(-10.0f, 10.0f),
+			.tx = random.NextFloat(-1000.0f, 1000.0f),
+			.ty = random.NextFloat(-1000.0f, 1000.0f)
+		};
+	}
+	return transforms;
+}
+
+static void ExpectNearMatrix32(const Matrix32& m1, const Matrix32& m2, float absError) {
+	EXPECT_NEAR(m1.a, m2.a, absError);
+	EXPECT_NEAR(m1.b, m2.b, absError);
+	EXPECT_NEAR(m1.c, m2.c, absError);
+	EXPECT_NEAR(m1.d, m2.d, absError);
+	EXPECT_NEAR(m1.tx, m2.tx, absError * 1000);
+	EXPECT_NEAR(m1.ty, m2.ty, absError * 1000);
+}
+
+TEST(Matrix32, MultiplyBatch) {
+	// Odd count to cover the tail of vector kernels
+	constexpr size_t kCount = 1003;
+	auto transforms = RandomTransforms2D(kCount * 2);
+	
+	std::vector<Matrix32> m1(kCount), m2(kCount), out(kCount);
+	Matrix32MakeWithTransform2DBatch(transforms.data(), m1.data(), kCount);
+	Matrix32MakeWithTransform2DBatch(transforms.data() + kCount, m2.data(), kCount);
+	
+	Matrix32MultiplyBatch(m1.data(), m2.data(), out.data(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		ExpectNearMatrix32(out[i], Matrix32Multiply(m1[i], m2[i]), 1e-4f);
+	}
+	
+	// In place
+	Matrix32MultiplyBatch(m1.data(), m2.data(), m1.data(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		ExpectNearMatrix32(m1[i], out[i], 0);
+	}
+}
+
+TEST(Matrix32, MakeWithTransform2DBatch) {
+	constexpr size_t kCount = 1003;
+	auto transforms = RandomTransforms2D(kCount);
+	transforms[5].shearX = 0.5f;
+	transforms[6].shearY = 0.25f;
+	
+	std::vector<Matrix32> out(kCount);
+	Matrix32MakeWithTransform2DBatch(transforms.data(), out.data(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		ExpectNearMatrix32(out[i], Matrix32MakeWithTransform2D(transforms[i]), 1e-5f);
+	}
+	
+	std::vector<float> sx, sy, shearX, shearY, rad, tx, ty;
+	for (auto& transform : transforms) {
+		sx.push_back(transform.sx);
+		sy.push_back(transform.sy);
+		shearX.push_back(transform.shearX);
+		shearY.push_back(transform.shearY);
+		rad.push_back(transform.rad);
+		tx.push_back(transform.tx);
+		ty.push_back(transform.ty);
+	}
+	
+	Transform2DBatch batch{sx.data(), sy.data(), shearX.data(), shearY.data(), rad.data(), tx.data(), ty.data()};
+	Matrix32MakeWithTransform2DBatch(batch, out.data(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		ExpectNearMatrix32(out[i], Matrix32MakeWithTransform2D(transforms[i]), 1e-5f);
+	}
+}
+
+TEST(Trigonometry, SinCosBatch) {
+	constexpr size_t kCount = (1 << 16) + 3;
+	constexpr float kRange = 8192.0f;
+	
+	std::vector<float> rad(kCount), sin(kCount), cos(kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		rad[i] = -kRange + 2 * kRange * static_cast<float>(i) / static_cast<float>(kCount - 1);
+	}
+	SinCosBatch(rad.data(), sin.data(), cos.data(), kCount);
+	
+	double maxError = 0;
+	for (size_t i = 0; i < kCount; ++i) {
+		maxError = std::max(maxError, std::abs(sin[i] - std::sin(static_cast<double>(rad[i]))));
+		maxError = std::max(maxError, std::abs(cos[i] - std::cos(static_cast<double>(rad[i]))));
+	}
+	EXPECT_LE(maxError, 8e-8);
+	
+	// Exact at zero
+	float s, c;
+	float zero = 0;
+	SinCosBatch(&zero, &s, &c, 1);
+	EXPECT_EQ(s, 0.0f);
+	EXPECT_EQ(c, 1.0f);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static Matrix4 TestMatrix4(float rad, float tx, float ty, float tz) {
+	return Matrix4Multiply(
+		Matrix4Multiply(Matrix4MakeScale(2, 3, 4), Matrix4MakeYRotation(rad)),
+		Matrix4Multiply(Matrix4MakeXRotation(rad * 0.5f), Matrix4MakeTranslation(tx, ty, tz)));
+}
+
+static void ExpectNearMatrix4(const Matrix4& m1, const Matrix4& m2, float absError) {
+	auto p1 = &m1.m11;
+	auto p2 = &m2.m11;
+	for (int i = 0; i < 16; ++i) {
+		EXPECT_NEAR(p1[i], p2[i], absError) << "element " << i;
+	}
+}
+
+TEST(Matrix4, MultiplyAligned) {
+	auto m1 = TestMatrix4(0.5f, 1, 2, 3);
+	auto m2 = Matrix4Multiply(Matrix4MakePerspectiveFieldOfView(1.0f, 1.5f, 0.1f, 100.0f), TestMatrix4(-1.0f, 5, 6, 7));
+	
+	auto out = Matrix4AlignedMake(m1) * Matrix4AlignedMake(m2);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(&out) % 16, 0u);
+	ExpectNearMatrix4(out, Matrix4Multiply(m1, m2), 1e-5f);
+}
+
+TEST(Matrix4, InvertAligned) {
+	auto m = TestMatrix4(0.7f, -10, 20, 30);
+	
+	bool invertible = false;
+	auto inverse = Matrix4InvertAligned(Matrix4AlignedMake(m), &invertible);
+	EXPECT_TRUE(invertible);
+	ExpectNearMatrix4(inverse, Matrix4Invert(m, nullptr), 1e-5f);
+	ExpectNearMatrix4(Matrix4Multiply(m, inverse), Matrix4MakeIdentity(), 1e-5f);
+	
+	Matrix4InvertAligned(Matrix4AlignedMake(Matrix4MakeScale(1, 0, 1)), &invertible);
+	EXPECT_FALSE(invertible);
+}
+
+TEST(Matrix4, MakeWithTransform) {
+	auto transform = Transform {
+		.sx = 2, .sy = 3, .sz = 4,
+		.radX = 0.3f, .radY = -0.7f, .radZ = 1.1f,
+		.tx = 5, .ty = 6, .tz = 7
+	};
+	auto expected =
+		Matrix4MakeScale(2, 3, 4) *
+		Matrix4MakeXRotation(0.3f) * Matrix4MakeYRotation(-0.7f) * Matrix4MakeZRotation(1.1f) *
+		Matrix4MakeTranslation(5, 6, 7);
+	ExpectNearMatrix4(Matrix4MakeWithTransform(transform), expected, 1e-5f);
+	
+	auto rotation = QuaternionMakeRotationAxisAngle(0, 1, 0, 0.5f);
+	ExpectNearMatrix4(
+		Matrix4MakeWithScaleRotationTranslation(Vector3Make(1, 2, 3), rotation, Vector3Make(-1, -2, -3)),
+		Matrix4MakeScale(1, 2, 3) * Matrix4MakeYRotation(0.5f) * Matrix4MakeTranslation(-1, -2, -3),
+		1e-5f);
+}
+
+TEST(Matrix43, Multiply) {
+	auto m1 = TestMatrix4(0.5f, 1, 2, 3);
+	auto m2 = TestMatrix4(-1.2f, -4, 5, 6);
+	auto m = Matrix43MakeWithMatrix4(m1) * Matrix43MakeWithMatrix4(m2);
+	ExpectNearMatrix4(Matrix43ToMatrix4(m), m1 * m2, 1e-4f);
+	
+	auto point = Vector3Make(1, -2, 3);
+	auto expected = Vector3Transform(point, m1 * m2);
+	auto transformed = Vector3Transform(point, m);
+	EXPECT_NEAR(transformed.x, expected.x, 1e-4f);
+	EXPECT_NEAR(transformed.y, expected.y, 1e-4f);
+	EXPECT_NEAR(transformed.z, expected.z, 1e-4f);
+	
+	// Vectors are not translated
+	auto rotated = Vector3Rotate(point, m);
+	expected = Vector3Rotate(point, m1 * m2);
+	EXPECT_NEAR(rotated.x, expected.x, 1e-4f);
+	EXPECT_NEAR(rotated.y, expected.y, 1e-4f);
+	EXPECT_NEAR(rotated.z, expected.z, 1e-4f);
+	
+	auto rotation = QuaternionMakeRotationAxisAngle(1, 2, 3, 0.8f);
+	ExpectNearMatrix4(
+		Matrix43ToMatrix4(Matrix43MakeWithScaleRotationTranslation(Vector3Make(2, 3, 4), rotation, Vector3Make(5, 6, 7))),
+		Matrix4MakeWithScaleRotationTranslation(Vector3Make(2, 3, 4), rotation, Vector3Make(5, 6, 7)),
+		1e-6f);
+}
+
+TEST(Matrix43, Invert) {
+	auto m = TestMatrix4(0.7f, -10, 20, 30);
+	
+	bool invertible = false;
+	auto inverse = Matrix43Invert(Matrix43MakeWithMatrix4(m), &invertible);
+	EXPECT_TRUE(invertible);
+	ExpectNearMatrix4(Matrix43ToMatrix4(inverse), Matrix4Invert(m, nullptr), 1e-5f);
+	
+	// Mirroring is invertible
+	auto mirror = Matrix43MakeScale(-1, 2, 1) * Matrix43MakeTranslation(1, 2, 3);
+	inverse = Matrix43Invert(mirror, &invertible);
+	EXPECT_TRUE(invertible);
+	ExpectNearMatrix4(Matrix43ToMatrix4(mirror * inverse), Matrix4MakeIdentity(), 1e-6f);
+	
+	Matrix43Invert(Matrix43MakeScale(1, 0, 1), &invertible);
+	EXPECT_FALSE(invertible);
+}
+
+TEST(Vector3, TransformArray) {
+	// Odd count to cover the tail of vector kernels
+	constexpr size_t kCount = 103;
+	std::vector<Vector3> points(kCount), out(kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		auto f = static_cast<float>(i);
+		points[i] = Vector3Make(f, -2 * f, f * 0.5f + 1);
+	}
+	
+	auto m = TestMatrix4(0.3f, 1, 2, 3);
+	Vector3TransformArray(points.data(), m, out.data(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		auto expected = Vector3Transform(points[i], m);
+		EXPECT_NEAR(out[i].x, expected.x, 1e-3f);
+		EXPECT_NEAR(out[i].y, expected.y, 1e-3f);
+		EXPECT_NEAR(out[i].z, expected.z, 1e-3f);
+	}
+	
+	auto projection = Matrix4Multiply(m, Matrix4MakePerspectiveFieldOfView(1.0f, 1.5f, 0.1f, 1000.0f));
+	Vector3TransformAndProjectCoordArray(points.data(), projection, out.data(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		auto expected = Vector3TransformAndProjectCoord(points[i], projection);
+		EXPECT_NEAR(out[i].x, expected.x, 1e-4f);
+		EXPECT_NEAR(out[i].y, expected.y, 1e-4f);
+		EXPECT_NEAR(out[i].z, expected.z, 1e-4f);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+struct CullingObjects {
+	std::vector<float> x, y, z, radius, extentX, extentY, extentZ;
+	
+	explicit CullingObjects(size_t count) : x(count), y(count), z(count), radius(count), extentX(count), extentY(count), extentZ(count) {
+		Random random;
+		for (size_t i = 0; i < count; ++i) {
+			x[i] = random.NextFloat(-100.0f, 100.0f);
+			y[i] = random.NextFloat(-100.0f, 100.0f);
+			z[i] = random.NextFloat(-100.0f, 100.0f);
+			radius[i] = random.NextFloat(0.1f, 10.0f);
+			extentX[i] = random.NextFloat(0.1f, 10.0f);
+			extentY[i] = random.NextFloat(0.1f, 10.0f);
+			extentZ[i] = random.NextFloat(0.1f, 10.0f);
+		}
+	}
+	
+	SphereBatch Spheres() const { return {x.data(), y.data(), z.data(), radius.data()}; }
+	AABBBatch Boxes() const { return {x.data(), y.data(), z.data(), extentX.data(), extentY.data(), extentZ.data()}; }
+	
+	Sphere GetSphere(size_t i) const { return SphereMake(Vector3Make(x[i], y[i], z[i]), radius[i]); }
+	AABB GetAABB(size_t i) const { return AABBMakeWithCenterAndExtents(Vector3Make(x[i], y[i], z[i]), Vector3Make(extentX[i], extentY[i], extentZ[i])); }
+};
+
+static Frustum TestFrustum(float rad) {
+	auto view = Matrix4Multiply(Matrix4MakeYRotation(rad), Matrix4MakeTranslation(0, 0, 20));
+	auto frustum = FrustumMakeWithMatrix(Matrix4Multiply(view, Matrix4MakePerspectiveFieldOfView(1.0f, 1.5f, 1.0f, 100.0f)));
+	FrustumNormalize(frustum);
+	return frustum;
+}
+
+TEST(Frustum, CullSpheres) {
+	// Odd count to cover the tail of vector kernels
+	constexpr size_t kCount = 1003;
+	CullingObjects objects{kCount};
+	
+	std::vector<uint32_t> visibility((kCount + 31) / 32);
+	std::vector<uint32_t> indices(kCount);
+	std::vector<uint8_t> planeCache(kCount);
+	
+	// Second and third frames turn the camera and reuse the plane cache
+	for (float rad : {0.0f, 0.5f, 0.6f}) {
+		auto frustum = TestFrustum(rad);
+		FrustumCullSpheresToMask(frustum, objects.Spheres(), kCount, visibility.data());
+		auto visibleCount = FrustumCullSpheresToIndices(frustum, objects.Spheres(), kCount, indices.data(), planeCache.data());
+		
+		std::vector<uint32_t> expected;
+		for (size_t i = 0; i < kCount; ++i) {
+			auto visible = !FrustumCullSphere(frustum, objects.GetSphere(i));
+			EXPECT_EQ((visibility[i / 32] >> (i % 32)) & 1, visible ? 1u : 0u) << "sphere " << i;
+			if (visible) {
+				expected.push_back(static_cast<uint32_t>(i));
+			}
+		}
+		
+		EXPECT_GT(expected.size(), 0u);
+		EXPECT_LT(expected.size(), kCount);
+		ASSERT_EQ(visibleCount, expected.size());
+		EXPECT_TRUE(std::equal(expected.begin(), expected.end(), indices.begin()));
+	}
+}
+
+TEST(Frustum, CullAABBs) {
+	constexpr size_t kCount = 1003;
+	CullingObjects objects{kCount};
+	
+	std::vector<uint32_t> visibility((kCount + 31) / 32);
+	std::vector<uint32_t> indices(kCount);
+	std::vector<uint8_t> planeCache(kCount);
+	
+	for (float rad : {0.0f, 0.5f, 0.6f}) {
+		auto frustum = TestFrustum(rad);
+		FrustumCullAABBsToMask(frustum, objects.Boxes(), kCount, visibility.data(), planeCache.data());
+		auto visibleCount = FrustumCullAABBsToIndices(frustum, objects.Boxes(), kCount, indices.data());
+		
+		std::vector<uint32_t> expected;
+		for (size_t i = 0; i < kCount; ++i) {
+			auto visible = !FrustumCullAABB(frustum, objects.GetAABB(i));
+			EXPECT_EQ((visibility[i / 32] >> (i % 32)) & 1, visible ? 1u : 0u) << "box " << i;
+			if (visible) {
+				expected.push_back(static_cast<uint32_t>(i));
+			}
+		}
+		
+		EXPECT_GT(expected.size(), 0u);
+		ASSERT_EQ(visibleCount, expected.size());
+		EXPECT_TRUE(std::equal(expected.begin(), expected.end(), indices.begin()));
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+TEST(Rect, Transform) {
+	auto m = Matrix32MakeWithTransform2D(Transform2D {
+		.sx = 2,
+		.sy = 3,
+		.shearX = 0,
+		.shearY = 0,
+		.rad = 0.5f,
+		.tx = 10,
+		.ty = -20
+	});
+	auto p = Vector2TransformCoord(Vector2Make(1, 2), m);
+	EXPECT_NEAR(p.x, 1 * m.a + 2 * m.c + m.tx, 1e-5f);
+	EXPECT_NEAR(p.y, 1 * m.b + 2 * m.d + m.ty, 1e-5f);
+	
+	auto r = RectTransform(RectMake(Vector2Make(-1, -2), Vector2Make(3, 4)), m);
+	auto expected = RectMakeEmpty();
+	for (auto corner : {Vector2Make(-1, -2), Vector2Make(3, -2), Vector2Make(-1, 4), Vector2Make(3, 4)}) {
+		expected = RectAddPoint(expected, Vector2TransformCoord(corner, m));
+	}
+	EXPECT_NEAR(r.min.x, expected.min.x, 1e-4f);
+	EXPECT_NEAR(r.min.y, expected.min.y, 1e-4f);
+	EXPECT_NEAR(r.max.x, expected.max.x, 1e-4f);
+	EXPECT_NEAR(r.max.y, expected.max.y, 1e-4f);
+	
+	EXPECT_TRUE(RectIsEmpty(RectTransform(RectMakeEmpty(), m)));
+}
+
+static SceneObject AddBounds2D(SceneObject parent, Rect bounds, float tx, float ty) {
+	auto object = parent.AppendChild();
+	auto transform = object.AddComponent<Transform2DComponent>();
+	transform->localTransform.tx = tx;
+	transform->localTransform.ty = ty;
+	object.AddComponent<Bounds2DComponent>()->localBounds = bounds;
+	return object;
+}
+
+static std::vector<SceneObject> SortedObjects(std::vector<SceneObject> objects) {
+	std::sort(objects.begin(), objects.end());
+	return objects;
+}
+
+TEST(Bounds2DComponent, Cull) {
+	auto scene = std::make_unique<Scene>();
+	auto unit = RectMakeWithOriginAndSize(0, 0, 10, 10);
+	
+	auto a = AddBounds2D(scene->GetRootObject(), unit, 100, 0);
+	auto b = AddBounds2D(a, unit, 5, 5);
+	// Object without components passes transform and bounds of its children through
+	auto d = AddBounds2D(a.AppendChild(), unit, -1000, 0);
+	auto e = AddBounds2D(scene->GetRootObject(), unit, 1000, 1000);
+	auto f = AddBounds2D(e, unit, 10, 10);
+	
+	ComponentMessageParams params;
+	scene->GetRootObject().BroadcastMessage(ComponentMessages::Apply, params);
+	Bounds2DComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	auto bBounds = b.FindComponent<Bounds2DComponent>()->GetWorldBounds();
+	EXPECT_EQ(bBounds.min.x, 105.0f);
+	EXPECT_EQ(bBounds.max.y, 15.0f);
+	auto aSubtree = a.FindComponent<Bounds2DComponent>()->GetSubtreeBounds();
+	EXPECT_EQ(aSubtree.min.x, -900.0f);
+	EXPECT_EQ(aSubtree.max.x, 115.0f);
+	EXPECT_EQ(e.FindComponent<Bounds2DComponent>()->GetSubtreeBounds().max.x, 1020.0f);
+	
+	std::vector<SceneObject> visible;
+	Bounds2DComponent::Cull(scene->GetRootObject(), RectMakeWithOriginAndSize(0, 0, 200, 200), visible);
+	EXPECT_EQ(SortedObjects(visible), SortedObjects({a, b}));
+	
+	visible.clear();
+	Bounds2DComponent::Cull(scene->GetRootObject(), RectMakeWithOriginAndSize(-2000, -2000, 4000, 4000), visible);
+	EXPECT_EQ(SortedObjects(visible), SortedObjects({a, b, d, e, f}));
+	
+	visible.clear();
+	Bounds2DComponent::Cull(scene->GetRootObject(), RectMakeWithOriginAndSize(1015, 1015, 100, 100), visible);
+	EXPECT_EQ(visible, std::vector<SceneObject>{f});
+}
+
+TEST(BoundsComponent, Cull) {
+	auto scene = std::make_unique<Scene>();
+	auto frustum = TestFrustum(0);
+	
+	// Groups of objects along x axis, most of them out of the frustum
+	std::vector<SceneObject> objects;
+	for (int i = 0; i < 8; ++i) {
+		auto group = scene->AddObject();
+		group.AddComponent<BoundsComponent>();
+		for (int k = 0; k < 8; ++k) {
+			auto object = group.AppendChild();
+			auto center = Vector3Make(static_cast<float>((i - 4) * 40 + k * 4), static_cast<float>(k - 4), -40);
+			object.AddComponent<BoundsComponent>()->localBounds = AABBMakeWithCenterAndExtents(center, Vector3Make(1, 1, 1));
+			objects.push_back(object);
+		}
+	}
+	
+	BoundsComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	std::vector<SceneObject> expected;
+	for (auto object : objects) {
+		if (!FrustumCullAABB(frustum, object.FindComponent<BoundsComponent>()->GetWorldBounds())) {
+			expected.push_back(object);
+		}
+	}
+	
+	std::vector<SceneObject> visible;
+	BoundsComponent::Cull(scene->GetRootObject(), frustum, visible);
+	EXPECT_GT(visible.size(), 0u);
+	EXPECT_LT(visible.size(), objects.size());
+	EXPECT_EQ(SortedObjects(visible), SortedObjects(expected));
+}
+
+TEST(TransformComponent, UpdateHierarchy) {
+	auto scene = std::make_unique<Scene>();
+	auto parent = scene->AddObject();
+	auto group = parent.AppendChild();
+	auto child = group.AppendChild();
+	auto sibling = parent.AppendChild();
+	auto other = scene->AddObject();
+	
+	auto parentTransform = parent.AddComponent<TransformComponent>();
+	parentTransform->SetTranslation(Vector3Make(10, 0, -40));
+	parentTransform->SetRotation(QuaternionMakeRotationAxisAngle(0, 0, 1, 0.5f));
+	auto childTransform = child.AddComponent<TransformComponent>();
+	childTransform->SetScale(Vector3Make(2, 2, 2));
+	childTransform->SetTranslation(Vector3Make(1, 2, 3));
+	auto siblingTransform = sibling.AddComponent<TransformComponent>();
+	auto otherTransform = other.AddComponent<TransformComponent>();
+	child.AddComponent<BoundsComponent>()->localBounds = AABBMakeWithCenterAndExtents(Vector3MakeZero(), Vector3Make(1, 1, 1));
+	
+	TransformComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_FALSE(childTransform->IsLocalDirty());
+	
+	// Objects without the component pass the parent transform through
+	auto parentMatrix = Matrix4MakeZRotation(0.5f) * Matrix4MakeTranslation(10, 0, -40);
+	ExpectNearMatrix4(Matrix43ToMatrix4(parentTransform->GetWorldMatrix()), parentMatrix, 1e-5f);
+	ExpectNearMatrix4(Matrix43ToMatrix4(childTransform->GetWorldMatrix()), Matrix4MakeScale(2, 2, 2) * Matrix4MakeTranslation(1, 2, 3) * parentMatrix, 1e-5f);
+	
+	BoundsComponent::UpdateHierarchy(scene->GetRootObject());
+	auto expectedBounds = AABBTransform(AABBMakeWithCenterAndExtents(Vector3MakeZero(), Vector3Make(1, 1, 1)), childTransform->GetWorldMatrix());
+	auto& worldBounds = child.FindComponent<BoundsComponent>()->GetWorldBounds();
+	EXPECT_NEAR(worldBounds.min.x, expectedBounds.min.x, 1e-5f);
+	EXPECT_NEAR(worldBounds.max.z, expectedBounds.max.z, 1e-5f);
+	
+	// Unchanged transforms keep their world matrices
+	auto parentVersion = parentTransform->GetWorldVersion();
+	auto childVersion = childTransform->GetWorldVersion();
+	auto siblingVersion = siblingTransform->GetWorldVersion();
+	auto otherVersion = otherTransform->GetWorldVersion();
+	TransformComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_EQ(parentTransform->GetWorldVersion(), parentVersion);
+	EXPECT_EQ(childTransform->GetWorldVersion(), childVersion);
+	
+	// Change of the parent propagates to all its children, not to other subtrees
+	parentTransform->SetTranslation(Vector3Make(0, 0, -20));
+	EXPECT_TRUE(parentTransform->IsLocalDirty());
+	TransformComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_NE(parentTransform->GetWorldVersion(), parentVersion);
+	EXPECT_NE(childTransform->GetWorldVersion(), childVersion);
+	EXPECT_NE(siblingTransform->GetWorldVersion(), siblingVersion);
+	EXPECT_EQ(otherTransform->GetWorldVersion(), otherVersion);
+	ExpectNearMatrix4(Matrix43ToMatrix4(childTransform->GetWorldMatrix()),
+		Matrix4MakeScale(2, 2, 2) * Matrix4MakeTranslation(1, 2, 3) * Matrix4MakeZRotation(0.5f) * Matrix4MakeTranslation(0, 0, -20), 1e-5f);
+	
+	// Update of a subtree leaves the rest untouched
+	childVersion = childTransform->GetWorldVersion();
+	siblingVersion = siblingTransform->GetWorldVersion();
+	childTransform->SetTranslation(Vector3MakeZero());
+	siblingTransform->SetTranslation(Vector3MakeZero());
+	TransformComponent::UpdateHierarchy(group);
+	EXPECT_NE(childTransform->GetWorldVersion(), childVersion);
+	EXPECT_EQ(siblingTransform->GetWorldVersion(), siblingVersion);
+	EXPECT_TRUE(siblingTransform->IsLocalDirty());
+}
+
+TEST(Transform2DComponent, UpdateHierarchy) {
+	auto scene = std::make_unique<Scene>();
+	auto parent = scene->AddObject();
+	auto child = parent.AppendChild().AppendChild();
+	auto other = scene->AddObject();
+	
+	auto parentTransform = parent.AddComponent<Transform2DComponent>();
+	parentTransform->localTransform.tx = 10;
+	auto childTransform = child.AddComponent<Transform2DComponent>();
+	childTransform->localTransform.ty = 5;
+	auto otherTransform = other.AddComponent<Transform2DComponent>();
+	
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_FALSE(parentTransform->IsDirty());
+	EXPECT_FLOAT_EQ(childTransform->GetWorldTransform().tx, 10);
+	EXPECT_FLOAT_EQ(childTransform->GetWorldTransform().ty, 5);
+	
+	// Writes without marking dirty are not picked up
+	auto childVersion = childTransform->GetWorldVersion();
+	auto otherVersion = otherTransform->GetWorldVersion();
+	parentTransform->localTransform.tx = 20;
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_EQ(childTransform->GetWorldVersion(), childVersion);
+	
+	parentTransform->MarkDirty();
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_NE(childTransform->GetWorldVersion(), childVersion);
+	EXPECT_EQ(otherTransform->GetWorldVersion(), otherVersion);
+	EXPECT_FLOAT_EQ(childTransform->GetWorldTransform().tx, 20);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+TEST(Easing, Endpoints) {
+	for (auto easing : {Easing::Step, Easing::Linear, Easing::QuadIn, Easing::QuadOut, Easing::QuadInOut,
+		Easing::CubicIn, Easing::CubicOut, Easing::CubicInOut, Easing::SineInOut, Easing::BackOut})
+	{
+		EXPECT_NEAR(Ease(easing, 0), 0.0f, 1e-6f);
+		EXPECT_NEAR(Ease(easing, 1), 1.0f, 1e-6f);
+	}
+	
+	EXPECT_FLOAT_EQ(Ease(Easing::Step, 0.99f), 0);
+	EXPECT_FLOAT_EQ(Ease(Easing::QuadInOut, 0.5f), 0.5f);
+	EXPECT_GT(Ease(Easing::BackOut, 0.8f), 1.0f);
+}
+
+static Animator2D::ClipId CreateTestClip(Animator2D& animator) {
+	const Animator2D::Keyframe translation[] = {
+		{0, 0, Easing::Linear},
+		{1, 10, Easing::Linear},
+		{2, 10, Easing::Linear}
+	};
+	const Animator2D::Keyframe rotation[] = {
+		{0, 0, Easing::Step},
+		{1, 1, Easing::Step}
+	};
+	const Animator2D::Track tracks[] = {
+		{Transform2DChannel::TranslationX, translation, 3},
+		{Transform2DChannel::Rotation, rotation, 2}
+	};
+	return animator.CreateClip(tracks, 2);
+}
+
+TEST(Animator2D, Update) {
+	auto scene = std::make_unique<Scene>();
+	auto transform = scene->AddObject().AddComponent<Transform2DComponent>();
+	transform->localTransform.ty = 3;
+	
+	Animator2D animator;
+	auto clip = CreateTestClip(animator);
+	ASSERT_NE(clip, Animator2D::kInvalidClip);
+	EXPECT_FLOAT_EQ(animator.GetClipDuration(clip), 2);
+	
+	const Animator2D::Keyframe unsorted[] = {{1, 0, Easing::Linear}, {0, 1, Easing::Linear}};
+	const Animator2D::Track invalid = {Transform2DChannel::ScaleX, unsorted, 2};
+	EXPECT_EQ(animator.CreateClip(&invalid, 1), Animator2D::kInvalidClip);
+	
+	auto instance = animator.Play(clip, transform);
+	EXPECT_TRUE(animator.IsPlaying(instance));
+	
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	animator.Update(0.5f);
+	EXPECT_FLOAT_EQ(transform->localTransform.tx, 5);
+	EXPECT_FLOAT_EQ(transform->localTransform.rad, 0);
+	EXPECT_FLOAT_EQ(transform->localTransform.ty, 3);
+	EXPECT_TRUE(transform->IsDirty());
+	
+	animator.Update(0.75f);
+	EXPECT_FLOAT_EQ(transform->localTransform.tx, 10);
+	EXPECT_FLOAT_EQ(transform->localTransform.rad, 1);
+	
+	// Unchanged values leave the component clean
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	animator.Update(0.25f);
+	EXPECT_FALSE(transform->IsDirty());
+	
+	// Finished instances are removed
+	animator.Update(1);
+	EXPECT_FALSE(animator.IsPlaying(instance));
+	EXPECT_EQ(animator.Size(), 0u);
+	
+	// Looping wraps time, playing on the same target replaces the instance
+	auto looping = animator.Play(clip, transform, true);
+	auto replacing = animator.Play(clip, transform, true, -1);
+	EXPECT_FALSE(animator.IsPlaying(looping));
+	EXPECT_EQ(animator.Size(), 1u);
+	animator.Update(1.5f);
+	EXPECT_FLOAT_EQ(transform->localTransform.tx, 5);
+	animator.Update(1);
+	EXPECT_TRUE(animator.IsPlaying(replacing));
+	EXPECT_FLOAT_EQ(transform->localTransform.tx, 10);
+	
+	animator.Stop(replacing);
+	EXPECT_EQ(animator.Size(), 0u);
+}
+
+TEST(Animator2D, UpdateParallel) {
+	constexpr size_t kCount = 5000;
+	auto scene = std::make_unique<Scene>();
+	
+	Animator2D serial, parallel;
+	auto serialClip = CreateTestClip(serial);
+	auto parallelClip = CreateTestClip(parallel);
+	
+	std::vector<Transform2DComponent*> serialTransforms, parallelTransforms;
+	for (size_t i = 0; i < kCount; ++i) {
+		auto speed = 0.5f + static_cast<float>(i % 7) * 0.25f;
+		serialTransforms.push_back(scene->AddObject().AddComponent<Transform2DComponent>());
+		parallelTransforms.push_back(scene->AddObject().AddComponent<Transform2DComponent>());
+		serial.Play(serialClip, serialTransforms.back(), i % 2 == 0, speed);
+		parallel.Play(parallelClip, parallelTransforms.back(), i % 2 == 0, speed);
+	}
+	
+	ThreadPool pool(3);
+	for (int frame = 0; frame < 10; ++frame) {
+		serial.Update(0.3f);
+		parallel.Update(0.3f, &pool);
+	}
+	
+	EXPECT_EQ(serial.Size(), parallel.Size());
+	EXPECT_LT(parallel.Size(), kCount);
+	for (size_t i = 0; i < kCount; ++i) {
+		EXPECT_FLOAT_EQ(parallelTransforms[i]->localTransform.tx, serialTransforms[i]->localTransform.tx);
+		EXPECT_FLOAT_EQ(parallelTransforms[i]->localTransform.rad, serialTransforms[i]->localTransform.rad);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static SpriteComponent* AddSprite(SceneObject parent, void* texture, float tx) {
+	auto object = parent.AppendChild();
+	object.AddComponent<Transform2DComponent>()->localTransform.tx = tx;
+	auto sprite = object.AddComponent<SpriteComponent>();
+	sprite->texture = texture;
+	sprite->size = Vector2Make(2, 4);
+	return sprite;
+}
+
+TEST(SpriteBatcher, Build) {
+	auto scene = std::make_unique<Scene>();
+	int textures[2];
+	
+	auto group = scene->AddObject();
+	group.AddComponent<Transform2DComponent>()->localTransform.ty = 100;
+	AddSprite(group, &textures[0], 1);
+	AddSprite(group, &textures[0], 2);
+	auto hidden = AddSprite(group, &textures[1], 3);
+	hidden->visible = false;
+	AddSprite(scene->GetRootObject().LastChild().LastChild(), &textures[0], 10);
+	AddSprite(group, &textures[1], 4);
+	AddSprite(scene->GetRootObject(), &textures[1], 5)->pipeline = &textures[0];
+	
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	SpriteBatcher batcher;
+	batcher.Build(scene->GetRootObject());
+	
+	// Child of the hidden sprite is skipped, its sibling with the same texture joins the batch
+	auto& instances = batcher.GetInstances();
+	ASSERT_EQ(instances.size(), 4u);
+	EXPECT_FLOAT_EQ(instances[0].transform.a, 2);
+	EXPECT_FLOAT_EQ(instances[0].transform.d, 4);
+	EXPECT_FLOAT_EQ(instances[0].transform.tx, 1);
+	EXPECT_FLOAT_EQ(instances[0].transform.ty, 100);
+	EXPECT_FLOAT_EQ(instances[2].transform.tx, 4);
+	EXPECT_FLOAT_EQ(instances[3].transform.ty, 0);
+	EXPECT_FLOAT_EQ(instances[0].pivotX, 0.5f);
+	EXPECT_FLOAT_EQ(instances[0].texW, 1);
+	
+	auto& batches = batcher.GetBatches();
+	ASSERT_EQ(batches.size(), 3u);
+	EXPECT_EQ(batches[0].texture, &textures[0]);
+	EXPECT_EQ(batches[0].instanceCount, 2u);
+	EXPECT_EQ(batches[1].texture, &textures[1]);
+	EXPECT_EQ(batches[1].firstInstance, 2u);
+	EXPECT_EQ(batches[2].pipeline, &textures[0]);
+	
+	// Culling results keep their order, children of hidden sprites are skipped there too
+	auto hiddenChild = group.FirstChild().NextSibling().NextSibling().FirstChild();
+	ASSERT_TRUE(hiddenChild.FindComponent<SpriteComponent>());
+	std::vector<SceneObject> objects {group.FirstChild(), hiddenChild, group.LastChild(), group.FirstChild().NextSibling()};
+	batcher.Clear();
+	batcher.Build(objects.data(), objects.size());
+	ASSERT_EQ(batcher.GetInstances().size(), 3u);
+	EXPECT_FLOAT_EQ(batcher.GetInstances()[1].transform.tx, 4);
+	EXPECT_EQ(batcher.GetBatches().size(), 3u);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// Keeps transfer buffers in memory and executes copies at once, fences are signaled by the test
+class MockUploadDevice final : public UploadDevice {
+public:
+	void* CreateTransferBuffer(uint32_t size) noexcept override {
+		transferBuffers.push_back(std::make_unique<std::vector<std::byte>>(size));
+		return transferBuffers.back().get();
+	}
+	
+	void ReleaseTransferBuffer(void* transferBuffer) noexcept override {
+		EXPECT_EQ(mappedCount, 0);
+		std::erase_if(transferBuffers, [transferBuffer](auto& buffer) { return buffer.get() == transferBuffer; });
+	}
+	
+	void* MapTransferBuffer(void* transferBuffer) noexcept override {
+		++mappedCount;
+		return static_cast<std::vector<std::byte>*>(transferBuffer)->data();
+	}
+	
+	void UnmapTransferBuffer(void*) noexcept override { --mappedCount; }
+	
+	void UploadToBuffers(void*, const UploadRegion* regions, size_t count) noexcept override {
+		EXPECT_EQ(mappedCount, 0);
+		++copyPassCount;
+		for (size_t i = 0; i < count; ++i) {
+			auto& region = regions[i];
+			auto src = static_cast<std::vector<std::byte>*>(region.transferBuffer)->data() + region.transferOffset;
+			std::memcpy(static_cast<std::byte*>(region.buffer) + region.bufferOffset, src, region.size);
+		}
+		regionCount += count;
+	}
+	
+	void* Submit(void*) noexcept override { return reinterpret_cast<void*>(++submittedFences); }
+	bool IsFenceSignaled(void* fence) noexcept override { return reinterpret_cast<uintptr_t>(fence) <= signaledFences; }
+	void WaitForFence(void* fence) noexcept override { ++waitCount; signaledFences = std::max(signaledFences, reinterpret_cast<uintptr_t>(fence)); }
+	void ReleaseFence(void* fence) noexcept override { EXPECT_TRUE(IsFenceSignaled(fence)); }
+	
+	std::vector<std::unique_ptr<std::vector<std::byte>>> transferBuffers;
+	int mappedCount = 0;
+	int copyPassCount = 0;
+	size_t regionCount = 0;
+	uintptr_t submittedFences = 0;
+	uintptr_t signaledFences = 0;
+	int waitCount = 0;
+};
+
+TEST(UploadManager, Coalesce) {
+	MockUploadDevice device;
+	uint32_t buffer1[64] = {};
+	uint32_t buffer2[64] = {};
+	
+	{
+		UploadManager uploads(device, 1024);
+		uploads.BeginFrame();
+		
+		// Consecutive ranges of the same buffer become one region
+		for (uint32_t i = 0; i < 16; ++i) {
+			auto data = static_cast<uint32_t*>(uploads.Upload(buffer1, i * 16, 16));
+			std::fill_n(data, 4, i);
+		}
+		std::fill_n(static_cast<uint32_t*>(uploads.Upload(buffer2, 0, 8)), 2, 100u);
+		std::fill_n(static_cast<uint32_t*>(uploads.Upload(buffer1, 128, 16)), 4, 200u);
+		EXPECT_EQ(uploads.GetPendingRegionCount(), 3u);
+		
+		uploads.Flush(nullptr);
+		EXPECT_EQ(device.copyPassCount, 1);
+		EXPECT_EQ(device.regionCount, 3u);
+		EXPECT_EQ(buffer1[0], 0u);
+		EXPECT_EQ(buffer1[63], 15u);
+		EXPECT_EQ(buffer1[32], 200u);
+		EXPECT_EQ(buffer2[1], 100u);
+		EXPECT_EQ(buffer2[2], 0u);
+		
+		// Nothing to copy, no copy pass
+		uploads.EndFrame(nullptr);
+		EXPECT_EQ(device.copyPassCount, 1);
+		EXPECT_EQ(uploads.GetFramesInFlight(), 1u);
+	}
+	
+	EXPECT_TRUE(device.transferBuffers.empty());
+}
+
+TEST(UploadManager, FramesInFlight) {
+	MockUploadDevice device;
+	std::byte buffer[1024];
+	
+	UploadManager uploads(device, 1024, 2);
+	
+	// Ring is reused once frames complete
+	for (int frame = 0; frame < 10; ++frame) {
+		uploads.BeginFrame();
+		EXPECT_LE(uploads.GetFramesInFlight(), 1u);
+		uploads.Upload(buffer, 0, 300);
+		uploads.Upload(buffer, 512, 100);
+		uploads.EndFrame(nullptr);
+	}
+	EXPECT_EQ(device.waitCount, 8);
+	EXPECT_EQ(uploads.GetCapacity(), 1024u);
+	EXPECT_EQ(device.transferBuffers.size(), 1u);
+	
+	// Signaled fences free the ring without waiting
+	device.signaledFences = device.submittedFences;
+	uploads.BeginFrame();
+	EXPECT_EQ(uploads.GetFramesInFlight(), 0u);
+	uploads.Upload(buffer, 0, 1024);
+	uploads.EndFrame(nullptr);
+	EXPECT_EQ(device.waitCount, 8);
+	EXPECT_EQ(uploads.GetCapacity(), 1024u);
+	
+	uploads.WaitIdle();
+	EXPECT_EQ(uploads.GetFramesInFlight(), 0u);
+}
+
+TEST(UploadManager, Grow) {
+	MockUploadDevice device;
+	std::byte source[4096];
+	std::byte buffer[4096] = {};
+	for (size_t i = 0; i < std::size(source); ++i) {
+		source[i] = static_cast<std::byte>(i * 7);
+	}
+	
+	UploadManager uploads(device, 256, 4);
+	uploads.BeginFrame();
+	uploads.Upload(buffer, 0, 64);
+	uploads.EndFrame(nullptr);
+	
+	// Data written before growing is still copied from the old buffer
+	uploads.BeginFrame();
+	for (uint32_t offset = 0; offset < std::size(source); offset += 512) {
+		std::memcpy(uploads.Upload(buffer, offset, 512), source + offset, 512);
+	}
+	EXPECT_EQ(uploads.GetCapacity(), 4096u);
+	EXPECT_EQ(device.transferBuffers.size(), 5u);
+	
+	uploads.EndFrame(nullptr);
+	EXPECT_EQ(std::memcmp(buffer, source, std::size(source)), 0);
+	
+	// Old buffers are released when the frames using them complete
+	uploads.BeginFrame();
+	EXPECT_EQ(device.transferBuffers.size(), 5u);
+	device.signaledFences = 1;
+	uploads.BeginFrame();
+	EXPECT_EQ(device.transferBuffers.size(), 5u);
+	device.signaledFences = 2;
+	uploads.BeginFrame();
+	EXPECT_EQ(device.transferBuffers.size(), 1u);
+	EXPECT_EQ(device.waitCount, 0);
+}
+
+TEST(UploadManager, EmptyFramesInFlight) {
+	MockUploadDevice device;
+	std::byte buffer[512];
+	
+	UploadManager uploads(device, 256, 4);
+	uploads.BeginFrame();
+	uploads.Upload(buffer, 0, 128);
+	uploads.EndFrame(nullptr);
+	uploads.BeginFrame();
+	uploads.EndFrame(nullptr);
+	
+	// Ring starts over while the empty frame is in flight
+	device.signaledFences = 1;
+	uploads.BeginFrame();
+	auto data = static_cast<std::byte*>(uploads.Upload(buffer, 0, 64));
+	uploads.EndFrame(nullptr);
+	
+	// Completing the empty frame gives back nothing of the data uploaded after it
+	device.signaledFences = 2;
+	uploads.BeginFrame();
+	for (int i = 0; i < 2; ++i) {
+		auto next = static_cast<std::byte*>(uploads.Upload(buffer, 128 + i * 100, 100));
+		EXPECT_TRUE(next >= data + 64 || next + 100 <= data);
+	}
+	EXPECT_EQ(uploads.GetCapacity(), 512u);
+	uploads.EndFrame(nullptr);
+	
+	uploads.WaitIdle();
+}
+
+TEST(NullGpuDevice, Upload) {
+	NullGpuDevice device;
+	{
+		GpuUploadDevice uploadDevice(device);
+		UploadManager uploads(uploadDevice, 256);
+		Buffer buffer(&device);
+		buffer.Create(BufferUsage::Vertex, 64);
+		ASSERT_TRUE(buffer.Valid());
+		device.ClearCommands();
+		
+		uploads.BeginFrame();
+		auto commandBuffer = device.AcquireCommandBuffer();
+		std::memset(uploads.Upload(buffer, 0, 16), 1, 16);
+		std::memset(uploads.Upload(buffer, 16, 16), 2, 16);
+		std::memset(uploads.Upload(buffer, 48, 16), 3, 16);
+		uploads.EndFrame(commandBuffer);
+		
+		// Copies execute on submit
+		auto data = device.GetData(buffer.Handle());
+		ASSERT_EQ(device.GetSize(buffer.Handle()), 64u);
+		EXPECT_EQ(data[15], std::byte{1});
+		EXPECT_EQ(data[16], std::byte{2});
+		EXPECT_EQ(data[32], std::byte{0});
+		EXPECT_EQ(data[63], std::byte{3});
+		
+		std::vector<NullGpuCommandType> types;
+		for (auto& command : device.GetCommands()) {
+			types.push_back(command.type);
+		}
+		EXPECT_EQ(types, (std::vector<NullGpuCommandType> {
+			NullGpuCommandType::AcquireCommandBuffer,
+			NullGpuCommandType::MapTransferBuffer,
+			NullGpuCommandType::UnmapTransferBuffer,
+			NullGpuCommandType::Upload,
+			NullGpuCommandType::Upload,
+			NullGpuCommandType::Submit
+		}));
+		auto& upload = device.GetCommands()[4];
+		EXPECT_EQ(upload.destination, buffer.Handle());
+		EXPECT_EQ(upload.destinationOffset, 48u);
+		EXPECT_EQ(upload.size, 16u);
+		EXPECT_STREQ(NullGpuCommandTypeName(upload.type), "Upload");
+		
+		TransferBuffer transferBuffer(&device);
+		transferBuffer.Create(TransferBufferUsage::Upload, 32);
+		EXPECT_NE(transferBuffer.Lock(), nullptr);
+		transferBuffer.Unlock();
+		EXPECT_EQ(device.GetObjectCount(), 3u);
+	}
+	EXPECT_EQ(device.GetObjectCount(), 0u);
+}
+
+TEST(ShaderReflection, Parse) {
+	ShaderReflection reflection;
+	ASSERT_TRUE(ShaderReflectionParse(R"({ "samplers": 1, "storage_textures": 0, "storage_buffers": 2, "uniform_buffers": 1,
+		"inputs": [{ "name": "in.var.TEXCOORD0", "type": "float2", "location": 0 }, { "name": "in.var.TEXCOORD1", "type": "float4", "location": 1 }],
+		"outputs": [{ "name": "out.var.SV_Target0", "type": "float4", "location": 0 }], "extra": { "list": [1, -2.5e3, true, null, "\"x\""] } })", &reflection));
+	EXPECT_EQ(reflection.samplers, 1u);
+	EXPECT_EQ(reflection.storageTextures, 0u);
+	EXPECT_EQ(reflection.storageBuffers, 2u);
+	EXPECT_EQ(reflection.uniformBuffers, 1u);
+	ASSERT_EQ(reflection.inputs.size(), 2u);
+	EXPECT_EQ(reflection.inputs[1].name, "in.var.TEXCOORD1");
+	EXPECT_EQ(reflection.inputs[1].type, "float4");
+	EXPECT_EQ(reflection.inputs[1].location, 1u);
+	ASSERT_EQ(reflection.outputs.size(), 1u);
+	EXPECT_EQ(reflection.outputs[0].name, "out.var.SV_Target0");
+	
+	ASSERT_TRUE(ShaderReflectionParse(R"({"samplers":0,"inputs":[],"outputs":[]})", &reflection));
+	EXPECT_TRUE(reflection.inputs.empty());
+	
+	EXPECT_FALSE(ShaderReflectionParse("", &reflection));
+	EXPECT_FALSE(ShaderReflectionParse(R"({ "samplers": -1 })", &reflection));
+	EXPECT_FALSE(ShaderReflectionParse(R"({ "samplers": 1, })", &reflection));
+	EXPECT_FALSE(ShaderReflectionParse(R"({ "inputs": [{ "location": 0 } })", &reflection));
+	EXPECT_FALSE(ShaderReflectionParse(R"({ "samplers": 1 } x)", &reflection));
+	
+	EXPECT_EQ(ShaderFormatSelect(ShaderFormat::MetalLib), ShaderFormat::MetalLib);
+	EXPECT_EQ(ShaderFormatSelect(ShaderFormat::Dxil | ShaderFormat::SpirV), ShaderFormat::SpirV);
+	EXPECT_EQ(ShaderFormatSelect(ShaderFormat::None), ShaderFormat::None);
+	EXPECT_STREQ(ShaderFormatExtension(ShaderFormat::MetalLib), "air");
+}
+
+TEST(PipelineCache, SharedPipelines) {
+	NullGpuDevice device;
+	{
+		PipelineCache cache(device);
+		EXPECT_EQ(cache.GetShaderFormat(), ShaderFormat::SpirV);
+		
+		const char code[] = "code";
+		auto vertexShader = cache.AddShader("PositionColor.vert", R"({ "samplers": 0, "storage_textures": 0, "storage_buffers": 0, "uniform_buffers": 1,
+			"inputs": [{ "name": "in.var.TEXCOORD0", "type": "float3", "location": 0 }, { "name": "in.var.TEXCOORD1", "type": "float4", "location": 1 }],
+			"outputs": [{ "name": "out.var.TEXCOORD0", "type": "float4", "location": 0 }] })", code, sizeof(code));
+		auto fragmentShader = cache.AddShader("SolidColor.frag", R"({ "samplers": 0, "storage_textures": 0, "storage_buffers": 0, "uniform_buffers": 0,
+			"inputs": [{ "name": "in.var.TEXCOORD0", "type": "float4", "location": 0 }], "outputs": [] })", code, sizeof(code));
+		ASSERT_NE(vertexShader, nullptr);
+		ASSERT_NE(fragmentShader, nullptr);
+		EXPECT_EQ(cache.AddShader("SolidColor.frag", "{}", code, sizeof(code)), fragmentShader);
+		EXPECT_EQ(cache.AddShader("Broken.frag", "{", code, sizeof(code)), nullptr);
+		EXPECT_EQ(cache.LoadShader("Missing.frag"), nullptr);
+		EXPECT_EQ(cache.GetShaderCount(), 2u);
+		ASSERT_NE(cache.GetReflection(vertexShader), nullptr);
+		EXPECT_EQ(cache.GetReflection(vertexShader)->uniformBuffers, 1u);
+		
+		auto makeState = [&](BlendMode blendMode) {
+			PipelineState state;
+			state.vertexShader = vertexShader;
+			state.fragmentShader = fragmentShader;
+			state.colorTargetFormat = 9;
+			state.primitiveType = PrimitiveType::LineList;
+			state.blendMode = blendMode;
+			state.vertexBufferCount = 2;
+			state.vertexBuffers[0] = {.pitch = 12, .slot = 0};
+			state.vertexBuffers[1] = {.pitch = 4, .slot = 1};
+			state.vertexAttributeCount = 2;
+			state.vertexAttributes[0] = {.offset = 0, .location = 0, .bufferSlot = 0, .format = VertexElementFormat::Float3};
+			state.vertexAttributes[1] = {.offset = 0, .location = 1, .bufferSlot = 1, .format = VertexElementFormat::UByte4Norm};
+			return state;
+		};
+		
+		device.ClearCommands();
+		
+		// Materials with equal states share the pipeline
+		auto pipeline = cache.GetPipeline(makeState(BlendMode::PremultipliedAlpha));
+		ASSERT_NE(pipeline, nullptr);
+		EXPECT_EQ(PipelineStateHash(makeState(BlendMode::PremultipliedAlpha)), PipelineStateHash(makeState(BlendMode::PremultipliedAlpha)));
+		for (int i = 0; i < 10; ++i) {
+			EXPECT_EQ(cache.GetPipeline(makeState(BlendMode::PremultipliedAlpha)), pipeline);
+		}
+		auto additive = cache.GetPipeline(makeState(BlendMode::Additive));
+		EXPECT_NE(additive, nullptr);
+		EXPECT_NE(additive, pipeline);
+		EXPECT_EQ(cache.GetPipelineCount(), 2u);
+		
+		auto creates = std::count_if(device.GetCommands().begin(), device.GetCommands().end(),
+			[](auto& command) { return command.type == NullGpuCommandType::CreateGraphicsPipeline; });
+		EXPECT_EQ(creates, 2);
+		EXPECT_EQ(device.GetObjectCount(), 4u);
+	}
+	EXPECT_EQ(device.GetObjectCount(), 0u);
+}
+
+TEST(SpriteInstanceBuffer, DirtyRanges) {
+	auto scene = std::make_unique<Scene>();
+	int texture;
+	std::vector<SpriteComponent*> sprites;
+	for (int i = 0; i < 100; ++i) {
+		sprites.push_back(AddSprite(scene->GetRootObject(), &texture, static_cast<float>(i)));
+	}
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	MockUploadDevice device;
+	UploadManager uploads(device, 1024);
+	SpriteInstance gpuBuffer[100] = {};
+	
+	SpriteInstanceBuffer buffer;
+	auto update = [&]() {
+		Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+		buffer.Update(scene->GetRootObject());
+		auto ranges = buffer.GetDirtyRanges();
+		uploads.BeginFrame();
+		buffer.Upload(uploads, gpuBuffer);
+		uploads.EndFrame(nullptr);
+		return ranges;
+	};
+	
+	auto ranges = update();
+	ASSERT_EQ(ranges.size(), 1u);
+	EXPECT_EQ(ranges[0].count, 100u);
+	EXPECT_EQ(buffer.GetBatches().size(), 1u);
+	EXPECT_FLOAT_EQ(gpuBuffer[99].transform.tx, 99);
+	
+	// Nothing changed, nothing to upload
+	auto regionCount = device.regionCount;
+	EXPECT_TRUE(update().empty());
+	EXPECT_EQ(device.regionCount, regionCount);
+	
+	// Moved and recolored sprites, near ones share a range
+	auto object = scene->GetRootObject().FirstChild();
+	for (int i = 0; i < 10; ++i) {
+		object = object.NextSibling();
+	}
+	object.FindComponent<Transform2DComponent>()->localTransform.ty = 5;
+	object.FindComponent<Transform2DComponent>()->MarkDirty();
+	sprites[14]->color = FloatColorMakeBlack();
+	sprites[14]->MarkDirty();
+	sprites[50]->pivot = Vector2MakeZero();
+	sprites[50]->MarkDirty();
+	
+	ranges = update();
+	ASSERT_EQ(ranges.size(), 2u);
+	EXPECT_EQ(ranges[0].first, 10u);
+	EXPECT_EQ(ranges[0].count, 5u);
+	EXPECT_EQ(ranges[1].first, 50u);
+	EXPECT_EQ(ranges[1].count, 1u);
+	EXPECT_FLOAT_EQ(gpuBuffer[10].transform.ty, 5);
+	EXPECT_FLOAT_EQ(gpuBuffer[14].color.r, 0);
+	EXPECT_FLOAT_EQ(gpuBuffer[50].pivotX, 0);
+	
+	// Hiding a sprite shifts the following ones
+	sprites[90]->visible = false;
+	ranges = update();
+	ASSERT_EQ(ranges.size(), 1u);
+	EXPECT_EQ(ranges[0].first, 90u);
+	EXPECT_EQ(ranges[0].count, 9u);
+	EXPECT_EQ(buffer.GetInstances().size(), 99u);
+	EXPECT_FLOAT_EQ(gpuBuffer[90].transform.tx, 91);
+	
+	buffer.Invalidate();
+	ranges = update();
+	ASSERT_EQ(ranges.size(), 1u);
+	EXPECT_EQ(ranges[0].count, 99u);
+}
+
+TEST(SpriteBatcher, ParallelUpload) {
+	auto scene = std::make_unique<Scene>();
+	int textures[3];
+	for (int i = 0; i < 5000; ++i) {
+		auto sprite = AddSprite(scene->GetRootObject(), &textures[i / 700 % 3], static_cast<float>(i));
+		sprite->color = FloatColorMake(static_cast<float>(i % 256) / 255, 0, 0, 1);
+	}
+	Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	SpriteBatcher serial;
+	serial.Build(scene->GetRootObject());
+	
+	SpriteBatcher parallel;
+	parallel.Gather(scene->GetRootObject());
+	EXPECT_EQ(parallel.Size(), 5000u);
+	EXPECT_TRUE(parallel.GetInstances().empty());
+	EXPECT_EQ(parallel.GetBatches().size(), serial.GetBatches().size());
+	
+	ThreadPool pool(3);
+	std::vector<SpriteInstance> instances(parallel.Size());
+	parallel.Write(instances.data(), &pool);
+	EXPECT_EQ(std::memcmp(instances.data(), serial.GetInstances().data(), instances.size() * sizeof(SpriteInstance)), 0);
+	
+	// Chunks allocate from the ring on work threads, the ring grows once before them
+	MockUploadDevice device;
+	{
+		UploadManager uploads(device, 1024);
+		std::vector<SpriteInstance> buffer(parallel.Size() + 1);
+		
+		uploads.BeginFrame();
+		parallel.Upload(uploads, buffer.data(), sizeof(SpriteInstance), &pool);
+		EXPECT_EQ(device.transferBuffers.size(), 2u);
+		EXPECT_LE(uploads.GetPendingRegionCount(), (parallel.Size() + SpriteBatcher::kChunkSize - 1) / SpriteBatcher::kChunkSize);
+		uploads.EndFrame(nullptr);
+		
+		EXPECT_EQ(std::memcmp(buffer.data() + 1, serial.GetInstances().data(), parallel.Size() * sizeof(SpriteInstance)), 0);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+TEST(RenderQueue, Sort) {
+	int objects[4];
+	RenderQueue queue;
+	auto p0 = queue.RegisterPipeline(&objects[0]);
+	auto p1 = queue.RegisterPipeline(&objects[1]);
+	auto t0 = queue.RegisterTexture(&objects[2]);
+	auto t1 = queue.RegisterTexture(&objects[3]);
+	auto s0 = queue.RegisterSampler(&objects[0]);
+	EXPECT_EQ(queue.RegisterPipeline(&objects[1]), p1);
+	
+	// Opaque items of layer 0 sort by state, blended items of layer 1 keep their order
+	queue.Add(RenderKeyMakeBlended(1, 0, p0, t1, s0), 100, 1);
+	queue.Add(RenderKeyMakeOpaque(0, p1, t0, s0, 5), 0, 10);
+	queue.Add(RenderKeyMakeBlended(1, 1, p0, t0, s0), 101, 1);
+	queue.Add(RenderKeyMakeOpaque(0, p0, t1, s0, 1), 20, 5);
+	queue.Add(RenderKeyMakeOpaque(0, p1, t0, s0, 7), 10, 10);
+	queue.Add(RenderKeyMakeBlended(1, 2, p0, t0, s0), 102, 1);
+	queue.Add(RenderKeyMakeOpaque(0, p0, t0, s0, 9), 30, 5);
+	queue.Sort();
+	
+	EXPECT_EQ(queue.GetSortedItems(), (std::vector<uint32_t>{6, 3, 1, 4, 0, 2, 5}));
+	
+	// Same state and adjacent instances make one draw
+	auto& draws = queue.GetDraws();
+	ASSERT_EQ(draws.size(), 5u);
+	EXPECT_EQ(draws[0].pipeline, &objects[0]);
+	EXPECT_EQ(draws[0].binds, RenderBind::Pipeline | RenderBind::Texture | RenderBind::Sampler);
+	EXPECT_EQ(draws[1].texture, &objects[3]);
+	EXPECT_EQ(draws[1].binds, RenderBind::Texture);
+	EXPECT_EQ(draws[2].binds, RenderBind::Pipeline | RenderBind::Texture);
+	EXPECT_EQ(draws[2].firstInstance, 0u);
+	EXPECT_EQ(draws[2].instanceCount, 20u);
+	EXPECT_EQ(draws[3].binds, RenderBind::Pipeline | RenderBind::Texture);
+	EXPECT_EQ(draws[4].binds, RenderBind::Texture);
+	EXPECT_EQ(draws[4].firstInstance, 101u);
+	EXPECT_EQ(draws[4].instanceCount, 2u);
+	
+	// Far depth keeps within its bits
+	EXPECT_EQ(RenderKeyQuantizeDepth(0.0f), 0u);
+	EXPECT_EQ(RenderKeyQuantizeDepth(1.0f), kRenderKeyMaxDepth);
+	EXPECT_LT(RenderKeyQuantizeDepth(std::nextafter(1.0f, 0.0f)), kRenderKeyMaxDepth);
+	EXPECT_EQ(RenderKeyQuantizeDepth(2.0f), kRenderKeyMaxDepth);
+	EXPECT_EQ(RenderKeyQuantizeDepth(-1.0f), 0u);
+	EXPECT_EQ(RenderKeyQuantizeDepth(std::numeric_limits<float>::quiet_NaN()), 0u);
+	auto farOpaque = RenderKeyMakeOpaque(0, p1, t1, s0, RenderKeyQuantizeDepth(1.0f));
+	EXPECT_EQ(RenderKeyGetSampler(farOpaque), s0);
+	EXPECT_EQ(RenderKeyGetTexture(farOpaque), t1);
+	auto farBlended = RenderKeyMakeBlended(1, RenderKeyQuantizeDepth(1.0f), p0, t0, s0);
+	EXPECT_GT(farBlended, RenderKeyMakeBlended(1, RenderKeyQuantizeDepth(0.5f), p1, t1, s0));
+	EXPECT_EQ(RenderKeyGetLayer(farBlended), 1);
+	
+	// Radix sort of many items is stable like the comparison sort
+	queue.Clear();
+	std::vector<RenderSortKey> keys;
+	Random random;
+	for (uint32_t i = 0; i < 5000; ++i) {
+		auto seed = random.Next();
+		keys.push_back(RenderKeyMakeOpaque(static_cast<uint8_t>(seed >> 30), seed >> 26 & 7, seed >> 20 & 31, 0, seed >> 16 & 3));
+		queue.Add(keys.back(), i, 1);
+	}
+	queue.Sort();
+	
+	std::vector<uint32_t> expected(keys.size());
+	std::iota(expected.begin(), expected.end(), 0u);
+	std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+	EXPECT_EQ(queue.GetSortedItems(), expected);
+	
+	size_t instances = 0;
+	for (auto& draw : queue.GetDraws()) {
+		instances += draw.instanceCount;
+	}
+	EXPECT_EQ(instances, keys.size());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+TEST(FloatUtils, Half) {
+	EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+	EXPECT_EQ(FloatToHalf(-0.0f), 0x8000);
+	EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+	EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+	EXPECT_EQ(FloatToHalf(65504.0f), 0x7bff);
+	EXPECT_EQ(FloatToHalf(70000.0f), 0x7c00);
+	EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::infinity()), 0x7c00);
+	EXPECT_EQ(FloatToHalf(5.9604645e-8f), 0x0001);
+	// Ties round to even
+	EXPECT_EQ(FloatToHalf(1.0f + 1.0f / 2048), 0x3c00);
+	EXPECT_EQ(FloatToHalf(1.0f + 3.0f / 2048), 0x3c02);
+	
+	for (uint32_t h = 0; h < 0x7c00; ++h) {
+		auto half = static_cast<uint16_t>(h);
+		EXPECT_EQ(FloatToHalf(HalfToFloat(half)), half);
+		EXPECT_EQ(FloatToHalf(-HalfToFloat(half)), half | 0x8000);
+	}
+}
+
+TEST(PackedSpriteInstance, RoundTrip) {
+	std::vector<SpriteInstance> instances;
+	Random random;
+	for (int i = 0; i < 1000; ++i) {
+		auto size = random.NextFloat(1, 512);
+		auto rad = random.NextFloat(-3, 3);
+		instances.push_back(SpriteInstance {
+			.transform = Matrix32Multiply(Matrix32MakeScale(size, size * 0.5f), Matrix32MakeRotation(rad)),
+			.pivotX = random.NextFloat(0, 1),
+			.pivotY = random.NextFloat(0, 1),
+			.color = FloatColorMake(random.NextFloat(0, 1), random.NextFloat(0, 1), random.NextFloat(0, 1), random.NextFloat(-0.5f, 1.5f)),
+			.texU = static_cast<float>(i % 8) / 8,
+			.texV = 0.5f,
+			.texW = 0.125f,
+			.texH = 0.5f
+		});
+		instances.back().transform.tx = random.NextFloat(-4000, 4000);
+		instances.back().transform.ty = random.NextFloat(-4000, 4000);
+	}
+	
+	std::vector<PackedSpriteInstance> packed(instances.size());
+	SpriteRectTable rects;
+	SpriteInstancePack(instances.data(), packed.data(), instances.size(), rects);
+	EXPECT_EQ(rects.GetRects().size(), 8u);
+	
+	for (size_t i = 0; i < instances.size(); ++i) {
+		auto& expected = instances[i];
+		auto actual = SpriteInstanceUnpack(packed[i], rects);
+		
+		// Half floats keep 11 significant bits
+		auto& m = expected.transform;
+		EXPECT_NEAR(actual.transform.a, m.a, std::abs(m.a) / 2048);
+		EXPECT_NEAR(actual.transform.b, m.b, std::abs(m.b) / 2048);
+		EXPECT_NEAR(actual.transform.c, m.c, std::abs(m.c) / 2048);
+		EXPECT_NEAR(actual.transform.d, m.d, std::abs(m.d) / 2048);
+		EXPECT_EQ(actual.transform.tx, m.tx);
+		EXPECT_EQ(actual.transform.ty, m.ty);
+		
+		EXPECT_NEAR(actual.pivotX, expected.pivotX, 0.5f / 255);
+		EXPECT_NEAR(actual.pivotY, expected.pivotY, 0.5f / 255);
+		EXPECT_NEAR(actual.color.r, expected.color.r, 0.5f / 255);
+		EXPECT_NEAR(actual.color.a, Clamp(expected.color.a, 0, 1), 0.5f / 255);
+		EXPECT_EQ(actual.texU, expected.texU);
+		EXPECT_EQ(actual.texH, expected.texH);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static bool AtlasRectsOverlap(const AtlasRect& r1, const AtlasRect& r2) {
+	return r1.x < r2.x + r2.width && r2.x < r1.x + r1.width && r1.y < r2.y + r2.height && r2.y < r1.y + r1.height;
+}
+
+TEST(SkylinePacker, InsertFree) {
+	constexpr uint32_t kSize = 512;
+	SkylinePacker packer(kSize, kSize);
+	
+	Random random;
+	
+	std::vector<AtlasRect> rects;
+	auto check = [&rects, &packer] {
+		uint64_t area = 0;
+		for (size_t i = 0; i < rects.size(); ++i) {
+			auto& r = rects[i];
+			EXPECT_LE(r.x + r.width, packer.GetWidth());
+			EXPECT_LE(r.y + r.height, packer.GetHeight());
+			for (size_t j = 0; j < i; ++j) {
+				EXPECT_FALSE(AtlasRectsOverlap(r, rects[j]));
+			}
+			area += uint64_t{r.width} * r.height;
+		}
+		EXPECT_EQ(packer.GetUsedArea(), area);
+	};
+	
+	AtlasRect rect;
+	while (packer.Insert(random.NextUint(4, 40), random.NextUint(4, 40), &rect)) {
+		rects.push_back(rect);
+	}
+	check();
+	EXPECT_GT(packer.GetOccupancy(), 0.75f);
+	
+	// Freed space is reused by rectangles of other sizes
+	for (size_t i = 0; i < rects.size(); i += 2) {
+		packer.Free(rects[i]);
+	}
+	std::erase_if(rects, [&rects](const AtlasRect& r) { return (&r - rects.data()) % 2 == 0; });
+	auto count = rects.size();
+	while (packer.Insert(random.NextUint(2, 20), random.NextUint(2, 20), &rect)) {
+		rects.push_back(rect);
+	}
+	check();
+	EXPECT_GT(rects.size(), count * 3 / 2);
+	
+	// Everything freed leaves the whole page
+	for (auto& r : rects) {
+		packer.Free(r);
+	}
+	EXPECT_EQ(packer.GetUsedArea(), 0u);
+	EXPECT_TRUE(packer.Insert(kSize, kSize, &rect));
+}
+
+TEST(TextureAtlas, InsertRemove) {
+	TextureAtlas atlas(64, 1, 2);
+	
+	std::vector<Color> image(16 * 8);
+	for (uint32_t i = 0; i < image.size(); ++i) {
+		image[i] = ColorMake(static_cast<uint8_t>(i % 16), static_cast<uint8_t>(i / 16), 0, 255);
+	}
+	
+	auto region = atlas.Insert(image.data(), 16, 8);
+	ASSERT_NE(region, TextureAtlas::kInvalidRegion);
+	EXPECT_EQ(atlas.GetPageCount(), 1u);
+	
+	// Image is copied with its edges repeated in the padding
+	auto& rect = atlas.GetRect(region);
+	auto pixels = atlas.GetPagePixels(0);
+	auto texel = [pixels](uint32_t x, uint32_t y) { return pixels[y * 64 + x].value; };
+	EXPECT_EQ(texel(rect.x + 3, rect.y + 5), image[5 * 16 + 3].value);
+	EXPECT_EQ(texel(rect.x - 1, rect.y - 1), image[0].value);
+	EXPECT_EQ(texel(rect.x + 16, rect.y + 8), image[7 * 16 + 15].value);
+	EXPECT_EQ(texel(rect.x + 15, rect.y + 8), image[7 * 16 + 15].value);
+	
+	auto& dirtyRect = atlas.GetDirtyRect(0);
+	EXPECT_EQ(dirtyRect.x, rect.x - 1);
+	EXPECT_EQ(dirtyRect.width, 18u);
+	EXPECT_EQ(dirtyRect.height, 10u);
+	atlas.ClearDirtyRects();
+	EXPECT_EQ(atlas.GetDirtyRect(0).width, 0u);
+	
+	auto uv = atlas.GetTextureRect(region);
+	EXPECT_FLOAT_EQ(uv.min.x, static_cast<float>(rect.x) / 64);
+	EXPECT_FLOAT_EQ(uv.max.y - uv.min.y, 8.0f / 64);
+	
+	// Images too large for a page or for the pages left are rejected
+	std::vector<Color> large(63 * 63);
+	EXPECT_EQ(atlas.Insert(large.data(), 63, 63), TextureAtlas::kInvalidRegion);
+	auto large1 = atlas.Insert(large.data(), 62, 56);
+	EXPECT_EQ(atlas.GetPage(large1), 1u);
+	EXPECT_EQ(atlas.Insert(large.data(), 62, 56), TextureAtlas::kInvalidRegion);
+	
+	// Removing the last region resets the page
+	atlas.Remove(large1);
+	auto large2 = atlas.Insert(large.data(), 62, 56);
+	EXPECT_EQ(atlas.GetPage(large2), 1u);
+	EXPECT_EQ(large2, large1);
+	
+	atlas.Remove(region);
+	atlas.Remove(large2);
+	EXPECT_EQ(atlas.Size(), 0u);
+	EXPECT_EQ(atlas.GetPageOccupancy(0), 0.0f);
+}
+
+TEST(MipChain, Levels) {
+	std::vector<Color> pixels(5 * 3, ColorMakeWhite());
+	MipChain chain;
+	ASSERT_TRUE(chain.Build(pixels.data(), 5, 3));
+	ASSERT_EQ(chain.GetLevelCount(), 1u);
+	EXPECT_EQ(chain.GetSize(), 60u);
+	
+	ASSERT_TRUE(chain.Build(pixels.data(), 5, 3, {.mipmaps = true}));
+	ASSERT_EQ(chain.GetLevelCount(), 3u);
+	EXPECT_EQ(MipLevelCount(5, 3), 3u);
+	EXPECT_EQ(MipLevelCount(256, 1), 9u);
+	auto& level1 = chain.GetLevel(1);
+	EXPECT_EQ(level1.width, 2u);
+	EXPECT_EQ(level1.height, 1u);
+	EXPECT_EQ(level1.offset, 60u);
+	EXPECT_EQ(chain.GetLevel(2).offset, 68u);
+	EXPECT_EQ(chain.GetLevel(2).width, 1u);
+	EXPECT_EQ(chain.GetSize(), 72u);
+	Color last;
+	std::memcpy(&last, chain.GetLevelData(2), sizeof(last));
+	EXPECT_EQ(last.value, ColorMakeWhite().value);
+	
+	EXPECT_FALSE(chain.Build(pixels.data(), 0, 3));
+	EXPECT_EQ(chain.GetLevelCount(), 0u);
+}
+
+TEST(MipChain, Filter) {
+	auto level1 = [](const std::vector<Color>& pixels, uint32_t width, uint32_t height, const MipChainOptions& options) {
+		MipChain chain;
+		chain.Build(pixels.data(), width, height, options);
+		Color color;
+		std::memcpy(&color, chain.GetLevelData(1), sizeof(color));
+		return color;
+	};
+	
+	// Average of black and white is half of the light, which is brighter than the half of sRGB codes
+	std::vector<Color> checker = {ColorMakeBlack(), ColorMakeWhite(), ColorMakeWhite(), ColorMakeBlack()};
+	auto gray = level1(checker, 2, 2, {.mipmaps = true});
+	EXPECT_EQ(gray.rgba.r, 188);
+	EXPECT_EQ(gray.rgba.g, 188);
+	EXPECT_EQ(gray.rgba.a, 255);
+	EXPECT_EQ(level1(checker, 2, 2, {.mipmaps = true, .srgb = false}).rgba.r, 128);
+	
+	// Every code survives the round trip through linear space
+	std::vector<Color> ramp;
+	for (int i = 0; i < 256; ++i) {
+		auto code = static_cast<uint8_t>(i);
+		ramp.push_back(ColorMake(code, code, code, 255));
+		ramp.push_back(ColorMake(code, code, code, 255));
+	}
+	MipChain rampChain;
+	rampChain.Build(ramp.data(), 512, 1, {.mipmaps = true});
+	std::vector<Color> halved(256);
+	std::memcpy(halved.data(), rampChain.GetLevelData(1), halved.size() * sizeof(Color));
+	for (int i = 0; i < 256; ++i) {
+		EXPECT_EQ(halved[static_cast<size_t>(i)].rgba.r, i);
+	}
+	
+	// Color of a transparent texel does not bleed into the edge
+	std::vector<Color> edge = {ColorMake(255, 0, 0, 255), ColorMake(0, 255, 0, 0)};
+	auto straight = level1(edge, 2, 1, {.mipmaps = true});
+	EXPECT_EQ(straight.value, ColorMake(255, 0, 0, 128).value);
+	auto premultiplied = level1(edge, 2, 1, {.mipmaps = true, .premultiplyAlpha = true});
+	EXPECT_EQ(premultiplied.value, ColorMake(128, 0, 0, 128).value);
+	
+	MipChain chain;
+	chain.Build(edge.data(), 2, 1, {.premultiplyAlpha = true});
+	Color first[2];
+	std::memcpy(first, chain.GetLevelData(0), sizeof(first));
+	EXPECT_EQ(first[0].value, ColorMake(255, 0, 0, 255).value);
+	EXPECT_EQ(first[1].value, ColorMakeZero().value);
+	
+	std::vector<Color> translucent = {ColorMake(255, 255, 255, 128), ColorMake(10, 20, 30, 255)};
+	EXPECT_FALSE(ImageIsOpaque(translucent.data(), translucent.size()));
+	EXPECT_TRUE(ImageIsOpaque(translucent.data() + 1, 1));
+	// Codes are premultiplied, half transparent white is half of the code
+	ImagePremultiplyAlpha(translucent.data(), translucent.size());
+	EXPECT_EQ(translucent[0].value, ColorMake(128, 128, 128, 128).value);
+	EXPECT_EQ(translucent[1].value, ColorMake(10, 20, 30, 255).value);
+}
+
+TEST(MipChain, Pack) {
+	std::vector<Color> pixels = {ColorMakeWhite(), ColorMake(255, 0, 0, 255), ColorMake(0, 255, 0, 0), ColorMake(0, 0, 255, 136)};
+	uint16_t words[4];
+	
+	MipChain chain;
+	ASSERT_TRUE(chain.Build(pixels.data(), 4, 1, {.format = PixelFormat::RGB565}));
+	EXPECT_EQ(chain.GetFormat(), PixelFormat::RGB565);
+	ASSERT_EQ(chain.GetSize(), sizeof(words));
+	std::memcpy(words, chain.GetData(), sizeof(words));
+	EXPECT_EQ(words[0], 0xffff);
+	EXPECT_EQ(words[1], 0xf800);
+	EXPECT_EQ(words[2], 0x07e0);
+	EXPECT_EQ(words[3], 0x001f);
+	
+	ASSERT_TRUE(chain.Build(pixels.data(), 4, 1, {.mipmaps = true, .format = PixelFormat::RGBA4444}));
+	ASSERT_EQ(chain.GetLevelCount(), 3u);
+	EXPECT_EQ(chain.GetLevel(1).size, 4u);
+	std::memcpy(words, chain.GetData(), sizeof(words));
+	EXPECT_EQ(words[0], 0xffff);
+	EXPECT_EQ(words[1], 0xff00);
+	EXPECT_EQ(words[2], 0x00f0);
+	EXPECT_EQ(words[3], 0x800f);
+	
+	// 16-bit formats premultiply the codes as well
+	ASSERT_TRUE(chain.Build(pixels.data(), 4, 1, {.premultiplyAlpha = true, .format = PixelFormat::RGBA4444}));
+	std::memcpy(words, chain.GetData(), sizeof(words));
+	EXPECT_EQ(words[2], 0x0000);
+	EXPECT_EQ(words[3], 0x8008);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static std::vector<SceneObject> QueryRect(SpatialGrid2D& grid, const Rect& r) {
+	std::vector<SceneObject> objects;
+	grid.QueryRect(r, [&objects](SceneObject sceneObject, bool&) { objects.push_back(sceneObject); });
+	return SortedObjects(objects);
+}
+
+TEST(SpatialGrid2D, Query) {
+	auto scene = std::make_unique<Scene>();
+	std::vector<SceneObject> objects;
+	for (int i = 0; i < 5; ++i) {
+		objects.push_back(scene->AddObject());
+	}
+	auto object = [&objects](size_t i) { return objects[i]; };
+	
+	SpatialGrid2D grid{10};
+	auto small = grid.Insert(object(0), RectMakeWithOriginAndSize(1, 1, 2, 2));
+	auto spanning = grid.Insert(object(1), RectMakeWithOriginAndSize(5, 5, 10, 10));
+	auto huge = grid.Insert(object(2), RectMakeWithOriginAndSize(-1000, -1000, 2000, 2000));
+	auto empty = grid.Insert(object(3), RectMakeEmpty());
+	EXPECT_EQ(grid.Size(), 4u);
+	
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(0, 0, 20, 20)), SortedObjects({object(0), object(1), object(2)}));
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(12, 12, 1, 1)), SortedObjects({object(1), object(2)}));
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(2000, 0, 1, 1)), std::vector<SceneObject>{});
+	
+	std::vector<SceneObject> hits;
+	grid.QueryPoint(Vector2Make(2, 2), [&hits](SceneObject sceneObject, bool&) { hits.push_back(sceneObject); });
+	EXPECT_EQ(SortedObjects(hits), SortedObjects({object(0), object(2)}));
+	
+	// Stops on the first hit
+	hits.clear();
+	EXPECT_TRUE(grid.QueryPoint(Vector2Make(6, 6), [&hits](SceneObject sceneObject, bool& stop) {
+		hits.push_back(sceneObject);
+		stop = true;
+	}));
+	EXPECT_EQ(hits.size(), 1u);
+	
+	// Moves within the same cell and across cells
+	grid.Update(small, RectMakeWithOriginAndSize(2, 2, 2, 2));
+	grid.Update(spanning, RectMakeWithOriginAndSize(105, 105, 10, 10));
+	grid.Update(empty, RectMakeWithOriginAndSize(3, 3, 1, 1));
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(0, 0, 20, 20)), SortedObjects({object(0), object(2), object(3)}));
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(100, 100, 20, 20)), SortedObjects({object(1), object(2)}));
+	
+	grid.Remove(huge);
+	grid.Remove(small);
+	EXPECT_EQ(grid.Size(), 2u);
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(-5000, -5000, 10000, 10000)), SortedObjects({object(1), object(3)}));
+	
+	// Freed proxies are reused
+	EXPECT_EQ(grid.Insert(object(4), RectMakeWithOriginAndSize(0, 0, 1, 1)), small);
+}
+
+TEST(SpatialGrid2D, EmptyCells) {
+	auto scene = std::make_unique<Scene>();
+	SpatialGrid2D grid{10};
+	auto proxy = grid.Insert(scene->AddObject(), RectMakeWithOriginAndSize(1, 1, 2, 2));
+	
+	// Cells left by moving objects are kept until compacted
+	grid.Update(proxy, RectMakeWithOriginAndSize(11, 1, 2, 2));
+	grid.Update(proxy, RectMakeWithOriginAndSize(1, 1, 2, 2));
+	EXPECT_EQ(grid.GetCellCount(), 2u);
+	grid.Compact();
+	EXPECT_EQ(grid.GetCellCount(), 1u);
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(0, 0, 5, 5)).size(), 1u);
+	
+	// Empty cells are pruned when they outnumber occupied ones
+	for (int i = 0; i < 10000; ++i) {
+		grid.Update(proxy, RectMakeWithOriginAndSize(static_cast<float>(i * 10 + 1), 1, 2, 2));
+	}
+	EXPECT_LE(grid.GetCellCount(), SpatialGrid2D::kMinPrunedCells + 1);
+	EXPECT_EQ(QueryRect(grid, RectMakeWithOriginAndSize(99991, 0, 5, 5)).size(), 1u);
+}
+
+TEST(Scene, QuerySpatialIndex) {
+	auto scene = std::make_unique<Scene>();
+	auto unit = RectMakeWithOriginAndSize(0, 0, 10, 10);
+	
+	auto a = AddBounds2D(scene->GetRootObject(), unit, 100, 0);
+	auto b = AddBounds2D(a, unit, 500, 500);
+	auto c = AddBounds2D(scene->GetRootObject(), unit, 0, 0);
+	
+	ComponentMessageParams params;
+	scene->GetRootObject().BroadcastMessage(ComponentMessages::Apply, params);
+	Bounds2DComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	SceneObject hit;
+	scene->QueryPoint(Vector2Make(605, 505), [&hit](SceneObject sceneObject, bool&) { hit = sceneObject; });
+	EXPECT_EQ(hit, b);
+	
+	// Moving parent moves the child in the index
+	a.FindComponent<Transform2DComponent>()->localTransform.tx = 0;
+	scene->GetRootObject().BroadcastMessage(ComponentMessages::Apply, params);
+	Bounds2DComponent::UpdateHierarchy(scene->GetRootObject());
+	
+	std::vector<SceneObject> objects;
+	scene->QueryRect(RectMakeWithOriginAndSize(0, 0, 20, 20), [&objects](SceneObject sceneObject, bool&) { objects.push_back(sceneObject); });
+	EXPECT_EQ(SortedObjects(objects), SortedObjects({a, c}));
+	
+	hit = SceneObject{};
+	scene->QueryPoint(Vector2Make(505, 505), [&hit](SceneObject sceneObject, bool&) { hit = sceneObject; });
+	EXPECT_EQ(hit, b);
+	
+	c.RemoveFromParent();
+	EXPECT_EQ(scene->GetSpatialIndex2D().Size(), 2u);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static std::vector<SceneObject> Brute(const std::vector<SceneObject>& objects, const std::vector<AABB>& boxes, auto&& predicate) {
+	std::vector<SceneObject> out;
+	for (size_t i = 0; i < objects.size(); ++i) {
+		if (predicate(boxes[i])) {
+			out.push_back(objects[i]);
+		}
+	}
+	return SortedObjects(out);
+}
+
+TEST(BoundingVolumeHierarchy, Query) {
+	constexpr size_t kCount = 500;
+	
+	auto scene = std::make_unique<Scene>();
+	CullingObjects random{kCount * 2};
+	
+	std::vector<SceneObject> objects;
+	std::vector<AABB> boxes;
+	BoundingVolumeHierarchy bvh;
+	std::vector<BoundingVolumeHierarchy::ProxyId> proxies;
+	for (size_t i = 0; i < kCount; ++i) {
+		objects.push_back(scene->AddObject());
+		boxes.push_back(random.GetAABB(i));
+		proxies.push_back(bvh.Insert(objects.back(), boxes.back()));
+	}
+	
+	auto check = [&] {
+		auto frustum = TestFrustum(0.3f);
+		std::vector<SceneObject> found;
+		bvh.QueryFrustum(frustum, [&found](SceneObject sceneObject, bool&) { found.push_back(sceneObject); });
+		EXPECT_EQ(SortedObjects(found), Brute(objects, boxes, [&frustum](const AABB& b) { return !FrustumCullAABB(frustum, b); }));
+		
+		auto sphere = SphereMake(Vector3Make(10, -20, 30), 25);
+		found.clear();
+		bvh.QuerySphere(sphere, [&found](SceneObject sceneObject, bool&) { found.push_back(sceneObject); });
+		EXPECT_EQ(SortedObjects(found), Brute(objects, boxes, [&sphere](const AABB& b) {
+			auto closest = Vector3Min(Vector3Max(sphere.origin, b.min), b.max);
+			return Vector3Distance(closest, sphere.origin) <= sphere.radius;
+		}));
+		
+		// Ray along x axis through the middle of the cloud
+		auto origin = Vector3Make(-150, 2, -3);
+		found.clear();
+		bvh.RayCast(origin, Vector3Make(1, 0, 0), 200, [&](SceneObject sceneObject, float distance, bool&) {
+			found.push_back(sceneObject);
+			auto& b = boxes[static_cast<size_t>(std::find(objects.begin(), objects.end(), sceneObject) - objects.begin())];
+			EXPECT_NEAR(distance, b.min.x - origin.x, 1e-3f);
+		});
+		EXPECT_EQ(SortedObjects(found), Brute(objects, boxes, [](const AABB& b) {
+			return b.min.y <= 2 && b.max.y >= 2 && b.min.z <= -3 && b.max.z >= -3 && b.max.x >= -150 && b.min.x <= 50;
+		}));
+		EXPECT_FALSE(found.empty());
+	};
+	
+	check();
+	
+	// Move a part of boxes and refit
+	for (size_t i = 0; i < kCount; i += 7) {
+		boxes[i] = random.GetAABB(kCount + i);
+		bvh.Move(proxies[i], boxes[i]);
+	}
+	bvh.Refit();
+	check();
+	
+	// Removal swaps the last object into the place of removed one
+	for (size_t i = 0; i < kCount / 2; i += 3) {
+		bvh.Remove(proxies[i]);
+		proxies[i] = proxies.back();
+		objects[i] = objects.back();
+		boxes[i] = boxes.back();
+		proxies.pop_back();
+		objects.pop_back();
+		boxes.pop_back();
+	}
+	EXPECT_EQ(bvh.Size(), objects.size());
+	check();
+	
+	// Surface area heuristic build beats incremental insertion
+	auto cost = bvh.Cost();
+	bvh.Rebuild();
+	EXPECT_LT(bvh.Cost(), cost);
+	check();
+	
+	// Stops on the first hit
+	size_t hits = 0;
+	EXPECT_TRUE(bvh.QuerySphere(SphereMake(Vector3MakeZero(), 1000), [&hits](SceneObject, bool& stop) {
+		++hits;
+		stop = true;
+	}));
+	EXPECT_EQ(hits, 1u);
+}
+
+TEST(Scene, QueryFrustum) {
+	auto scene = std::make_unique<Scene>();
+	auto frustum = TestFrustum(0);
+	
+	CullingObjects random{300};
+	for (size_t i = 0; i < 30; ++i) {
+		auto group = scene->AddObject();
+		for (size_t k = 0; k < 10; ++k) {
+			group.AppendChild().AddComponent<BoundsComponent>()->localBounds = random.GetAABB(i * 10 + k);
+		}
+	}
+	BoundsComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_EQ(scene->GetSpatialIndex3D().Size(), 300u);
+	
+	std::vector<SceneObject> visible;
+	BoundsComponent::Cull(scene->GetRootObject(), frustum, visible);
+	
+	std::vector<SceneObject> found;
+	scene->QueryFrustum(frustum, [&found](SceneObject sceneObject, bool&) { found.push_back(sceneObject); });
+	EXPECT_EQ(SortedObjects(found), SortedObjects(visible));
+	
+	// Emptied bounds leave the index
+	scene->GetRootObject().FirstChild().FirstChild().FindComponent<BoundsComponent>()->localBounds = AABBMakeEmpty();
+	BoundsComponent::UpdateHierarchy(scene->GetRootObject());
+	EXPECT_EQ(scene->GetSpatialIndex3D().Size(), 299u);
+	
+	scene->GetRootObject().FirstChild().RemoveFromParent();
+	EXPECT_EQ(scene->GetSpatialIndex3D().Size(), 290u);
+}
@@ -126,9 +126,22 @@ bool QOILoader::EndLoad(uint8_t* pixels, uint32_t size, uint32_t channels) noexc
 #include <scenegraph/utils/ScopeGuard.h>
 #include <SDL3/SDL.h>
 
-SDL_GPUTexture* SDL_GPUTextureQOILoader::LoadFromFile(const char* filename) noexcept {
-	SDL_GPUTransferBuffer* transferBuffer;
-	
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr SDL_GPUTextureFormat GetTextureFormat(PixelFormat format) noexcept {
+	switch (format) {
+	case PixelFormat::RGBA8: return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+	case PixelFormat::RGB565: return SDL_GPU_TEXTUREFORMAT_B5G6R5_UNORM;
+	case PixelFormat::RGBA4444: return SDL_GPU_TEXTUREFORMAT_B4G4R4A4_UNORM;
+	}
+}
+
+} // namespace
+
+SDL_GPUTexture* SDL_GPUTextureQOILoader::LoadFromFile(const char* filename, const MipChainOptions& options) noexcept {
 	_width = 0;
 	_height = 0;
 	_channels = 0;
@@ -146,31 +159,48 @@ SDL_GPUTexture* SDL_GPUTextureQOILoader::LoadFromFile(const char* filename) noex
 			return nullptr;
 		}
 		
+		// Levels are built from the decoded image, then copied to the transfer buffer in one go
 		_channels = 4;
-		auto length = _width * _height * _channels;
-		
-		SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo = {
-			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-			.size = length
-		};
-		transferBuffer = SDL_CreateGPUTransferBuffer(_device, &transferBufferCreateInfo);
-		
-		auto pixels = static_cast<uint8_t*>(SDL_MapGPUTransferBuffer(_device, transferBuffer, false));
-		ON_SCOPE_EXIT(&transferBuffer, this) { SDL_UnmapGPUTransferBuffer(_device, transferBuffer); };
+		std::vector<Color> pixels(size_t{_width} * _height);
+		if (!EndLoad(reinterpret_cast<uint8_t*>(pixels.data()), _width * _height * _channels, _channels)) {
+			return nullptr;
+		}
 		
-		if (!EndLoad(pixels, length, _channels)) {
+		auto chainOptions = options;
+		if (!SDL_GPUTextureSupportsFormat(_device, GetTextureFormat(chainOptions.format), SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER)) {
+			chainOptions.format = PixelFormat::RGBA8;
+		}
+		if (!_mipChain.Build(pixels.data(), _width, _height, chainOptions)) {
 			return nullptr;
 		}
 	}
-
+	
+	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo = {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = static_cast<Uint32>(_mipChain.GetSize())
+	};
+	auto transferBuffer = SDL_CreateGPUTransferBuffer(_device, &transferBufferCreateInfo);
+	if (!transferBuffer) {
+		return nullptr;
+	}
+	
+	ON_SCOPE_EXIT(&transferBuffer, this) { SDL_ReleaseGPUTransferBuffer(_device, transferBuffer); };
+	
+	auto mapped = SDL_MapGPUTransferBuffer(_device, transferBuffer, false);
+	if (!mapped) {
+		return nullptr;
+	}
+	std::memcpy(mapped, _mipChain.GetData(), _mipChain.GetSize());
+	SDL_UnmapGPUTransferBuffer(_device, transferBuffer);
+	
 	SDL_GPUTextureCreateInfo textureCreateInfo = {
 		.type = SDL_GPU_TEXTURETYPE_2D,
-		.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+		.format = GetTextureFormat(_mipChain.GetFormat()),
+		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
 		.width = _width,
 		.height = _height,
 		.layer_count_or_depth = 1,
-		.num_levels = 1,
-		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER
+		.num_levels = static_cast<Uint32>(_mipChain.GetLevelCount())
 	};
 	auto texture = SDL_CreateGPUTexture(_device, &textureCreateInfo);
 	if (!texture) {
@@ -180,27 +210,24 @@ SDL_GPUTexture* SDL_GPUTextureQOILoader::LoadFromFile(const char* filename) noex
 	SDL_GPUCommandBuffer* cmdbuf = SDL_AcquireGPUCommandBuffer(_device);
 	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(cmdbuf);
 	
-	SDL_GPUTextureTransferInfo textureTransferInfo = {
-		.transfer_buffer = transferBuffer,
-		.offset = 0,
-	};
-	SDL_GPUTextureRegion region = {
-		.texture = texture,
-		.w = _width,
-		.h = _height,
-		.d = 1
-	};
-	SDL_UploadToGPUTexture(
-		copyPass,
-		&textureTransferInfo,
-		&region,
-		false
-	);
+	for (size_t i = 0; i < _mipChain.GetLevelCount(); ++i) {
+		auto& level = _mipChain.GetLevel(i);
+		SDL_GPUTextureTransferInfo textureTransferInfo = {
+			.transfer_buffer = transferBuffer,
+			.offset = static_cast<Uint32>(level.offset)
+		};
+		SDL_GPUTextureRegion region = {
+			.texture = texture,
+			.mip_level = static_cast<Uint32>(i),
+			.w = level.width,
+			.h = level.height,
+			.d = 1
+		};
+		SDL_UploadToGPUTexture(copyPass, &textureTransferInfo, &region, false);
+	}
 	
 	SDL_EndGPUCopyPass(copyPass);
 	SDL_SubmitGPUCommandBuffer(cmdbuf);
 	
-	SDL_ReleaseGPUTransferBuffer(_device, transferBuffer);
-	
 	return texture;
 }
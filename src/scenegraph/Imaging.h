@@ -1,5 +1,7 @@
 #pragma once
 
+#include <scenegraph/imaging/MipChain.h>
+
 #include <cstdint>
 
 struct SDL_GPUDevice;
@@ -23,14 +25,18 @@ public:
 	{
 	}
 	
-	SDL_GPUTexture* LoadFromFile(const char* filename) noexcept;
+	// Formats the device cannot sample fall back to RGBA8
+	SDL_GPUTexture* LoadFromFile(const char* filename, const MipChainOptions& options = {}) noexcept;
 	
 	uint32_t Width() const noexcept { return _width; }
 	uint32_t Height() const noexcept { return _height; }
 	uint8_t Channels() const noexcept { return _channels; }
+	uint32_t Levels() const noexcept { return static_cast<uint32_t>(_mipChain.GetLevelCount()); }
+	PixelFormat Format() const noexcept { return _mipChain.GetFormat(); }
 	
 private:
 	SDL_GPUDevice* _device = nullptr;
+	MipChain _mipChain;
 	uint32_t _width = 0;
 	uint32_t _height = 0;
 	uint8_t _channels = 0;
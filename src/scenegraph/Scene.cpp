@@ -1,6 +1,8 @@
 #include <scenegraph/Scene.h>
 #include "SceneNode.h"
 
+#include <scenegraph/profiling/Trace.h>
+
 Scene::Scene() = default;
 
 Scene::~Scene() {
@@ -24,11 +26,27 @@ SceneObject Scene::GetRootObject() noexcept {
 	return SceneObject{_root.get()};
 }
 
+SpatialGrid2D& Scene::GetSpatialIndex2D() noexcept {
+	if (!_spatialIndex2D) {
+		_spatialIndex2D = std::make_unique<SpatialGrid2D>();
+	}
+	return *_spatialIndex2D;
+}
+
+BoundingVolumeHierarchy& Scene::GetSpatialIndex3D() noexcept {
+	if (!_spatialIndex3D) {
+		_spatialIndex3D = std::make_unique<BoundingVolumeHierarchy>();
+	}
+	return *_spatialIndex3D;
+}
+
 SceneObject Scene::AddObject() noexcept {
 	return GetRootObject().AppendChild();
 }
 
 bool Scene::ForEachObject(EnumObjectsCallback callback, void* context) noexcept {
+	TRACE_ZONE("Scene::ForEachObject");
+	
 	if (!_root || !callback) {
 		return false;
 	}
@@ -2,6 +2,8 @@
 #include <scenegraph/Component.h>
 #include "SceneNode.h"
 
+#include <scenegraph/profiling/Trace.h>
+
 Scene* SceneObject::GetScene() noexcept {
 	return _node ? _node->GetScene() : nullptr;
 }
@@ -116,6 +118,8 @@ bool SceneObject::ForEachObjectInChildren(EnumObjectsCallback callback, void* co
 }
 
 bool SceneObject::WalkChildren(EnumDirection direction, EnumCallOrder callOrder, WalkObjectsCallback callback, void* context) noexcept {
+	TRACE_ZONE("SceneObject::WalkChildren");
+	
 	if (!_node || !callback) {
 		return false;
 	}
@@ -247,6 +251,8 @@ void SceneObject::SendMessageInParent(ComponentMessage message, ComponentMessage
 }
 
 void SceneObject::SendMessageInChildren(ComponentMessage message, ComponentMessageParams& params) noexcept {
+	TRACE_ZONE("SceneObject::SendMessageInChildren");
+	
 	if (!_node) {
 		return;
 	}
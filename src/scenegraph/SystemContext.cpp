@@ -1,5 +1,7 @@
 #include <scenegraph/SystemContext.h>
 #include <scenegraph/ApplicationContext.h>
+#include <scenegraph/gpu/SdlGpuDevice.h>
+#include <scenegraph/gpu/NullGpuDevice.h>
 
 #include <cassert>
 
@@ -9,17 +11,26 @@ SystemContext::~SystemContext() {
 	auto device = static_cast<SDL_GPUDevice*>(_device);
 	auto window = static_cast<SDL_Window*>(_window);
 	
+	_gpuDevice.reset();
+	
 	if (device && window) { SDL_ReleaseWindowFromGPUDevice(device, window); }
 	if (window) { SDL_DestroyWindow(window); }
 	if (device) { SDL_DestroyGPUDevice(device); }
 }
 
-bool SystemContext::Initialize() {
+bool SystemContext::Initialize(GpuBackend backend) {
 	SDL_assert(!_initialized);
 	if (_initialized) {
 		return true;
 	}
 	
+	// Neither video nor a window is needed without a GPU
+	if (backend == GpuBackend::Null) {
+		_gpuDevice = std::make_unique<NullGpuDevice>();
+		_initialized = true;
+		return true;
+	}
+	
 	SDL_Init(SDL_INIT_VIDEO);
 	
 	bool debugMode = false;
@@ -27,13 +38,14 @@ bool SystemContext::Initialize() {
 	debugMode = true;
 #endif
 	
-	auto device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_METALLIB, debugMode, nullptr);
+	auto device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_METALLIB, debugMode, nullptr);
 	if (!device) {
 		SDL_Log("GPUCreateDevice failed");
 		return false;
 	}
 	
 	_device = device;
+	_gpuDevice = std::make_unique<SdlGpuDevice>(device);
 	
 	auto appCtx = GetApplicationContext();
 	
@@ -60,9 +72,9 @@ void SystemContext::Finalize() {
 }
 
 Buffer SystemContext::CreateBuffer() noexcept {
-	return Buffer{_device};
+	return Buffer{_gpuDevice.get()};
 }
 
 TransferBuffer SystemContext::CreateTransferBuffer() noexcept {
-	return TransferBuffer{_device};
+	return TransferBuffer{_gpuDevice.get()};
 }
@@ -0,0 +1,195 @@
+#include <scenegraph/animation/Animator2D.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/threading/ThreadPool.h>
+#include <scenegraph/profiling/Trace.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Instances per parallel chunk, evaluation of one takes tens of nanoseconds
+constexpr size_t kUpdateGrain = 1024;
+
+float& ChannelValue(Transform2D& transform, Transform2DChannel channel) noexcept {
+	switch (channel) {
+	case Transform2DChannel::ScaleX: return transform.sx;
+	case Transform2DChannel::ScaleY: return transform.sy;
+	case Transform2DChannel::ShearX: return transform.shearX;
+	case Transform2DChannel::ShearY: return transform.shearY;
+	case Transform2DChannel::Rotation: return transform.rad;
+	case Transform2DChannel::TranslationX: return transform.tx;
+	case Transform2DChannel::TranslationY: return transform.ty;
+	}
+	
+	return transform.tx;
+}
+
+} // namespace
+
+Animator2D::ClipId Animator2D::CreateClip(const Track* tracks, size_t count) noexcept {
+	if (!tracks || count == 0) {
+		return kInvalidClip;
+	}
+	
+	float duration = 0;
+	for (size_t i = 0; i < count; ++i) {
+		auto& track = tracks[i];
+		auto sorted = std::is_sorted(track.keyframes, track.keyframes + track.count,
+			[](const Keyframe& k1, const Keyframe& k2) { return k1.time < k2.time; });
+		if (!track.keyframes || track.count == 0 || !sorted || track.keyframes[0].time < 0) {
+			return kInvalidClip;
+		}
+		duration = std::max(duration, track.keyframes[track.count - 1].time);
+	}
+	
+	auto clip = static_cast<ClipId>(_clips.size());
+	_clips.push_back({static_cast<uint32_t>(_tracks.size()), static_cast<uint32_t>(count), duration});
+	
+	for (size_t i = 0; i < count; ++i) {
+		auto& track = tracks[i];
+		_tracks.push_back({static_cast<uint32_t>(_keyframes.size()), static_cast<uint32_t>(track.count), track.channel});
+		_keyframes.insert(_keyframes.end(), track.keyframes, track.keyframes + track.count);
+	}
+	
+	return clip;
+}
+
+float Animator2D::GetClipDuration(ClipId clip) const noexcept {
+	return clip < _clips.size() ? _clips[clip].duration : 0.0f;
+}
+
+Animator2D::InstanceId Animator2D::Play(ClipId clip, Transform2DComponent* target, bool loop, float speed) noexcept {
+	assert(target);
+	if (clip >= _clips.size() || !target) {
+		return kInvalidInstance;
+	}
+	
+	// Ids kept by components animated by other animators are not ours
+	if (auto current = target->_animationInstance; IsPlaying(current) && _instances[_slots[current & kSlotMask].index].target == target) {
+		Stop(current);
+	}
+	
+	uint32_t slot;
+	if (!_freeSlots.empty()) {
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else {
+		assert(_slots.size() < kSlotMask);
+		if (_slots.size() >= kSlotMask) {
+			return kInvalidInstance;
+		}
+		slot = static_cast<uint32_t>(_slots.size());
+		_slots.push_back({0, 0});
+	}
+	
+	auto id = slot | (_slots[slot].generation << kSlotBits);
+	_slots[slot].index = static_cast<uint32_t>(_instances.size());
+	_instanceIds.push_back(id);
+	_instances.push_back({target, clip, speed < 0 ? _clips[clip].duration : 0.0f, speed, loop, false});
+	target->_animationInstance = id;
+	
+	return id;
+}
+
+void Animator2D::Stop(InstanceId instance) noexcept {
+	if (IsPlaying(instance)) {
+		Remove(_slots[instance & kSlotMask].index);
+	}
+}
+
+bool Animator2D::IsPlaying(InstanceId instance) const noexcept {
+	auto slot = instance & kSlotMask;
+	return slot < _slots.size() && _slots[slot].index != kInvalidInstance && _slots[slot].generation == instance >> kSlotBits;
+}
+
+void Animator2D::Update(float dt, ThreadPool* threadPool) noexcept {
+	TRACE_ZONE("Animator2D::Update");
+	
+	if (threadPool && _instances.size() > kUpdateGrain) {
+		threadPool->ParallelFor(0, _instances.size(), kUpdateGrain, [this, dt](size_t begin, size_t end) {
+			Evaluate(begin, end, dt);
+		});
+	}
+	else {
+		Evaluate(0, _instances.size(), dt);
+	}
+	
+	// Removal moves the last instance into the hole, so go backwards
+	for (auto i = _instances.size(); i-- > 0;) {
+		if (_instances[i].finished) {
+			Remove(i);
+		}
+	}
+}
+
+void Animator2D::Evaluate(size_t begin, size_t end, float dt) noexcept {
+	for (auto i = begin; i < end; ++i) {
+		auto& instance = _instances[i];
+		auto& clip = _clips[instance.clip];
+		
+		instance.time += dt * instance.speed;
+		if (instance.time > clip.duration || instance.time < 0) {
+			if (instance.loop && clip.duration > 0) {
+				instance.time -= std::floor(instance.time / clip.duration) * clip.duration;
+			}
+			else {
+				instance.time = std::clamp(instance.time, 0.0f, clip.duration);
+				instance.finished = true;
+			}
+		}
+		
+		auto transform = instance.target->localTransform;
+		for (uint32_t t = 0; t < clip.trackCount; ++t) {
+			auto& track = _tracks[clip.firstTrack + t];
+			ChannelValue(transform, track.channel) = Sample(track, instance.time);
+		}
+		
+		if (std::memcmp(&transform, &instance.target->localTransform, sizeof(Transform2D)) != 0) {
+			instance.target->localTransform = transform;
+			instance.target->MarkDirty();
+		}
+	}
+}
+
+float Animator2D::Sample(const ClipTrack& track, float time) const noexcept {
+	auto first = _keyframes.data() + track.firstKeyframe;
+	auto last = first + track.keyframeCount;
+	
+	auto next = std::upper_bound(first, last, time, [](float t, const Keyframe& k) { return t < k.time; });
+	if (next == first) {
+		return first->value;
+	}
+	if (next == last) {
+		return (last - 1)->value;
+	}
+	
+	auto& k0 = *(next - 1);
+	auto& k1 = *next;
+	auto factor = Ease(k0.easing, (time - k0.time) / (k1.time - k0.time));
+	return k0.value + (k1.value - k0.value) * factor;
+}
+
+void Animator2D::Remove(size_t index) noexcept {
+	auto id = _instanceIds[index];
+	if (auto target = _instances[index].target; target->_animationInstance == id) {
+		target->_animationInstance = kInvalidInstance;
+	}
+	
+	if (auto last = _instances.size() - 1; index != last) {
+		_instances[index] = _instances[last];
+		_instanceIds[index] = _instanceIds[last];
+		_slots[_instanceIds[index] & kSlotMask].index = static_cast<uint32_t>(index);
+	}
+	
+	_instances.pop_back();
+	_instanceIds.pop_back();
+	
+	auto& slot = _slots[id & kSlotMask];
+	slot.index = kInvalidInstance;
+	slot.generation = (slot.generation + 1) & (UINT32_MAX >> kSlotBits);
+	_freeSlots.push_back(id & kSlotMask);
+}
@@ -0,0 +1,39 @@
+#include <scenegraph/animation/Easing.h>
+
+#include <cmath>
+#include <numbers>
+
+float Ease(Easing easing, float t) noexcept {
+	switch (easing) {
+	case Easing::Step:
+		return t < 1 ? 0.0f : 1.0f;
+	case Easing::Linear:
+		return t;
+	case Easing::QuadIn:
+		return t * t;
+	case Easing::QuadOut:
+		return t * (2 - t);
+	case Easing::QuadInOut:
+		return t < 0.5f ? 2 * t * t : 1 - 2 * (1 - t) * (1 - t);
+	case Easing::CubicIn:
+		return t * t * t;
+	case Easing::CubicOut: {
+		auto u = 1 - t;
+		return 1 - u * u * u;
+	}
+	case Easing::CubicInOut: {
+		auto u = 1 - t;
+		return t < 0.5f ? 4 * t * t * t : 1 - 4 * u * u * u;
+	}
+	case Easing::SineInOut:
+		return 0.5f - 0.5f * std::cos(std::numbers::pi_v<float> * t);
+	case Easing::BackOut: {
+		constexpr float c1 = 1.70158f;
+		constexpr float c3 = c1 + 1;
+		auto u = t - 1;
+		return 1 + c3 * u * u * u + c1 * u * u;
+	}
+	}
+	
+	return t;
+}
@@ -0,0 +1,99 @@
+#include <scenegraph/components/Bounds2DComponent.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/profiling/Trace.h>
+#include "BoundsHierarchy.h"
+
+namespace {
+
+struct UpdateEntry {
+	const Matrix32* worldTransform;
+	Rect subtreeBounds;
+};
+
+} // namespace
+
+void Bounds2DComponent::Added(SceneObject sceneObject) noexcept {
+	if (auto scene = sceneObject.GetScene()) {
+		_proxy = scene->GetSpatialIndex2D().Insert(sceneObject, _worldBounds);
+	}
+}
+
+void Bounds2DComponent::Removed(SceneObject sceneObject) noexcept {
+	if (auto scene = sceneObject.GetScene(); scene && _proxy != SpatialGrid2D::kInvalidProxy) {
+		scene->GetSpatialIndex2D().Remove(_proxy);
+		_proxy = SpatialGrid2D::kInvalidProxy;
+	}
+}
+
+void Bounds2DComponent::UpdateHierarchy(SceneObject root) noexcept {
+	TRACE_ZONE("Bounds2DComponent::UpdateHierarchy");
+	
+	static constexpr auto kIdentity = Matrix32MakeIdentity();
+	auto scene = root.GetScene();
+	auto rootTransform = root.FindComponent<Transform2DComponent>();
+	if (!rootTransform) {
+		rootTransform = root.FindComponentInParent<Transform2DComponent>();
+	}
+	
+	// Entries of the current path, children accumulate subtree bounds into their parent entry
+	std::vector<UpdateEntry> path;
+	path.push_back({rootTransform ? &rootTransform->GetWorldTransform() : &kIdentity, RectMakeEmpty()});
+	
+	root.WalkChildren(EnumDirection::FirstToLast, EnumCallOrder::PreOrder | EnumCallOrder::PostOrder,
+		[&path, scene](SceneObject object, EnumCallOrder callOrder, bool&) {
+			if (callOrder == EnumCallOrder::PreOrder) {
+				auto transform = object.FindComponent<Transform2DComponent>();
+				path.push_back({transform ? &transform->GetWorldTransform() : path.back().worldTransform, RectMakeEmpty()});
+				return;
+			}
+			
+			auto entry = path.back();
+			path.pop_back();
+			
+			if (auto bounds = object.FindComponent<Bounds2DComponent>()) {
+				bounds->_worldBounds = RectTransform(bounds->localBounds, *entry.worldTransform);
+				bounds->_subtreeBounds = RectUnion(entry.subtreeBounds, bounds->_worldBounds);
+				if (bounds->_proxy != SpatialGrid2D::kInvalidProxy) {
+					scene->GetSpatialIndex2D().Update(bounds->_proxy, bounds->_worldBounds);
+				}
+				entry.subtreeBounds = bounds->_subtreeBounds;
+			}
+			
+			path.back().subtreeBounds = RectUnion(path.back().subtreeBounds, entry.subtreeBounds);
+		});
+}
+
+void Bounds2DComponent::Cull(SceneObject root, const Rect& view, std::vector<SceneObject>& visible) noexcept {
+	TRACE_ZONE("Bounds2DComponent::Cull");
+	
+	WalkChildrenPruned(root, [&view, &visible](SceneObject object) {
+		auto bounds = object.FindComponent<Bounds2DComponent>();
+		if (!bounds) {
+			return true;
+		}
+		
+		if (!RectIntersect(view, bounds->_subtreeBounds)) {
+			return false;
+		}
+		
+		if (RectContains(view, bounds->_subtreeBounds)) {
+			// Whole subtree is visible, no more tests needed
+			if (!RectIsEmpty(bounds->_worldBounds)) {
+				visible.push_back(object);
+			}
+			object.ForEachComponentInChildren<Bounds2DComponent>([&visible](SceneObject sceneObject, Bounds2DComponent* c, bool&) {
+				if (!RectIsEmpty(c->_worldBounds)) {
+					visible.push_back(sceneObject);
+				}
+			});
+			return false;
+		}
+		
+		if (RectIntersect(view, bounds->_worldBounds)) {
+			visible.push_back(object);
+		}
+		
+		return true;
+	});
+}
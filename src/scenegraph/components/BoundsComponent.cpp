@@ -0,0 +1,124 @@
+#include <scenegraph/components/BoundsComponent.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/components/TransformComponent.h>
+#include <scenegraph/math/Frustum.h>
+#include <scenegraph/profiling/Trace.h>
+#include "BoundsHierarchy.h"
+
+#include <cstring>
+
+namespace {
+
+struct UpdateEntry {
+	const Matrix43* worldMatrix;
+	AABB subtreeBounds;
+};
+
+} // namespace
+
+void BoundsComponent::Removed(SceneObject sceneObject) noexcept {
+	if (auto scene = sceneObject.GetScene(); scene && _proxy != BoundingVolumeHierarchy::kInvalidProxy) {
+		scene->GetSpatialIndex3D().Remove(_proxy);
+		_proxy = BoundingVolumeHierarchy::kInvalidProxy;
+	}
+}
+
+void BoundsComponent::UpdateHierarchy(SceneObject root) noexcept {
+	TRACE_ZONE("BoundsComponent::UpdateHierarchy");
+	
+	static constexpr auto kIdentity = Matrix43MakeIdentity();
+	auto& index = root.GetScene()->GetSpatialIndex3D();
+	auto rootTransform = root.FindComponent<TransformComponent>();
+	if (!rootTransform) {
+		rootTransform = root.FindComponentInParent<TransformComponent>();
+	}
+	
+	// Entries of the current path, children accumulate subtree bounds into their parent entry
+	std::vector<UpdateEntry> path;
+	path.push_back({rootTransform ? &rootTransform->GetWorldMatrix() : &kIdentity, AABBMakeEmpty()});
+	
+	root.WalkChildren(EnumDirection::FirstToLast, EnumCallOrder::PreOrder | EnumCallOrder::PostOrder,
+		[&path, &index](SceneObject object, EnumCallOrder callOrder, bool&) {
+			if (callOrder == EnumCallOrder::PreOrder) {
+				auto transform = object.FindComponent<TransformComponent>();
+				path.push_back({transform ? &transform->GetWorldMatrix() : path.back().worldMatrix, AABBMakeEmpty()});
+				return;
+			}
+			
+			auto entry = path.back();
+			path.pop_back();
+			
+			if (auto bounds = object.FindComponent<BoundsComponent>()) {
+				auto worldBounds = AABBIsEmpty(bounds->localBounds)
+					? bounds->localBounds
+					: AABBTransform(bounds->localBounds, *entry.worldMatrix);
+				bounds->UpdateProxy(object, index, worldBounds);
+				bounds->_worldSphere = AABBIsEmpty(bounds->_worldBounds)
+					? SphereMake(Vector3MakeZero(), 0)
+					: AABBBoundingSphere(bounds->_worldBounds);
+				bounds->_subtreeBounds = AABBUnion(entry.subtreeBounds, bounds->_worldBounds);
+				entry.subtreeBounds = bounds->_subtreeBounds;
+			}
+			
+			path.back().subtreeBounds = AABBUnion(path.back().subtreeBounds, entry.subtreeBounds);
+		});
+	
+	index.Refit();
+}
+
+void BoundsComponent::UpdateProxy(SceneObject sceneObject, BoundingVolumeHierarchy& index, const AABB& worldBounds) noexcept {
+	auto changed = std::memcmp(&worldBounds, &_worldBounds, sizeof(AABB)) != 0;
+	_worldBounds = worldBounds;
+	
+	// Empty bounds have no place in the hierarchy
+	if (AABBIsEmpty(worldBounds)) {
+		if (_proxy != BoundingVolumeHierarchy::kInvalidProxy) {
+			index.Remove(_proxy);
+			_proxy = BoundingVolumeHierarchy::kInvalidProxy;
+		}
+	}
+	else if (_proxy == BoundingVolumeHierarchy::kInvalidProxy) {
+		_proxy = index.Insert(sceneObject, worldBounds);
+	}
+	else if (changed) {
+		index.Move(_proxy, worldBounds);
+	}
+}
+
+void BoundsComponent::Cull(SceneObject root, const Frustum& frustum, std::vector<SceneObject>& visible) noexcept {
+	TRACE_ZONE("BoundsComponent::Cull");
+	
+	WalkChildrenPruned(root, [&frustum, &visible](SceneObject object) {
+		auto bounds = object.FindComponent<BoundsComponent>();
+		if (!bounds) {
+			return true;
+		}
+		
+		if (AABBIsEmpty(bounds->_subtreeBounds) || FrustumCullAABB(frustum, bounds->_subtreeBounds)) {
+			return false;
+		}
+		
+		if (FrustumContainsAABB(frustum, bounds->_subtreeBounds)) {
+			// Whole subtree is visible, no more tests needed
+			if (!AABBIsEmpty(bounds->_worldBounds)) {
+				visible.push_back(object);
+			}
+			object.ForEachComponentInChildren<BoundsComponent>([&visible](SceneObject sceneObject, BoundsComponent* c, bool&) {
+				if (!AABBIsEmpty(c->_worldBounds)) {
+					visible.push_back(sceneObject);
+				}
+			});
+			return false;
+		}
+		
+		// Sphere test is cheaper and rejects most of objects, the box one is tighter
+		if (!AABBIsEmpty(bounds->_worldBounds)
+			&& !FrustumCullSphere(frustum, bounds->_worldSphere)
+			&& !FrustumCullAABB(frustum, bounds->_worldBounds))
+		{
+			visible.push_back(object);
+		}
+		
+		return true;
+	});
+}
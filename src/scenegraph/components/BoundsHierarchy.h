@@ -0,0 +1,23 @@
+#pragma once
+
+#include <scenegraph/SceneObject.h>
+
+// Calls bool handler(SceneObject) for children of the root in preorder, false skips children of the object
+template <typename Handler>
+void WalkChildrenPruned(SceneObject root, Handler&& handler) noexcept {
+	auto object = root.FirstChild();
+	while (object) {
+		if (handler(object)) {
+			if (auto child = object.FirstChild()) {
+				object = child;
+				continue;
+			}
+		}
+		
+		while (object != root && !object.NextSibling()) {
+			object = object.Parent();
+		}
+		
+		object = object != root ? object.NextSibling() : SceneObject{};
+	}
+}
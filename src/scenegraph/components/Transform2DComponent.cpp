@@ -0,0 +1,70 @@
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/components/ComponentVersion.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/profiling/Trace.h>
+
+#include <vector>
+
+namespace {
+
+const Transform2DComponent* FindParentTransform(SceneObject sceneObject) noexcept {
+	auto parent = sceneObject;
+	while ((parent = parent.Parent())) {
+		if (auto parentTransform = parent.FindComponent<Transform2DComponent>()) {
+			return parentTransform;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace
+
+void Transform2DComponent::Apply(SceneObject sceneObject) noexcept {
+	UpdateWorldTransform(FindParentTransform(sceneObject), true);
+}
+
+void Transform2DComponent::UpdateWorldTransform(const Transform2DComponent* parent, bool force) noexcept {
+	auto parentVersion = parent ? parent->_worldVersion : 0;
+	if (!force && !_dirty && parentVersion == _parentVersion) {
+		return;
+	}
+	
+	_worldTransform = Matrix32MakeWithTransform2D(localTransform);
+	if (parent) {
+		_worldTransform = parent->_worldTransform * _worldTransform;
+	}
+	
+	_dirty = false;
+	_parentVersion = parentVersion;
+	_worldVersion = ComponentVersionNext();
+}
+
+void Transform2DComponent::UpdateHierarchy(SceneObject root) noexcept {
+	TRACE_ZONE("Transform2DComponent::UpdateHierarchy");
+	
+	auto rootTransform = root.FindComponent<Transform2DComponent>();
+	if (rootTransform) {
+		rootTransform->UpdateWorldTransform(FindParentTransform(root), false);
+	}
+	else {
+		rootTransform = root.FindComponentInParent<Transform2DComponent>();
+	}
+	
+	// Nearest transforms of the current path
+	std::vector<const Transform2DComponent*> path;
+	path.push_back(rootTransform);
+	
+	root.WalkChildren(EnumDirection::FirstToLast, EnumCallOrder::PreOrder | EnumCallOrder::PostOrder,
+		[&path](SceneObject object, EnumCallOrder callOrder, bool&) {
+			if (callOrder == EnumCallOrder::PostOrder) {
+				path.pop_back();
+				return;
+			}
+			
+			auto transform = object.FindComponent<Transform2DComponent>();
+			if (transform) {
+				transform->UpdateWorldTransform(path.back(), false);
+			}
+			path.push_back(transform ? transform : path.back());
+		});
+}
@@ -0,0 +1,80 @@
+#include <scenegraph/components/TransformComponent.h>
+#include <scenegraph/components/ComponentVersion.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/profiling/Trace.h>
+
+#include <vector>
+
+namespace {
+
+const TransformComponent* FindParentTransform(SceneObject sceneObject) noexcept {
+	auto parent = sceneObject;
+	while ((parent = parent.Parent())) {
+		if (auto parentTransform = parent.FindComponent<TransformComponent>()) {
+			return parentTransform;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace
+
+void TransformComponent::SetLocalTransform(const Transform& transform) noexcept {
+	_translation = Vector3Make(transform.tx, transform.ty, transform.tz);
+	_rotation =
+		QuaternionMakeRotationAxisAngle(0, 0, 1, transform.radZ) *
+		QuaternionMakeRotationAxisAngle(0, 1, 0, transform.radY) *
+		QuaternionMakeRotationAxisAngle(1, 0, 0, transform.radX);
+	_scale = Vector3Make(transform.sx, transform.sy, transform.sz);
+	_localDirty = true;
+}
+
+void TransformComponent::Apply(SceneObject sceneObject) noexcept {
+	UpdateWorldMatrix(FindParentTransform(sceneObject));
+}
+
+void TransformComponent::UpdateWorldMatrix(const TransformComponent* parent) noexcept {
+	auto parentVersion = parent ? parent->_worldVersion : 0;
+	if (!_localDirty && parentVersion == _parentVersion) {
+		return;
+	}
+	
+	if (_localDirty) {
+		_localMatrix = Matrix43MakeWithScaleRotationTranslation(_scale, _rotation, _translation);
+		_localDirty = false;
+	}
+	
+	_worldMatrix = parent ? _localMatrix * parent->_worldMatrix : _localMatrix;
+	_parentVersion = parentVersion;
+	_worldVersion = ComponentVersionNext();
+}
+
+void TransformComponent::UpdateHierarchy(SceneObject root) noexcept {
+	TRACE_ZONE("TransformComponent::UpdateHierarchy");
+	
+	auto rootTransform = root.FindComponent<TransformComponent>();
+	if (rootTransform) {
+		rootTransform->UpdateWorldMatrix(FindParentTransform(root));
+	}
+	else {
+		rootTransform = root.FindComponentInParent<TransformComponent>();
+	}
+	
+	// Nearest transforms of the current path
+	std::vector<const TransformComponent*> path;
+	path.push_back(rootTransform);
+	
+	root.WalkChildren(EnumDirection::FirstToLast, EnumCallOrder::PreOrder | EnumCallOrder::PostOrder,
+		[&path](SceneObject object, EnumCallOrder callOrder, bool&) {
+			if (callOrder == EnumCallOrder::PostOrder) {
+				path.pop_back();
+				return;
+			}
+			
+			auto transform = object.FindComponent<TransformComponent>();
+			if (transform) {
+				transform->UpdateWorldMatrix(path.back());
+			}
+			path.push_back(transform ? transform : path.back());
+		});
+}
@@ -0,0 +1,212 @@
+#include <scenegraph/gpu/NullGpuDevice.h>
+
+#include <cassert>
+#include <cstring>
+
+const char* NullGpuCommandTypeName(NullGpuCommandType type) noexcept {
+	switch (type) {
+	case NullGpuCommandType::CreateBuffer: return "CreateBuffer";
+	case NullGpuCommandType::ReleaseBuffer: return "ReleaseBuffer";
+	case NullGpuCommandType::CreateTransferBuffer: return "CreateTransferBuffer";
+	case NullGpuCommandType::ReleaseTransferBuffer: return "ReleaseTransferBuffer";
+	case NullGpuCommandType::MapTransferBuffer: return "MapTransferBuffer";
+	case NullGpuCommandType::UnmapTransferBuffer: return "UnmapTransferBuffer";
+	case NullGpuCommandType::CreateShader: return "CreateShader";
+	case NullGpuCommandType::ReleaseShader: return "ReleaseShader";
+	case NullGpuCommandType::CreateGraphicsPipeline: return "CreateGraphicsPipeline";
+	case NullGpuCommandType::ReleaseGraphicsPipeline: return "ReleaseGraphicsPipeline";
+	case NullGpuCommandType::AcquireCommandBuffer: return "AcquireCommandBuffer";
+	case NullGpuCommandType::Upload: return "Upload";
+	case NullGpuCommandType::Submit: return "Submit";
+	}
+	return "";
+}
+
+NullGpuDevice::~NullGpuDevice() {
+	// Everything must be released before the device
+	assert(_memory.empty());
+	assert(_objects.empty());
+	assert(_commandBuffers.empty());
+}
+
+void* NullGpuDevice::CreateBuffer(BufferUsage, uint32_t size) noexcept {
+	auto buffer = CreateMemory(size);
+	Record(NullGpuCommandType::CreateBuffer, buffer, size);
+	return buffer;
+}
+
+void NullGpuDevice::ReleaseBuffer(void* buffer) noexcept {
+	Record(NullGpuCommandType::ReleaseBuffer, buffer);
+	ReleaseMemory(buffer);
+}
+
+void* NullGpuDevice::CreateTransferBuffer(TransferBufferUsage, uint32_t size) noexcept {
+	auto transferBuffer = CreateMemory(size);
+	Record(NullGpuCommandType::CreateTransferBuffer, transferBuffer, size);
+	return transferBuffer;
+}
+
+void NullGpuDevice::ReleaseTransferBuffer(void* transferBuffer) noexcept {
+	Record(NullGpuCommandType::ReleaseTransferBuffer, transferBuffer);
+	ReleaseMemory(transferBuffer);
+}
+
+void* NullGpuDevice::MapTransferBuffer(void* transferBuffer, bool) noexcept {
+	auto it = _memory.find(transferBuffer);
+	assert(it != _memory.end() && !it->second.mapped);
+	if (it == _memory.end()) {
+		return nullptr;
+	}
+	
+	// Copies complete on submit, so memory of a mapped buffer is never in use and cycling is not needed
+	Record(NullGpuCommandType::MapTransferBuffer, transferBuffer);
+	it->second.mapped = true;
+	return it->second.data.get();
+}
+
+void NullGpuDevice::UnmapTransferBuffer(void* transferBuffer) noexcept {
+	auto it = _memory.find(transferBuffer);
+	assert(it != _memory.end() && it->second.mapped);
+	if (it == _memory.end()) {
+		return;
+	}
+	
+	Record(NullGpuCommandType::UnmapTransferBuffer, transferBuffer);
+	it->second.mapped = false;
+}
+
+ShaderFormat NullGpuDevice::GetShaderFormats() noexcept {
+	return ShaderFormat::SpirV | ShaderFormat::Dxil | ShaderFormat::MetalLib;
+}
+
+void* NullGpuDevice::CreateShader(const ShaderCreateInfo& createInfo) noexcept {
+	assert(createInfo.code && createInfo.codeSize > 0 && createInfo.reflection);
+	auto shader = CreateObject();
+	Record(NullGpuCommandType::CreateShader, shader, static_cast<uint32_t>(createInfo.codeSize));
+	return shader;
+}
+
+void NullGpuDevice::ReleaseShader(void* shader) noexcept {
+	Record(NullGpuCommandType::ReleaseShader, shader);
+	ReleaseObject(shader);
+}
+
+void* NullGpuDevice::CreateGraphicsPipeline(const PipelineState& state) noexcept {
+	assert(_objects.contains(state.vertexShader) && _objects.contains(state.fragmentShader));
+	auto pipeline = CreateObject();
+	Record(NullGpuCommandType::CreateGraphicsPipeline, pipeline);
+	return pipeline;
+}
+
+void NullGpuDevice::ReleaseGraphicsPipeline(void* pipeline) noexcept {
+	Record(NullGpuCommandType::ReleaseGraphicsPipeline, pipeline);
+	ReleaseObject(pipeline);
+}
+
+void* NullGpuDevice::AcquireCommandBuffer() noexcept {
+	auto commandBuffer = reinterpret_cast<void*>(++_lastHandle);
+	_commandBuffers.emplace(commandBuffer, std::vector<UploadRegion>{});
+	Record(NullGpuCommandType::AcquireCommandBuffer, commandBuffer);
+	return commandBuffer;
+}
+
+void NullGpuDevice::UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept {
+	auto it = _commandBuffers.find(commandBuffer);
+	assert(it != _commandBuffers.end());
+	if (it == _commandBuffers.end()) {
+		return;
+	}
+	
+	for (size_t i = 0; i < count; ++i) {
+		auto& region = regions[i];
+		if (_recording) {
+			_commands.push_back(NullGpuCommand {
+				.type = NullGpuCommandType::Upload,
+				.object = region.transferBuffer,
+				.offset = region.transferOffset,
+				.destination = region.buffer,
+				.destinationOffset = region.bufferOffset,
+				.size = region.size
+			});
+		}
+		it->second.push_back(region);
+	}
+}
+
+void* NullGpuDevice::Submit(void* commandBuffer) noexcept {
+	auto it = _commandBuffers.find(commandBuffer);
+	assert(it != _commandBuffers.end());
+	if (it == _commandBuffers.end()) {
+		return nullptr;
+	}
+	
+	Record(NullGpuCommandType::Submit, commandBuffer);
+	
+	for (auto& region : it->second) {
+		auto source = _memory.find(region.transferBuffer);
+		auto destination = _memory.find(region.buffer);
+		assert(source != _memory.end() && destination != _memory.end());
+		assert(!source->second.mapped);
+		assert(region.transferOffset + region.size <= source->second.size);
+		assert(region.bufferOffset + region.size <= destination->second.size);
+		std::memcpy(destination->second.data.get() + region.bufferOffset, source->second.data.get() + region.transferOffset, region.size);
+	}
+	_commandBuffers.erase(it);
+	
+	return reinterpret_cast<void*>(++_lastHandle);
+}
+
+bool NullGpuDevice::IsFenceSignaled(void*) noexcept {
+	return true;
+}
+
+void NullGpuDevice::WaitForFence(void*) noexcept {
+}
+
+void NullGpuDevice::ReleaseFence(void*) noexcept {
+}
+
+const std::byte* NullGpuDevice::GetData(const void* object) const noexcept {
+	auto it = _memory.find(object);
+	return it != _memory.end() ? it->second.data.get() : nullptr;
+}
+
+uint32_t NullGpuDevice::GetSize(const void* object) const noexcept {
+	auto it = _memory.find(object);
+	return it != _memory.end() ? it->second.size : 0;
+}
+
+void* NullGpuDevice::CreateObject() noexcept {
+	auto object = reinterpret_cast<void*>(++_lastHandle);
+	_objects.insert(object);
+	return object;
+}
+
+void NullGpuDevice::ReleaseObject(void* object) noexcept {
+	[[maybe_unused]] auto released = _objects.erase(object);
+	assert(released == 1);
+}
+
+void* NullGpuDevice::CreateMemory(uint32_t size) noexcept {
+	auto object = reinterpret_cast<void*>(++_lastHandle);
+	_memory.emplace(object, Memory {std::make_unique<std::byte[]>(size), size, false});
+	return object;
+}
+
+void NullGpuDevice::ReleaseMemory(void* object) noexcept {
+	[[maybe_unused]] auto released = _memory.erase(object);
+	assert(released == 1);
+}
+
+void NullGpuDevice::Record(NullGpuCommandType type, const void* object, uint32_t size) noexcept {
+	if (_recording) {
+		_commands.push_back(NullGpuCommand {
+			.type = type,
+			.object = object,
+			.offset = 0,
+			.destination = nullptr,
+			.destinationOffset = 0,
+			.size = size
+		});
+	}
+}
@@ -0,0 +1,33 @@
+#include <scenegraph/gpu/Pipeline.h>
+#include <scenegraph/utils/MurmurHash.h>
+
+namespace {
+
+constexpr uint64_t HashCombine(uint64_t hash, uint64_t value) noexcept {
+	return Murmur3Finalize64(hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2)));
+}
+
+} // namespace
+
+uint64_t PipelineStateHash(const PipelineState& state) noexcept {
+	auto hash = HashCombine(0, reinterpret_cast<uintptr_t>(state.vertexShader));
+	hash = HashCombine(hash, reinterpret_cast<uintptr_t>(state.fragmentShader));
+	hash = HashCombine(hash, uint64_t{state.colorTargetFormat} |
+		uint64_t{static_cast<uint8_t>(state.primitiveType)} << 32 |
+		uint64_t{static_cast<uint8_t>(state.blendMode)} << 40 |
+		uint64_t{state.vertexBufferCount} << 48 |
+		uint64_t{state.vertexAttributeCount} << 56);
+		
+	// Entries past the counts are default in equal states, so only used ones are hashed
+	for (size_t i = 0; i < state.vertexBufferCount; ++i) {
+		auto& buffer = state.vertexBuffers[i];
+		hash = HashCombine(hash, uint64_t{buffer.pitch} | uint64_t{buffer.slot} << 32 | uint64_t{buffer.instanced} << 40);
+	}
+	for (size_t i = 0; i < state.vertexAttributeCount; ++i) {
+		auto& attribute = state.vertexAttributes[i];
+		hash = HashCombine(hash, uint64_t{attribute.offset} | uint64_t{attribute.location} << 32 |
+			uint64_t{attribute.bufferSlot} << 40 | uint64_t{static_cast<uint8_t>(attribute.format)} << 48);
+	}
+	
+	return hash;
+}
@@ -0,0 +1,173 @@
+#include <scenegraph/gpu/PipelineCache.h>
+#include <scenegraph/gpu/GpuDevice.h>
+#include <scenegraph/utils/ScopeGuard.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+namespace {
+
+bool ReadFile(const std::string& path, std::string* data) noexcept {
+	auto file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+	
+	ON_SCOPE_EXIT(&file) { std::fclose(file); };
+	
+	if (std::fseek(file, 0, SEEK_END) != 0) {
+		return false;
+	}
+	auto size = std::ftell(file);
+	if (size < 0 || std::fseek(file, 0, SEEK_SET) != 0) {
+		return false;
+	}
+	
+	data->resize(static_cast<size_t>(size));
+	return std::fread(data->data(), 1, data->size(), file) == data->size();
+}
+
+bool GetShaderStage(std::string_view name, ShaderStage* stage) noexcept {
+	if (name.ends_with(".vert")) {
+		*stage = ShaderStage::Vertex;
+		return true;
+	}
+	if (name.ends_with(".frag")) {
+		*stage = ShaderStage::Fragment;
+		return true;
+	}
+	return false;
+}
+
+} // namespace
+
+PipelineCache::PipelineCache(GpuDevice& device, std::string_view directory) noexcept
+	: _device(device)
+	, _directory(directory)
+	, _format(ShaderFormatSelect(device.GetShaderFormats()))
+{
+	assert(_format != ShaderFormat::None);
+}
+
+PipelineCache::~PipelineCache() {
+	Clear();
+}
+
+void* PipelineCache::LoadShader(std::string_view name) noexcept {
+	if (auto it = _shaders.find(std::string(name)); it != _shaders.end()) {
+		return it->second.handle;
+	}
+	
+	auto path = _directory.empty() ? std::string(name) : _directory + '/' + std::string(name);
+	std::string reflectionJson;
+	std::string code;
+	if (!ReadFile(path + ".json", &reflectionJson) || !ReadFile(path + '.' + ShaderFormatExtension(_format), &code)) {
+		return nullptr;
+	}
+	
+	return AddShader(name, reflectionJson, code.data(), code.size());
+}
+
+void* PipelineCache::AddShader(std::string_view name, std::string_view reflectionJson, const void* code, size_t codeSize) noexcept {
+	assert(code && codeSize > 0);
+	
+	if (auto it = _shaders.find(std::string(name)); it != _shaders.end()) {
+		return it->second.handle;
+	}
+	
+	ShaderStage stage;
+	if (!GetShaderStage(name, &stage)) {
+		assert(false && "shader name must end with .vert or .frag");
+		return nullptr;
+	}
+	
+	ShaderReflection reflection;
+	if (!ShaderReflectionParse(reflectionJson, &reflection)) {
+		return nullptr;
+	}
+	
+	auto handle = _device.CreateShader(ShaderCreateInfo {
+		.code = code,
+		.codeSize = codeSize,
+		.format = _format,
+		.stage = stage,
+		.reflection = &reflection
+	});
+	if (!handle) {
+		return nullptr;
+	}
+	
+	auto& shader = _shaders.emplace(std::string(name), Shader {handle, std::move(reflection)}).first->second;
+	_reflections.emplace(handle, &shader.reflection);
+	
+	return handle;
+}
+
+const ShaderReflection* PipelineCache::GetReflection(const void* shader) const noexcept {
+	auto it = _reflections.find(shader);
+	return it != _reflections.end() ? it->second : nullptr;
+}
+
+void* PipelineCache::GetPipeline(const PipelineState& state) noexcept {
+	if (auto it = _pipelines.find(state); it != _pipelines.end()) {
+		return it->second;
+	}
+	
+	if (!Validate(state)) {
+		return nullptr;
+	}
+	
+	auto pipeline = _device.CreateGraphicsPipeline(state);
+	if (!pipeline) {
+		return nullptr;
+	}
+	
+	_pipelines.emplace(state, pipeline);
+	return pipeline;
+}
+
+void PipelineCache::Clear() noexcept {
+	for (auto& [state, pipeline] : _pipelines) {
+		_device.ReleaseGraphicsPipeline(pipeline);
+	}
+	_pipelines.clear();
+	
+	for (auto& [name, shader] : _shaders) {
+		_device.ReleaseShader(shader.handle);
+	}
+	_shaders.clear();
+	_reflections.clear();
+}
+
+bool PipelineCache::Validate(const PipelineState& state) const noexcept {
+	auto vertexReflection = GetReflection(state.vertexShader);
+	auto fragmentReflection = GetReflection(state.fragmentShader);
+	assert(vertexReflection && fragmentReflection && "shaders must come from the cache");
+	if (!vertexReflection || !fragmentReflection) {
+		return false;
+	}
+	
+	assert(state.vertexBufferCount <= PipelineState::kMaxVertexBuffers);
+	assert(state.vertexAttributeCount <= PipelineState::kMaxVertexAttributes);
+	auto buffers = state.vertexBuffers;
+	auto buffersEnd = buffers + std::min<size_t>(state.vertexBufferCount, PipelineState::kMaxVertexBuffers);
+	auto attributes = state.vertexAttributes;
+	auto attributesEnd = attributes + std::min<size_t>(state.vertexAttributeCount, PipelineState::kMaxVertexAttributes);
+	
+	// Every input of the vertex shader is fed by an attribute read from a bound buffer
+	for (auto& input : vertexReflection->inputs) {
+		auto attribute = std::find_if(attributes, attributesEnd, [&input](auto& a) { return a.location == input.location; });
+		if (attribute == attributesEnd) {
+			assert(false && "vertex shader input has no attribute");
+			return false;
+		}
+		auto buffer = std::find_if(buffers, buffersEnd, [attribute](auto& b) { return b.slot == attribute->bufferSlot; });
+		if (buffer == buffersEnd) {
+			assert(false && "vertex attribute reads an unbound buffer");
+			return false;
+		}
+	}
+	
+	return true;
+}
@@ -0,0 +1,254 @@
+#include <scenegraph/gpu/SdlGpuDevice.h>
+
+#include <SDL3/SDL.h>
+
+namespace {
+
+constexpr SDL_GPUBufferUsageFlags GetBufferUsageFlags(BufferUsage usage) noexcept {
+	switch (usage) {
+	case BufferUsage::Invalid: return 0;
+	case BufferUsage::Vertex: return SDL_GPU_BUFFERUSAGE_VERTEX;
+	case BufferUsage::Index: return SDL_GPU_BUFFERUSAGE_INDEX;
+	case BufferUsage::Indirect: return SDL_GPU_BUFFERUSAGE_INDIRECT;
+	case BufferUsage::GraphicsStorageRead: return SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+	case BufferUsage::ComputeStorageRead: return SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+	case BufferUsage::ComputeStorageWrite: return SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE;
+	}
+}
+
+constexpr SDL_GPUTransferBufferUsage GetTransferBufferUsage(TransferBufferUsage usage) noexcept {
+	switch (usage) {
+	case TransferBufferUsage::Upload: return SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+	case TransferBufferUsage::Download: return SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+	}
+}
+
+constexpr SDL_GPUShaderFormat GetShaderFormat(ShaderFormat format) noexcept {
+	SDL_GPUShaderFormat flags = SDL_GPU_SHADERFORMAT_INVALID;
+	if ((format & ShaderFormat::SpirV) != ShaderFormat::None) { flags |= SDL_GPU_SHADERFORMAT_SPIRV; }
+	if ((format & ShaderFormat::Dxil) != ShaderFormat::None) { flags |= SDL_GPU_SHADERFORMAT_DXIL; }
+	if ((format & ShaderFormat::MetalLib) != ShaderFormat::None) { flags |= SDL_GPU_SHADERFORMAT_METALLIB; }
+	return flags;
+}
+
+constexpr SDL_GPUShaderStage GetShaderStage(ShaderStage stage) noexcept {
+	switch (stage) {
+	case ShaderStage::Vertex: return SDL_GPU_SHADERSTAGE_VERTEX;
+	case ShaderStage::Fragment: return SDL_GPU_SHADERSTAGE_FRAGMENT;
+	}
+}
+
+constexpr SDL_GPUPrimitiveType GetPrimitiveType(PrimitiveType type) noexcept {
+	switch (type) {
+	case PrimitiveType::TriangleList: return SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+	case PrimitiveType::TriangleStrip: return SDL_GPU_PRIMITIVETYPE_TRIANGLESTRIP;
+	case PrimitiveType::LineList: return SDL_GPU_PRIMITIVETYPE_LINELIST;
+	case PrimitiveType::LineStrip: return SDL_GPU_PRIMITIVETYPE_LINESTRIP;
+	case PrimitiveType::PointList: return SDL_GPU_PRIMITIVETYPE_POINTLIST;
+	}
+}
+
+constexpr SDL_GPUVertexElementFormat GetVertexElementFormat(VertexElementFormat format) noexcept {
+	switch (format) {
+	case VertexElementFormat::Invalid: return SDL_GPU_VERTEXELEMENTFORMAT_INVALID;
+	case VertexElementFormat::Float: return SDL_GPU_VERTEXELEMENTFORMAT_FLOAT;
+	case VertexElementFormat::Float2: return SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
+	case VertexElementFormat::Float3: return SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
+	case VertexElementFormat::Float4: return SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4;
+	case VertexElementFormat::UByte4Norm: return SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
+	}
+}
+
+constexpr SDL_GPUColorTargetBlendState GetBlendState(BlendMode mode) noexcept {
+	auto blendState = SDL_GPUColorTargetBlendState {
+		.color_blend_op = SDL_GPU_BLENDOP_ADD,
+		.alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+		.enable_blend = mode != BlendMode::Opaque
+	};
+	switch (mode) {
+	case BlendMode::Opaque:
+		break;
+	case BlendMode::Alpha:
+		blendState.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+		blendState.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+		blendState.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+		blendState.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+		break;
+	case BlendMode::PremultipliedAlpha:
+		blendState.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+		blendState.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+		blendState.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+		blendState.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+		break;
+	case BlendMode::Additive:
+		blendState.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+		blendState.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+		blendState.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+		blendState.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+		break;
+	}
+	return blendState;
+}
+
+} // namespace
+
+void* SdlGpuDevice::CreateBuffer(BufferUsage usage, uint32_t size) noexcept {
+	SDL_GPUBufferCreateInfo createInfo = {
+		.usage = GetBufferUsageFlags(usage),
+		.size = size
+	};
+	auto buffer = SDL_CreateGPUBuffer(static_cast<SDL_GPUDevice*>(_device), &createInfo);
+	SDL_assert(buffer != nullptr);
+	return buffer;
+}
+
+void SdlGpuDevice::ReleaseBuffer(void* buffer) noexcept {
+	SDL_ReleaseGPUBuffer(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUBuffer*>(buffer));
+}
+
+void* SdlGpuDevice::CreateTransferBuffer(TransferBufferUsage usage, uint32_t size) noexcept {
+	SDL_GPUTransferBufferCreateInfo createInfo = {
+		.usage = GetTransferBufferUsage(usage),
+		.size = size
+	};
+	auto transferBuffer = SDL_CreateGPUTransferBuffer(static_cast<SDL_GPUDevice*>(_device), &createInfo);
+	SDL_assert(transferBuffer != nullptr);
+	return transferBuffer;
+}
+
+void SdlGpuDevice::ReleaseTransferBuffer(void* transferBuffer) noexcept {
+	SDL_ReleaseGPUTransferBuffer(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUTransferBuffer*>(transferBuffer));
+}
+
+void* SdlGpuDevice::MapTransferBuffer(void* transferBuffer, bool cycle) noexcept {
+	return SDL_MapGPUTransferBuffer(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUTransferBuffer*>(transferBuffer), cycle);
+}
+
+void SdlGpuDevice::UnmapTransferBuffer(void* transferBuffer) noexcept {
+	SDL_UnmapGPUTransferBuffer(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUTransferBuffer*>(transferBuffer));
+}
+
+ShaderFormat SdlGpuDevice::GetShaderFormats() noexcept {
+	auto flags = SDL_GetGPUShaderFormats(static_cast<SDL_GPUDevice*>(_device));
+	auto formats = ShaderFormat::None;
+	if (flags & SDL_GPU_SHADERFORMAT_SPIRV) { formats = formats | ShaderFormat::SpirV; }
+	if (flags & SDL_GPU_SHADERFORMAT_DXIL) { formats = formats | ShaderFormat::Dxil; }
+	if (flags & SDL_GPU_SHADERFORMAT_METALLIB) { formats = formats | ShaderFormat::MetalLib; }
+	return formats;
+}
+
+void* SdlGpuDevice::CreateShader(const ShaderCreateInfo& createInfo) noexcept {
+	auto& reflection = *createInfo.reflection;
+	SDL_GPUShaderCreateInfo shaderCreateInfo = {
+		.code_size = createInfo.codeSize,
+		.code = static_cast<const Uint8*>(createInfo.code),
+		// Metal renames the entry point, since main is reserved there
+		.entrypoint = createInfo.format == ShaderFormat::MetalLib ? "main0" : "main",
+		.format = GetShaderFormat(createInfo.format),
+		.stage = GetShaderStage(createInfo.stage),
+		.num_samplers = reflection.samplers,
+		.num_storage_textures = reflection.storageTextures,
+		.num_storage_buffers = reflection.storageBuffers,
+		.num_uniform_buffers = reflection.uniformBuffers
+	};
+	return SDL_CreateGPUShader(static_cast<SDL_GPUDevice*>(_device), &shaderCreateInfo);
+}
+
+void SdlGpuDevice::ReleaseShader(void* shader) noexcept {
+	SDL_ReleaseGPUShader(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUShader*>(shader));
+}
+
+void* SdlGpuDevice::CreateGraphicsPipeline(const PipelineState& state) noexcept {
+	SDL_GPUColorTargetDescription targetDescription = {
+		.format = static_cast<SDL_GPUTextureFormat>(state.colorTargetFormat),
+		.blend_state = GetBlendState(state.blendMode)
+	};
+	
+	SDL_GPUVertexBufferDescription vertexBuffers[PipelineState::kMaxVertexBuffers];
+	for (size_t i = 0; i < state.vertexBufferCount; ++i) {
+		auto& buffer = state.vertexBuffers[i];
+		vertexBuffers[i] = SDL_GPUVertexBufferDescription {
+			.slot = buffer.slot,
+			.pitch = buffer.pitch,
+			.input_rate = buffer.instanced ? SDL_GPU_VERTEXINPUTRATE_INSTANCE : SDL_GPU_VERTEXINPUTRATE_VERTEX,
+			.instance_step_rate = 0
+		};
+	}
+	
+	SDL_GPUVertexAttribute vertexAttributes[PipelineState::kMaxVertexAttributes];
+	for (size_t i = 0; i < state.vertexAttributeCount; ++i) {
+		auto& attribute = state.vertexAttributes[i];
+		vertexAttributes[i] = SDL_GPUVertexAttribute {
+			.location = attribute.location,
+			.buffer_slot = attribute.bufferSlot,
+			.format = GetVertexElementFormat(attribute.format),
+			.offset = attribute.offset
+		};
+	}
+	
+	SDL_GPUGraphicsPipelineCreateInfo createInfo = {
+		.vertex_shader = static_cast<SDL_GPUShader*>(const_cast<void*>(state.vertexShader)),
+		.fragment_shader = static_cast<SDL_GPUShader*>(const_cast<void*>(state.fragmentShader)),
+		.vertex_input_state = {
+			.vertex_buffer_descriptions = vertexBuffers,
+			.num_vertex_buffers = state.vertexBufferCount,
+			.vertex_attributes = vertexAttributes,
+			.num_vertex_attributes = state.vertexAttributeCount
+		},
+		.primitive_type = GetPrimitiveType(state.primitiveType),
+		.target_info = {
+			.color_target_descriptions = &targetDescription,
+			.num_color_targets = 1
+		}
+	};
+	return SDL_CreateGPUGraphicsPipeline(static_cast<SDL_GPUDevice*>(_device), &createInfo);
+}
+
+void SdlGpuDevice::ReleaseGraphicsPipeline(void* pipeline) noexcept {
+	SDL_ReleaseGPUGraphicsPipeline(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUGraphicsPipeline*>(pipeline));
+}
+
+void* SdlGpuDevice::AcquireCommandBuffer() noexcept {
+	return SDL_AcquireGPUCommandBuffer(static_cast<SDL_GPUDevice*>(_device));
+}
+
+void SdlGpuDevice::UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept {
+	auto copyPass = SDL_BeginGPUCopyPass(static_cast<SDL_GPUCommandBuffer*>(commandBuffer));
+	SDL_assert(copyPass != nullptr);
+	
+	for (size_t i = 0; i < count; ++i) {
+		auto& region = regions[i];
+		SDL_GPUTransferBufferLocation location = {
+			.transfer_buffer = static_cast<SDL_GPUTransferBuffer*>(region.transferBuffer),
+			.offset = region.transferOffset
+		};
+		SDL_GPUBufferRegion bufferRegion = {
+			.buffer = static_cast<SDL_GPUBuffer*>(region.buffer),
+			.offset = region.bufferOffset,
+			.size = region.size
+		};
+		// Cycling would discard contents of the buffer outside of the region
+		SDL_UploadToGPUBuffer(copyPass, &location, &bufferRegion, false);
+	}
+	
+	SDL_EndGPUCopyPass(copyPass);
+}
+
+void* SdlGpuDevice::Submit(void* commandBuffer) noexcept {
+	auto fence = SDL_SubmitGPUCommandBufferAndAcquireFence(static_cast<SDL_GPUCommandBuffer*>(commandBuffer));
+	SDL_assert(fence != nullptr);
+	return fence;
+}
+
+bool SdlGpuDevice::IsFenceSignaled(void* fence) noexcept {
+	return SDL_QueryGPUFence(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUFence*>(fence));
+}
+
+void SdlGpuDevice::WaitForFence(void* fence) noexcept {
+	auto gpuFence = static_cast<SDL_GPUFence*>(fence);
+	SDL_WaitForGPUFences(static_cast<SDL_GPUDevice*>(_device), true, &gpuFence, 1);
+}
+
+void SdlGpuDevice::ReleaseFence(void* fence) noexcept {
+	SDL_ReleaseGPUFence(static_cast<SDL_GPUDevice*>(_device), static_cast<SDL_GPUFence*>(fence));
+}
@@ -0,0 +1,219 @@
+#include <scenegraph/gpu/Shader.h>
+
+#include <cassert>
+
+namespace {
+
+///
+/// Reader of the JSON subset written by the shader compiler, values of unknown keys are skipped whatever they are
+///
+class JsonReader {
+public:
+	explicit JsonReader(std::string_view json) noexcept : _current(json.data()), _end(json.data() + json.size())
+	{
+	}
+	
+	bool AtEnd() noexcept {
+		SkipSpace();
+		return _current == _end;
+	}
+	
+	bool Consume(char c) noexcept {
+		SkipSpace();
+		if (_current == _end || *_current != c) {
+			return false;
+		}
+		++_current;
+		return true;
+	}
+	
+	bool ReadString(std::string* value) noexcept {
+		if (!Consume('"')) {
+			return false;
+		}
+		value->clear();
+		while (_current != _end && *_current != '"') {
+			auto c = *_current++;
+			if (c == '\\') {
+				if (_current == _end) {
+					return false;
+				}
+				// Names are plain identifiers, escapes other than single characters are kept as they are
+				c = *_current++;
+				switch (c) {
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'u': value->push_back('\\'); break;
+				}
+			}
+			value->push_back(c);
+		}
+		return Consume('"');
+	}
+	
+	bool ReadUint(uint32_t* value) noexcept {
+		SkipSpace();
+		if (_current == _end || *_current < '0' || *_current > '9') {
+			return false;
+		}
+		uint64_t result = 0;
+		while (_current != _end && *_current >= '0' && *_current <= '9') {
+			result = result * 10 + static_cast<uint64_t>(*_current++ - '0');
+			if (result > UINT32_MAX) {
+				return false;
+			}
+		}
+		*value = static_cast<uint32_t>(result);
+		return true;
+	}
+	
+	// Reads an object calling the function for each key positioned at its value
+	template <typename F>
+	bool ReadObject(F&& readValue) noexcept {
+		if (!Consume('{')) {
+			return false;
+		}
+		if (Consume('}')) {
+			return true;
+		}
+		std::string key;
+		do {
+			if (!ReadString(&key) || !Consume(':') || !readValue(key)) {
+				return false;
+			}
+		} while (Consume(','));
+		return Consume('}');
+	}
+	
+	// Reads an array calling the function for each element
+	template <typename F>
+	bool ReadArray(F&& readElement) noexcept {
+		if (!Consume('[')) {
+			return false;
+		}
+		if (Consume(']')) {
+			return true;
+		}
+		do {
+			if (!readElement()) {
+				return false;
+			}
+		} while (Consume(','));
+		return Consume(']');
+	}
+	
+	bool SkipValue() noexcept {
+		SkipSpace();
+		if (_current == _end) {
+			return false;
+		}
+		
+		std::string string;
+		switch (*_current) {
+		case '"':
+			return ReadString(&string);
+		case '{':
+			return ReadObject([this](const std::string&) { return SkipValue(); });
+		case '[':
+			return ReadArray([this] { return SkipValue(); });
+		}
+		
+		// Numbers and literals run up to the next delimiter
+		auto start = _current;
+		while (_current != _end && *_current != ',' && *_current != '}' && *_current != ']' && !IsSpace(*_current)) {
+			++_current;
+		}
+		return _current != start;
+	}
+	
+private:
+	static bool IsSpace(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+	
+	void SkipSpace() noexcept {
+		while (_current != _end && IsSpace(*_current)) {
+			++_current;
+		}
+	}
+	
+private:
+	const char* _current;
+	const char* _end;
+};
+
+bool ReadVariables(JsonReader& reader, std::vector<ShaderVariable>* variables) noexcept {
+	variables->clear();
+	return reader.ReadArray([&] {
+		ShaderVariable variable {};
+		bool read = reader.ReadObject([&](const std::string& key) {
+			if (key == "name") {
+				return reader.ReadString(&variable.name);
+			}
+			if (key == "type") {
+				return reader.ReadString(&variable.type);
+			}
+			if (key == "location") {
+				return reader.ReadUint(&variable.location);
+			}
+			return reader.SkipValue();
+		});
+		variables->push_back(std::move(variable));
+		return read;
+	});
+}
+
+} // namespace
+
+ShaderFormat ShaderFormatSelect(ShaderFormat supported) noexcept {
+	// Devices supporting several formats are Vulkan ones, which take SPIR-V
+	for (auto format : {ShaderFormat::SpirV, ShaderFormat::Dxil, ShaderFormat::MetalLib}) {
+		if ((supported & format) != ShaderFormat::None) {
+			return format;
+		}
+	}
+	return ShaderFormat::None;
+}
+
+const char* ShaderFormatExtension(ShaderFormat format) noexcept {
+	switch (format) {
+	case ShaderFormat::SpirV: return "spv";
+	case ShaderFormat::Dxil: return "dxil";
+	case ShaderFormat::MetalLib: return "air";
+	default: break;
+	}
+	assert(false && "single format expected");
+	return "";
+}
+
+bool ShaderReflectionParse(std::string_view json, ShaderReflection* reflection) noexcept {
+	assert(reflection);
+	
+	*reflection = ShaderReflection {};
+	
+	JsonReader reader(json);
+	bool read = reader.ReadObject([&](const std::string& key) {
+		if (key == "samplers") {
+			return reader.ReadUint(&reflection->samplers);
+		}
+		if (key == "storage_textures") {
+			return reader.ReadUint(&reflection->storageTextures);
+		}
+		if (key == "storage_buffers") {
+			return reader.ReadUint(&reflection->storageBuffers);
+		}
+		if (key == "uniform_buffers") {
+			return reader.ReadUint(&reflection->uniformBuffers);
+		}
+		if (key == "inputs") {
+			return ReadVariables(reader, &reflection->inputs);
+		}
+		if (key == "outputs") {
+			return ReadVariables(reader, &reflection->outputs);
+		}
+		return reader.SkipValue();
+	});
+	
+	return read && reader.AtEnd();
+}
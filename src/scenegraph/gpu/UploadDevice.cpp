@@ -0,0 +1,38 @@
+#include <scenegraph/gpu/UploadDevice.h>
+#include <scenegraph/gpu/GpuDevice.h>
+
+void* GpuUploadDevice::CreateTransferBuffer(uint32_t size) noexcept {
+	return _device.CreateTransferBuffer(TransferBufferUsage::Upload, size);
+}
+
+void GpuUploadDevice::ReleaseTransferBuffer(void* transferBuffer) noexcept {
+	_device.ReleaseTransferBuffer(transferBuffer);
+}
+
+void* GpuUploadDevice::MapTransferBuffer(void* transferBuffer) noexcept {
+	return _device.MapTransferBuffer(transferBuffer, false);
+}
+
+void GpuUploadDevice::UnmapTransferBuffer(void* transferBuffer) noexcept {
+	_device.UnmapTransferBuffer(transferBuffer);
+}
+
+void GpuUploadDevice::UploadToBuffers(void* commandBuffer, const UploadRegion* regions, size_t count) noexcept {
+	_device.UploadToBuffers(commandBuffer, regions, count);
+}
+
+void* GpuUploadDevice::Submit(void* commandBuffer) noexcept {
+	return _device.Submit(commandBuffer);
+}
+
+bool GpuUploadDevice::IsFenceSignaled(void* fence) noexcept {
+	return _device.IsFenceSignaled(fence);
+}
+
+void GpuUploadDevice::WaitForFence(void* fence) noexcept {
+	_device.WaitForFence(fence);
+}
+
+void GpuUploadDevice::ReleaseFence(void* fence) noexcept {
+	_device.ReleaseFence(fence);
+}
@@ -0,0 +1,223 @@
+#include <scenegraph/imaging/MipChain.h>
+#include <scenegraph/profiling/Trace.h>
+#include "../math/Simd.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+float SrgbToLinear(float value) noexcept {
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+struct SrgbTables {
+	static constexpr uint32_t kStartCount = 4096;
+	
+	float toLinear[256];
+	// Linear values half way between neighbour codes, a value encodes to the number of thresholds not above it
+	float thresholds[256];
+	// Code at the start of each interval of linear values, values in an interval encode to it or the next one
+	uint8_t start[kStartCount];
+};
+
+const SrgbTables& GetSrgbTables() noexcept {
+	static const SrgbTables tables = [] {
+		SrgbTables t;
+		for (int i = 0; i < 256; ++i) {
+			t.toLinear[i] = SrgbToLinear(static_cast<float>(i) / 255.0f);
+			t.thresholds[i] = i < 255 ? SrgbToLinear((static_cast<float>(i) + 0.5f) / 255.0f) : std::numeric_limits<float>::infinity();
+		}
+		uint8_t code = 0;
+		for (uint32_t i = 0; i < SrgbTables::kStartCount; ++i) {
+			while (t.thresholds[code] <= static_cast<float>(i) / SrgbTables::kStartCount) {
+				++code;
+			}
+			assert(i == 0 || code - t.start[i - 1] <= 1);
+			t.start[i] = code;
+		}
+		return t;
+	}();
+	return tables;
+}
+
+///
+/// Conversion of 8-bit channels to linear values and back, rounding to the nearest sRGB code
+///
+class ChannelCodec {
+public:
+	explicit ChannelCodec(bool srgb) noexcept : _tables(GetSrgbTables()), _srgb(srgb)
+	{
+	}
+	
+	float Decode(uint8_t code) const noexcept {
+		return _srgb ? _tables.toLinear[code] : static_cast<float>(code) * (1.0f / 255.0f);
+	}
+	
+	uint8_t Encode(float value) const noexcept {
+		if (!_srgb) {
+			return EncodeLinear(value);
+		}
+		// One comparison from the start of the interval of the value, the last threshold is infinite
+		value = std::clamp(value, 0.0f, 1.0f);
+		auto interval = std::min(static_cast<uint32_t>(value * SrgbTables::kStartCount), SrgbTables::kStartCount - 1);
+		uint32_t code = _tables.start[interval];
+		code += _tables.thresholds[code] <= value ? 1 : 0;
+		return static_cast<uint8_t>(code);
+	}
+	
+	static uint8_t EncodeLinear(float value) noexcept {
+		return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+	
+private:
+	const SrgbTables& _tables;
+	bool _srgb;
+};
+
+constexpr uint32_t Quantize(uint8_t value, uint32_t max) noexcept {
+	return (value * max + 127) / 255;
+}
+
+// Colors are premultiplied as they are encoded, textures are sampled and blended without decoding them
+constexpr Color Premultiply(Color color) noexcept {
+	auto alpha = color.rgba.a;
+	return ColorMake(static_cast<uint8_t>(Quantize(color.rgba.r, alpha)), static_cast<uint8_t>(Quantize(color.rgba.g, alpha)),
+		static_cast<uint8_t>(Quantize(color.rgba.b, alpha)), alpha);
+}
+
+void Pack(Color color, PixelFormat format, std::byte* target) noexcept {
+	uint16_t word = 0;
+	switch (format) {
+	case PixelFormat::RGBA8:
+		std::memcpy(target, &color, sizeof(color));
+		return;
+	case PixelFormat::RGB565:
+		word = static_cast<uint16_t>(Quantize(color.rgba.r, 31) << 11 | Quantize(color.rgba.g, 63) << 5 | Quantize(color.rgba.b, 31));
+		break;
+	case PixelFormat::RGBA4444:
+		word = static_cast<uint16_t>(Quantize(color.rgba.a, 15) << 12 | Quantize(color.rgba.r, 15) << 8 |
+			Quantize(color.rgba.g, 15) << 4 | Quantize(color.rgba.b, 15));
+		break;
+	}
+	std::memcpy(target, &word, sizeof(word));
+}
+
+void Linearize(const Color* pixels, size_t count, const ChannelCodec& codec, float* texels) noexcept {
+	for (size_t i = 0; i < count; ++i, texels += 4) {
+		auto color = pixels[i];
+		auto alpha = static_cast<float>(color.rgba.a) * (1.0f / 255.0f);
+		texels[0] = codec.Decode(color.rgba.r) * alpha;
+		texels[1] = codec.Decode(color.rgba.g) * alpha;
+		texels[2] = codec.Decode(color.rgba.b) * alpha;
+		texels[3] = alpha;
+	}
+}
+
+void Encode(const float* texels, size_t count, const ChannelCodec& codec, bool premultiplied, PixelFormat format, std::byte* target) noexcept {
+	auto pixelSize = PixelFormatSize(format);
+	for (size_t i = 0; i < count; ++i, texels += 4, target += pixelSize) {
+		auto alpha = texels[3];
+		// Texels without coverage have no color
+		auto scale = alpha <= 0 ? 1.0f : 1.0f / alpha;
+		auto color = ColorMake(codec.Encode(texels[0] * scale), codec.Encode(texels[1] * scale), codec.Encode(texels[2] * scale),
+			ChannelCodec::EncodeLinear(alpha));
+		Pack(premultiplied ? Premultiply(color) : color, format, target);
+	}
+}
+
+void Downsample(const float* source, uint32_t width, uint32_t height, float* target) noexcept {
+	auto targetWidth = std::max(width / 2, 1u);
+	auto targetHeight = std::max(height / 2, 1u);
+	
+	for (uint32_t y = 0; y < targetHeight; ++y) {
+		// Sides of size one are filtered in one direction only
+		auto row0 = source + size_t{std::min(2 * y, height - 1)} * width * 4;
+		auto row1 = source + size_t{std::min(2 * y + 1, height - 1)} * width * 4;
+		for (uint32_t x = 0; x < targetWidth; ++x, target += 4) {
+			auto x0 = size_t{std::min(2 * x, width - 1)} * 4;
+			auto x1 = size_t{std::min(2 * x + 1, width - 1)} * 4;
+#if SIMD_FLOAT4_ENABLED
+			auto sum = Float4Load(row0 + x0) + Float4Load(row0 + x1) + Float4Load(row1 + x0) + Float4Load(row1 + x1);
+			Float4Store(target, sum * 0.25f);
+#else
+			for (size_t c = 0; c < 4; ++c) {
+				target[c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+			}
+#endif
+		}
+	}
+}
+
+} // namespace
+
+uint32_t MipLevelCount(uint32_t width, uint32_t height) noexcept {
+	return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+}
+
+bool ImageIsOpaque(const Color* pixels, size_t count) noexcept {
+	return std::all_of(pixels, pixels + count, [](Color color) { return color.rgba.a == 0xff; });
+}
+
+void ImagePremultiplyAlpha(Color* pixels, size_t count) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		if (pixels[i].rgba.a != 0xff) {
+			pixels[i] = Premultiply(pixels[i]);
+		}
+	}
+}
+
+bool MipChain::Build(const Color* pixels, uint32_t width, uint32_t height, const MipChainOptions& options) noexcept {
+	TRACE_ZONE("MipChain::Build");
+	
+	_levels.clear();
+	_data.clear();
+	
+	assert(pixels || !width || !height);
+	if (!pixels || !width || !height) {
+		return false;
+	}
+	
+	_format = options.format;
+	auto pixelSize = PixelFormatSize(_format);
+	auto levelCount = options.mipmaps ? MipLevelCount(width, height) : 1;
+	
+	size_t offset = 0;
+	for (uint32_t level = 0, w = width, h = height; level < levelCount; ++level) {
+		auto size = size_t{w} * h * pixelSize;
+		_levels.push_back(MipLevel {w, h, offset, size});
+		offset += size;
+		w = std::max(w / 2, 1u);
+		h = std::max(h / 2, 1u);
+	}
+	_data.resize(offset);
+	
+	// Colors of the image are packed as they are, without a round trip through linear space
+	auto count = size_t{width} * height;
+	for (size_t i = 0; i < count; ++i) {
+		Pack(options.premultiplyAlpha ? Premultiply(pixels[i]) : pixels[i], _format, _data.data() + i * pixelSize);
+	}
+	if (levelCount == 1) {
+		return true;
+	}
+	
+	ChannelCodec codec(options.srgb);
+	_texels.resize(count * 4);
+	Linearize(pixels, count, codec, _texels.data());
+	
+	for (size_t level = 1; level < levelCount; ++level) {
+		auto& source = _levels[level - 1];
+		auto& target = _levels[level];
+		auto targetCount = size_t{target.width} * target.height;
+		_filtered.resize(targetCount * 4);
+		Downsample(_texels.data(), source.width, source.height, _filtered.data());
+		Encode(_filtered.data(), targetCount, codec, options.premultiplyAlpha, _format, _data.data() + target.offset);
+		std::swap(_texels, _filtered);
+	}
+	
+	return true;
+}
@@ -1,11 +1,22 @@
 #include <scenegraph/ApplicationContext.h>
 #include <scenegraph/SystemContext.h>
 
-#include <scenegraph/utils/ScopeGuard.h>
 #include <scenegraph/math/Matrix4.h>
 #include <scenegraph/math/Matrix32.h>
 #include <scenegraph/math/Vector3.h>
 #include <scenegraph/imaging/Color.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/components/SpriteComponent.h>
+#include <scenegraph/render/SpriteInstanceBuffer.h>
+#include <scenegraph/render/UploadManager.h>
+#include <scenegraph/render/RenderQueue.h>
+#include <scenegraph/gpu/UploadDevice.h>
+#include <scenegraph/gpu/SdlGpuDevice.h>
+#include <scenegraph/gpu/PipelineCache.h>
+
+#include <bit>
+#include <memory>
 
 #define SDL_MAIN_USE_CALLBACKS 1
 #include <SDL3/SDL.h>
@@ -13,21 +24,6 @@
 
 #include "Imaging.h"
 
-static SDL_GPUShader* LoadShader(SDL_GPUDevice* device_, SDL_GPUShaderCreateInfo* createInfo, const char* filename) {
-	size_t size;
-	auto data = SDL_LoadFile(filename, &size);
-	if (!data) {
-		return nullptr;
-	}
-	
-	ON_SCOPE_EXIT(&data) { SDL_free(data); };
-	
-	createInfo->code = static_cast<Uint8*>(data);
-	createInfo->code_size = size;
-	
-	return SDL_CreateGPUShader(device_, createInfo);
-}
-
 static SDL_Window* window;
 static SDL_GPUDevice* device;
 static SDL_GPUGraphicsPipeline* pipeline;
@@ -35,161 +31,70 @@ static SDL_GPUGraphicsPipeline* spritePipeline;
 static SDL_GPUBuffer* vertexBuffer;
 static SDL_GPUBuffer* colorBuffer;
 static SDL_GPUBuffer* spriteDataBuffer;
-static SDL_GPUTransferBuffer* transferBuffer;
-static SDL_GPUTransferBuffer* spriteDataTransferBuffer;
 static SDL_GPUSampler* sampler;
 static SDL_GPUTexture* texture;
-
-struct SpriteInstance {
-	Matrix32 transform;
-	float pivotX;
-	float pivotY;
-	FloatColor color;
-	float texU, texV, texW, texH;
-};
+static std::unique_ptr<Scene> scene;
+static SpriteInstanceBuffer spriteInstances;
+static RenderQueue renderQueue;
+static std::unique_ptr<SdlGpuDevice> gpuDevice;
+static std::unique_ptr<PipelineCache> pipelines;
+static std::unique_ptr<GpuUploadDevice> uploadDevice;
+static std::unique_ptr<UploadManager> uploads;
+static uint32_t spriteCapacity = 1024;
 
 template <typename T>
-constexpr SDL_GPUVertexElementFormat AttributeFormat = SDL_GPU_VERTEXELEMENTFORMAT_INVALID;
+constexpr VertexElementFormat AttributeFormat = VertexElementFormat::Invalid;
 
-template<> constexpr SDL_GPUVertexElementFormat AttributeFormat<Vector3> = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
-template<> constexpr SDL_GPUVertexElementFormat AttributeFormat<Color> = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
+template<> constexpr VertexElementFormat AttributeFormat<Vector3> = VertexElementFormat::Float3;
+template<> constexpr VertexElementFormat AttributeFormat<Color> = VertexElementFormat::UByte4Norm;
 
 static SDL_AppResult ExampleInitialize() {
-	// Create the shaders
-	SDL_GPUShaderCreateInfo vertexShaderCreateInfo = {
-		.format = SDL_GPU_SHADERFORMAT_METALLIB,
-		.stage = SDL_GPU_SHADERSTAGE_VERTEX,
-		.num_uniform_buffers = 1
-	};
-	SDL_GPUShader* vertexShader = LoadShader(device, &vertexShaderCreateInfo, "assets/shaders/PositionColorTransform.vert.air");
-	if (!vertexShader) {
-		SDL_Log("Failed to create vertex shader!");
-		return SDL_APP_FAILURE;
-	}
-	
-	SDL_GPUShaderCreateInfo fragmentShaderCreateInfo = {
-		.format = SDL_GPU_SHADERFORMAT_METALLIB,
-		.stage = SDL_GPU_SHADERSTAGE_FRAGMENT
-	};
-	SDL_GPUShader* fragmentShader = LoadShader(device, &fragmentShaderCreateInfo, "assets/shaders/SolidColor.frag.air");
-	if (!fragmentShader) {
-		SDL_Log("Failed to create fragment shader!");
-		return SDL_APP_FAILURE;
-	}
-	
-	SDL_GPUShaderCreateInfo spriteVertexShaderCreateInfo = {
-		.format = SDL_GPU_SHADERFORMAT_METALLIB,
-		.stage = SDL_GPU_SHADERSTAGE_VERTEX,
-		.num_uniform_buffers = 1,
-		.num_storage_buffers = 1
-	};
-	SDL_GPUShader* spriteVertexShader = LoadShader(device, &spriteVertexShaderCreateInfo, "assets/shaders/PullSpriteBatch.vert.air");
-	if (!spriteVertexShader) {
-		SDL_Log("Failed to create vertex shader!");
-		return SDL_APP_FAILURE;
-	}
-
-	SDL_GPUShaderCreateInfo spriteFragmentShaderCreateInfo = {
-		.format = SDL_GPU_SHADERFORMAT_METALLIB,
-		.stage = SDL_GPU_SHADERSTAGE_FRAGMENT,
-		.num_samplers = 1
-	};
-	SDL_GPUShader* spriteFragmentShader = LoadShader(device, &spriteFragmentShaderCreateInfo, "assets/shaders/TexturedQuadColor.frag.air");
-	if (!fragmentShader) {
-		SDL_Log("Failed to create fragment shader!");
+	gpuDevice = std::make_unique<SdlGpuDevice>(device);
+	
+	// Create the shaders, the format of the device is picked and resource counts come from reflection
+	pipelines = std::make_unique<PipelineCache>(*gpuDevice, "assets/shaders");
+	auto vertexShader = pipelines->LoadShader("PositionColorTransform.vert");
+	auto fragmentShader = pipelines->LoadShader("SolidColor.frag");
+	auto spriteVertexShader = pipelines->LoadShader("PullSpriteBatch.vert");
+	auto spriteFragmentShader = pipelines->LoadShader("TexturedQuadColor.frag");
+	if (!vertexShader || !fragmentShader || !spriteVertexShader || !spriteFragmentShader) {
+		SDL_Log("Failed to create shaders!");
 		return SDL_APP_FAILURE;
 	}
-
-	// Create the pipeline
-	SDL_GPUColorTargetDescription targetDescriptions[1] = {{
-		.format = SDL_GetGPUSwapchainTextureFormat(device, window),
-		.blend_state = {
-			.enable_blend = true,
-			.color_blend_op = SDL_GPU_BLENDOP_ADD,
-			.alpha_blend_op = SDL_GPU_BLENDOP_ADD,
-			.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
-			.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
-			.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
-			.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA
-		}
-	}};
 	
-	SDL_GPUVertexBufferDescription vertexBufferDescriptions[] = {
-		{
-			.slot = 0,
-			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
-			.instance_step_rate = 0,
-			.pitch = sizeof(Vector3)
-		},
-		{
-			.slot = 1,
-			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
-			.instance_step_rate = 0,
-			.pitch = sizeof(Color)
-		}
-	};
-	
-	SDL_GPUVertexAttribute vertexAttributes[] = {
-		{
-			.location = 0,
-			.buffer_slot = 0,
-			.format = AttributeFormat<Vector3>,
-			.offset = 0
-		},
-		{
-			.location = 1,
-			.buffer_slot = 1,
-			.format = AttributeFormat<Color>,
-			.offset = 0
-		}
-	};
-	
-	SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
-		.target_info = {
-			.color_target_descriptions = targetDescriptions,
-			.num_color_targets = SDL_arraysize(targetDescriptions)
-		},
-		// This is set up to match the vertex shader layout!
-		.vertex_input_state = {
-			.vertex_buffer_descriptions = vertexBufferDescriptions,
-			.num_vertex_buffers = SDL_arraysize(vertexBufferDescriptions),
-			.vertex_attributes = vertexAttributes,
-			.num_vertex_attributes = SDL_arraysize(vertexAttributes)
-		},
-		.primitive_type = SDL_GPU_PRIMITIVETYPE_LINELIST,
-		.vertex_shader = vertexShader,
-		.fragment_shader = fragmentShader
-	};
-	
-	pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipelineCreateInfo);
+	// Create the pipelines
+	PipelineState lineState;
+	lineState.vertexShader = vertexShader;
+	lineState.fragmentShader = fragmentShader;
+	lineState.colorTargetFormat = static_cast<uint32_t>(SDL_GetGPUSwapchainTextureFormat(device, window));
+	lineState.primitiveType = PrimitiveType::LineList;
+	lineState.blendMode = BlendMode::PremultipliedAlpha;
+	// This is set up to match the vertex shader layout!
+	lineState.vertexBufferCount = 2;
+	lineState.vertexBuffers[0] = {.pitch = sizeof(Vector3), .slot = 0};
+	lineState.vertexBuffers[1] = {.pitch = sizeof(Color), .slot = 1};
+	lineState.vertexAttributeCount = 2;
+	lineState.vertexAttributes[0] = {.offset = 0, .location = 0, .bufferSlot = 0, .format = AttributeFormat<Vector3>};
+	lineState.vertexAttributes[1] = {.offset = 0, .location = 1, .bufferSlot = 1, .format = AttributeFormat<Color>};
+	
+	pipeline = static_cast<SDL_GPUGraphicsPipeline*>(pipelines->GetPipeline(lineState));
 	if (!pipeline) {
 		SDL_Log("Failed to create line pipeline");
-        return SDL_APP_FAILURE;
-    }
+		return SDL_APP_FAILURE;
+	}
 	
-	SDL_GPUGraphicsPipelineCreateInfo spritePipelineCreateInfo = {
-		.target_info = {
-			.color_target_descriptions = targetDescriptions,
-			.num_color_targets = SDL_arraysize(targetDescriptions)
-		},
-		//.rasterizer_state
-		//.multisample_.depth_stencil_state.enable_depth_test
-		.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
-		.vertex_shader = spriteVertexShader,
-		.fragment_shader = spriteFragmentShader
-	};
+	PipelineState spriteState;
+	spriteState.vertexShader = spriteVertexShader;
+	spriteState.fragmentShader = spriteFragmentShader;
+	spriteState.colorTargetFormat = lineState.colorTargetFormat;
+	spriteState.primitiveType = PrimitiveType::TriangleList;
+	spriteState.blendMode = BlendMode::PremultipliedAlpha;
 	
-	spritePipeline = SDL_CreateGPUGraphicsPipeline(device, &spritePipelineCreateInfo);
+	spritePipeline = static_cast<SDL_GPUGraphicsPipeline*>(pipelines->GetPipeline(spriteState));
 	if (!spritePipeline) {
 		SDL_Log("Failed to create sprite pipeline");
-        return SDL_APP_FAILURE;
-    }
-	
-	// Clean up shader resources
-	SDL_ReleaseGPUShader(device, vertexShader);
-	SDL_ReleaseGPUShader(device, fragmentShader);
-	SDL_ReleaseGPUShader(device, spriteVertexShader);
-	SDL_ReleaseGPUShader(device, spriteFragmentShader);
+		return SDL_APP_FAILURE;
+	}
 	
 	// Create the vertex buffer
 	SDL_GPUBufferCreateInfo bufferCreateInfo1 = {
@@ -205,22 +110,13 @@ static SDL_AppResult ExampleInitialize() {
 	};
 	colorBuffer = SDL_CreateGPUBuffer(device, &bufferCreateInfo2);
 	
-	// To get data into the vertex buffer, we have to use a transfer buffer
-	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo = {
-		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-		.size = (sizeof(Vector3) + sizeof(Color)) * 1024
-	};
-	transferBuffer = SDL_CreateGPUTransferBuffer(device, &transferBufferCreateInfo);
-	
-	SDL_GPUTransferBufferCreateInfo spriteTransferBufferCreateInfo = {
-		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-		.size = sizeof(SpriteInstance) * 1024
-	};
-	spriteDataTransferBuffer = SDL_CreateGPUTransferBuffer(device, &spriteTransferBufferCreateInfo);
+	// Data of every frame gets into the buffers through the upload ring
+	uploadDevice = std::make_unique<GpuUploadDevice>(*gpuDevice);
+	uploads = std::make_unique<UploadManager>(*uploadDevice);
 	
 	SDL_GPUBufferCreateInfo spriteBufferCreateInfo = {
 		.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
-		.size = sizeof(SpriteInstance) * 1024
+		.size = static_cast<Uint32>(sizeof(SpriteInstance) * spriteCapacity)
 	};
 	spriteDataBuffer = SDL_CreateGPUBuffer(device, &spriteBufferCreateInfo);
 	
@@ -230,22 +126,48 @@ static SDL_AppResult ExampleInitialize() {
 		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR,
 		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
 		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
-		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		// Levels of the texture are only sampled up to the maximum level of detail
+		.max_lod = 1000.0f
 	};
 	sampler = SDL_CreateGPUSampler(device, &samplerCreateInfo);
 	
 	SDL_GPUTextureQOILoader loader(device);
-	texture = loader.LoadFromFile("assets/textures/checkerboard.qoi");
+	// Sprites are blended premultiplied and drawn at many scales
+	texture = loader.LoadFromFile("assets/textures/checkerboard.qoi", {.mipmaps = true, .premultiplyAlpha = true});
 	if (!texture) {
 		SDL_Log("Failed to load texture");
 		return SDL_APP_FAILURE;
 	}
-	SDL_Log("Loaded %dx%dx%d texture", loader.Width(), loader.Height(), loader.Channels());
+	SDL_Log("Loaded %dx%dx%d texture with %d levels", loader.Width(), loader.Height(), loader.Channels(), loader.Levels());
+	
+	// Sprites of the scene, only changed instances are uploaded every frame
+	scene = std::make_unique<Scene>();
+	auto addSprite = [](const Transform2D& transform, float size, const FloatColor& color) {
+		auto object = scene->AddObject();
+		object.AddComponent<Transform2DComponent>()->localTransform = transform;
+		auto sprite = object.AddComponent<SpriteComponent>();
+		sprite->texture = texture;
+		sprite->pipeline = spritePipeline;
+		sprite->size = Vector2Make(size, size);
+		sprite->color = color;
+		sprite->textureRect = RectMake(Vector2Make(0.5f / 256, 0.5f / 256), Vector2Make(1, 1));
+	};
+	
+	constexpr int kNumSprites = 21;
+	for (int i = 0; i < kNumSprites - 1; i++) {
+		auto angle = SDL_PI_F / (kNumSprites - 1) * i;
+		addSprite({ .sx = 1, .sy = 1, .shearX = 0.5f, .rad = angle, .tx = 100 + i * 50.0f, .ty = 100 }, 32,
+			{ (255 - 10 * i) / 255.0f, (255 - 5 * i) / 255.0f, 1.0f, 1.0f });
+	}
+	addSprite({ .sx = 1, .sy = 1, .tx = 100, .ty = 100 }, 128, FloatColorMakeWhite());
 	
 	return SDL_APP_CONTINUE;
 }
 
 static SDL_AppResult ExampleIterate() {
+	uploads->BeginFrame();
+	
     auto cmdbuf = SDL_AcquireGPUCommandBuffer(device);
     if (!cmdbuf) {
         SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
@@ -268,16 +190,14 @@ static SDL_AppResult ExampleIterate() {
 		Matrix4 viewProjectionMatrix = Matrix4MakeOrthographicOffCenter(0, width, height, 0, 0.0f, 1.0f);
 		SDL_PushGPUVertexUniformData(cmdbuf, 0, &viewProjectionMatrix, sizeof(Matrix4));
 		
+		// Write geometry of lines to the upload ring
 		{
-			SDL_PushGPUDebugGroup(cmdbuf, "lines");
-			
 			float l = 0.5f;
 			float r = width;
 			float t = 0.5f;
 			float b = height;
 			
-			// Write geometry to the transfer data
-			auto vertices = static_cast<Vector3*>(SDL_MapGPUTransferBuffer(device, transferBuffer, true));
+			auto vertices = static_cast<Vector3*>(uploads->Upload(vertexBuffer, 0, sizeof(Vector3) * 8));
 			*vertices++ = Vector3Make(l, b, 0);
 			*vertices++ = Vector3Make(l, t, 0);
 			*vertices++ = Vector3Make(l, t, 0);
@@ -287,7 +207,7 @@ static SDL_AppResult ExampleIterate() {
 			*vertices++ = Vector3Make(r, b, 0);
 			*vertices++ = Vector3Make(l, b, 0);
 			
-			auto colors = reinterpret_cast<Color*>(vertices);
+			auto colors = static_cast<Color*>(uploads->Upload(colorBuffer, 0, sizeof(Color) * 8));
 			*colors++ = ColorMake(255, 255, 255, 255);
 			*colors++ = ColorMake(255, 255, 255, 255);
 			*colors++ = ColorMake(  0, 255,   0, 255);
@@ -296,34 +216,34 @@ static SDL_AppResult ExampleIterate() {
 			*colors++ = ColorMake(  0,   0, 255, 255);
 			*colors++ = ColorMake(255,   0,   0, 255);
 			*colors++ = ColorMake(255,   0,   0, 255);
-			SDL_UnmapGPUTransferBuffer(device, transferBuffer);
-			
-			// Upload the transfer data to the vertex buffer
-			SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(cmdbuf);
-			
-			SDL_GPUTransferBufferLocation transferBufferLocation1 = {
-				.transfer_buffer = transferBuffer,
-				.offset = 0
-			};
-			SDL_GPUBufferRegion bufferRegion1 = {
-				.buffer = vertexBuffer,
-				.offset = 0,
-				.size = sizeof(Vector3) * 8
-			};
-			SDL_UploadToGPUBuffer(copyPass, &transferBufferLocation1, &bufferRegion1, true);
+		}
+		
+		// Write changed sprite instances, the storage buffer grows to fit all of them
+		Transform2DComponent::UpdateHierarchy(scene->GetRootObject());
+		spriteInstances.Update(scene->GetRootObject());
+		
+		auto numSprites = static_cast<uint32_t>(spriteInstances.GetInstances().size());
+		
+		if (numSprites > spriteCapacity) {
+			// Buffer is released once frames in flight stop using it
+			SDL_ReleaseGPUBuffer(device, spriteDataBuffer);
+			spriteCapacity = std::bit_ceil(numSprites);
 			
-			SDL_GPUTransferBufferLocation transferBufferLocation2 = {
-				.transfer_buffer = transferBuffer,
-				.offset = sizeof(Vector3) * 8
-			};
-			SDL_GPUBufferRegion bufferRegion2 = {
-				.buffer = colorBuffer,
-				.offset = 0,
-				.size = sizeof(Color) * 8
+			SDL_GPUBufferCreateInfo spriteBufferCreateInfo = {
+				.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+				.size = static_cast<Uint32>(sizeof(SpriteInstance) * spriteCapacity)
 			};
-			SDL_UploadToGPUBuffer(copyPass, &transferBufferLocation2, &bufferRegion2, true);
-			
-			SDL_EndGPUCopyPass(copyPass);
+			spriteDataBuffer = SDL_CreateGPUBuffer(device, &spriteBufferCreateInfo);
+			spriteInstances.Invalidate();
+		}
+		
+		spriteInstances.Upload(*uploads, spriteDataBuffer);
+		
+		// All uploads of the frame in one copy pass
+		uploads->Flush(cmdbuf);
+		
+		{
+			SDL_PushGPUDebugGroup(cmdbuf, "lines");
 			
 			// Render geometry
 			SDL_GPUColorTargetInfo colorTargetInfos[1] = {{
@@ -355,48 +275,6 @@ static SDL_AppResult ExampleIterate() {
 		{
 			SDL_PushGPUDebugGroup(cmdbuf, "sprites");
 			
-			constexpr int kNumSprites = 21;
-			SpriteInstance* dataPtr = static_cast<SpriteInstance*>(SDL_MapGPUTransferBuffer(device, spriteDataTransferBuffer, true));
-			for (int i = 0; i < kNumSprites - 1; i++) {
-				auto angle = SDL_PI_F / (kNumSprites - 1) * i;
-				dataPtr[i] = {
-					.transform = Matrix32MakeWithTransform2D(
-						{ .sx = 32, .sy = 32, .shearX = 0.5f, .rad = angle, .tx = 100 + i * 50.0f, .ty = 100 }),
-					.pivotX = 0.5f,
-					.pivotY = 0.5f,
-					.color = { (255 - 10 * i) / 255.0f, (255 - 5 * i) / 255.0f, 1.0f, 1.0f },
-					.texU = 0.5f / 256,
-					.texV = 0.5f / 256,
-					.texW = 1 - 0.5f / 256,
-					.texH = 1 - 0.5f / 256
-				};
-			}
-			dataPtr[20] = {
-				.transform = Matrix32MakeWithTransform2D({ .sx = 128, .sy = 128, .tx = 100, .ty = 100 }),
-				.pivotX = 0.5f,
-				.pivotY = 0.5f,
-				.color = FloatColorMakeWhite(),
-				.texU = 0.5f / 256,
-				.texV = 0.5f / 256,
-				.texW = 1 - 0.5f / 256,
-				.texH = 1 - 0.5f / 256
-			};
-			SDL_UnmapGPUTransferBuffer(device, spriteDataTransferBuffer);
-			
-			// Upload instance data
-			SDL_GPUTransferBufferLocation location = {
-				.transfer_buffer = spriteDataTransferBuffer,
-				.offset = 0
-			};
-			SDL_GPUBufferRegion region = {
-				.buffer = spriteDataBuffer,
-				.offset = 0,
-				.size = kNumSprites * sizeof(SpriteInstance)
-			};
-			SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(cmdbuf);
-			SDL_UploadToGPUBuffer(copyPass, &location, &region, true);
-			SDL_EndGPUCopyPass(copyPass);
-			
 			// Render sprites
 			SDL_GPUColorTargetInfo targetInfo = {
 				.texture = swapchainTexture,
@@ -404,39 +282,60 @@ static SDL_AppResult ExampleIterate() {
 				.store_op = SDL_GPU_STOREOP_STORE
 			};
 			SDL_GPURenderPass* renderPass = SDL_BeginGPURenderPass(cmdbuf, &targetInfo, 1, nullptr);
-			SDL_BindGPUGraphicsPipeline(renderPass, spritePipeline);
-			SDL_BindGPUVertexStorageBuffers(renderPass, 0, &spriteDataBuffer, 1);
-			
-			SDL_GPUTextureSamplerBinding textureSamplerBindings[1] = {{
-				.texture = texture,
-				.sampler = sampler
-			}};
-			SDL_BindGPUFragmentSamplers(renderPass, 0, textureSamplerBindings, SDL_arraysize(textureSamplerBindings));
 			
 			constexpr uint32_t kVerticesPerSprite = 6;
 			
-			SDL_DrawGPUPrimitives(renderPass, kNumSprites * kVerticesPerSprite, 1, 0, 0);
+			// Sprites are blended, so batches keep their order and only neighbours with the same state merge
+			renderQueue.Clear();
+			auto samplerId = renderQueue.RegisterSampler(sampler);
+			auto& batches = spriteInstances.GetBatches();
+			for (size_t i = 0; i < batches.size(); ++i) {
+				auto& batch = batches[i];
+				auto key = RenderKeyMakeBlended(0, static_cast<uint32_t>(i),
+					renderQueue.RegisterPipeline(batch.pipeline), renderQueue.RegisterTexture(batch.texture), samplerId);
+				renderQueue.Add(key, batch.firstInstance, batch.instanceCount);
+			}
+			renderQueue.Sort();
+			
+			for (auto& draw : renderQueue.GetDraws()) {
+				if ((draw.binds & RenderBind::Pipeline) != RenderBind::None) {
+					SDL_BindGPUGraphicsPipeline(renderPass, static_cast<SDL_GPUGraphicsPipeline*>(draw.pipeline));
+					SDL_BindGPUVertexStorageBuffers(renderPass, 0, &spriteDataBuffer, 1);
+				}
+				
+				if ((draw.binds & (RenderBind::Texture | RenderBind::Sampler)) != RenderBind::None) {
+					SDL_GPUTextureSamplerBinding textureSamplerBindings[1] = {{
+						.texture = static_cast<SDL_GPUTexture*>(draw.texture),
+						.sampler = static_cast<SDL_GPUSampler*>(draw.sampler)
+					}};
+					SDL_BindGPUFragmentSamplers(renderPass, 0, textureSamplerBindings, SDL_arraysize(textureSamplerBindings));
+				}
+				
+				SDL_DrawGPUPrimitives(renderPass, draw.instanceCount * kVerticesPerSprite, 1, draw.firstInstance * kVerticesPerSprite, 0);
+			}
+			
 			SDL_EndGPURenderPass(renderPass);
 			
 			SDL_PopGPUDebugGroup(cmdbuf);
 		}
 	}
 	
-	SDL_SubmitGPUCommandBuffer(cmdbuf);
+	uploads->EndFrame(cmdbuf);
 	
 	return SDL_APP_CONTINUE;
 }
 
 static void ExampleFinalize() {
+	scene.reset();
+	uploads.reset();
+	uploadDevice.reset();
+	pipelines.reset();
+	gpuDevice.reset();
 	SDL_ReleaseGPUTexture(device, texture);
 	SDL_ReleaseGPUSampler(device, sampler);
-	SDL_ReleaseGPUTransferBuffer(device, transferBuffer);
-	SDL_ReleaseGPUTransferBuffer(device, spriteDataTransferBuffer);
 	SDL_ReleaseGPUBuffer(device, vertexBuffer);
 	SDL_ReleaseGPUBuffer(device, colorBuffer);
 	SDL_ReleaseGPUBuffer(device, spriteDataBuffer);
-	SDL_ReleaseGPUGraphicsPipeline(device, spritePipeline);
-	SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
 	SDL_ReleaseWindowFromGPUDevice(device, window);
 	SDL_DestroyGPUDevice(device);
 	SDL_DestroyWindow(window);
@@ -468,7 +367,7 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
 	debugMode = true;
 #endif
 	
-	device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_METALLIB, debugMode, nullptr);
+	device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_METALLIB, debugMode, nullptr);
 	if (!device) {
 		SDL_Log("GPUCreateDevice failed");
 		return SDL_APP_FAILURE;
@@ -0,0 +1,36 @@
+#include <scenegraph/math/AABB.h>
+#include <scenegraph/math/Matrix4.h>
+#include <scenegraph/math/Matrix43.h>
+
+#include <cmath>
+
+namespace {
+
+// Transformed center plus extents projected to the axes, affine matrices only
+template <typename Matrix>
+AABB TransformAffine(const AABB& b, const Matrix& m) noexcept {
+	if (AABBIsEmpty(b)) {
+		return b;
+	}
+	
+	auto center = Vector3Transform(AABBCenter(b), m);
+	auto e = AABBExtents(b);
+	
+	Vector3 extents {
+		e.x * std::abs(m.m11) + e.y * std::abs(m.m21) + e.z * std::abs(m.m31),
+		e.x * std::abs(m.m12) + e.y * std::abs(m.m22) + e.z * std::abs(m.m32),
+		e.x * std::abs(m.m13) + e.y * std::abs(m.m23) + e.z * std::abs(m.m33)
+	};
+	
+	return AABBMakeWithCenterAndExtents(center, extents);
+}
+
+} // namespace
+
+AABB AABBTransform(const AABB& b, const Matrix4& m) {
+	return TransformAffine(b, m);
+}
+
+AABB AABBTransform(const AABB& b, const Matrix43& m) {
+	return TransformAffine(b, m);
+}
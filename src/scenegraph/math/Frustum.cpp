@@ -2,6 +2,7 @@
 #include <scenegraph/math/Plane.h>
 #include <scenegraph/math/Matrix4.h>
 #include <scenegraph/math/Sphere.h>
+#include <scenegraph/math/AABB.h>
 
 Frustum FrustumMakeWithMatrix(const Matrix4& m) {
 	Frustum out;
@@ -65,3 +66,32 @@ bool FrustumCullSphere(const Frustum& frustum, const Sphere& s) {
 	
 	return false;
 }
+
+bool FrustumCullAABB(const Frustum& frustum, const AABB& b) {
+	auto center = AABBCenter(b);
+	auto extents = AABBExtents(b);
+	
+	for (auto& plane : frustum.clippingPlanes) {
+		// Projection of extents to the normal gives radius of the box along it
+		auto radius = extents.x * std::abs(plane.normal.x) + extents.y * std::abs(plane.normal.y) + extents.z * std::abs(plane.normal.z);
+		if (PlaneDistanceToPoint(plane, center) + radius < 0) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+bool FrustumContainsAABB(const Frustum& frustum, const AABB& b) {
+	auto center = AABBCenter(b);
+	auto extents = AABBExtents(b);
+	
+	for (auto& plane : frustum.clippingPlanes) {
+		auto radius = extents.x * std::abs(plane.normal.x) + extents.y * std::abs(plane.normal.y) + extents.z * std::abs(plane.normal.z);
+		if (PlaneDistanceToPoint(plane, center) - radius < 0) {
+			return false;
+		}
+	}
+	
+	return true;
+}
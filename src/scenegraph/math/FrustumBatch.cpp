@@ -0,0 +1,198 @@
+#include <scenegraph/math/Frustum.h>
+#include <scenegraph/math/Sphere.h>
+#include <scenegraph/math/AABB.h>
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint8_t kPlaneCount = 6;
+
+// Signed distance of object bounds to a plane, negative when the object is outside
+struct SphereBounds {
+	static float Distance(const Plane& plane, const SphereBatch& spheres, size_t i) noexcept {
+		return plane.normal.x * spheres.x[i] + plane.normal.y * spheres.y[i] + plane.normal.z * spheres.z[i]
+			+ plane.distance + spheres.radius[i];
+	}
+};
+
+struct AABBBounds {
+	static float Distance(const Plane& plane, const AABBBatch& boxes, size_t i) noexcept {
+		return plane.normal.x * boxes.centerX[i] + plane.normal.y * boxes.centerY[i] + plane.normal.z * boxes.centerZ[i]
+			+ plane.distance
+			+ std::abs(plane.normal.x) * boxes.extentX[i] + std::abs(plane.normal.y) * boxes.extentY[i] + std::abs(plane.normal.z) * boxes.extentZ[i];
+	}
+};
+
+template <typename Bounds, typename Batch>
+bool CullOne(const Frustum& frustum, const Batch& batch, size_t i, uint8_t* planeCache) noexcept {
+	if (planeCache) {
+		auto cached = planeCache[i];
+		if (cached < kPlaneCount && Bounds::Distance(frustum.clippingPlanes[cached], batch, i) < 0) {
+			return true;
+		}
+	}
+
+	for (uint8_t p = 0; p < kPlaneCount; ++p) {
+		if (Bounds::Distance(frustum.clippingPlanes[p], batch, i) < 0) {
+			if (planeCache) {
+				planeCache[i] = p;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#if SIMD_FLOAT4_ENABLED
+
+struct SphereLanes {
+	Float4 x, y, z, radius;
+
+	SphereLanes(const SphereBatch& spheres, size_t i) noexcept
+		: x(Float4Load(spheres.x + i))
+		, y(Float4Load(spheres.y + i))
+		, z(Float4Load(spheres.z + i))
+		, radius(Float4Load(spheres.radius + i))
+	{
+	}
+
+	// Plane coefficients per lane as [nx ny nz d], absolute values are not needed for spheres
+	Float4 Distance(Float4 nx, Float4 ny, Float4 nz, Float4 d) const noexcept {
+		return nx * x + ny * y + nz * z + d + radius;
+	}
+};
+
+struct AABBLanes {
+	Float4 x, y, z, ex, ey, ez;
+
+	AABBLanes(const AABBBatch& boxes, size_t i) noexcept
+		: x(Float4Load(boxes.centerX + i))
+		, y(Float4Load(boxes.centerY + i))
+		, z(Float4Load(boxes.centerZ + i))
+		, ex(Float4Load(boxes.extentX + i))
+		, ey(Float4Load(boxes.extentY + i))
+		, ez(Float4Load(boxes.extentZ + i))
+	{
+	}
+
+	static Float4 Abs(Float4 v) noexcept {
+		return (Float4)((Int4)v & 0x7fffffff);
+	}
+
+	Float4 Distance(Float4 nx, Float4 ny, Float4 nz, Float4 d) const noexcept {
+		return nx * x + ny * y + nz * z + d + Abs(nx) * ex + Abs(ny) * ey + Abs(nz) * ez;
+	}
+};
+
+// Culls four objects at once, returns visibility bits of lanes
+template <typename Lanes, typename Batch>
+unsigned CullFour(const Frustum& frustum, const Batch& batch, size_t i, uint8_t* planeCache) noexcept {
+	Lanes lanes(batch, i);
+	auto& planes = frustum.clippingPlanes;
+
+	if (planeCache) {
+		// Neighbouring objects are usually culled by the same plane, test it first when all four lanes agree
+		auto cached = planeCache[i];
+		if (cached < kPlaneCount && planeCache[i + 1] == cached && planeCache[i + 2] == cached && planeCache[i + 3] == cached) {
+			auto& plane = planes[cached];
+			auto outside = lanes.Distance(
+				Float4Splat(plane.normal.x), Float4Splat(plane.normal.y), Float4Splat(plane.normal.z), Float4Splat(plane.distance)) < 0;
+			if (outside[0] & outside[1] & outside[2] & outside[3]) {
+				return 0;
+			}
+		}
+	}
+	
+	Int4 culled = {};
+	Int4 cullingPlane = {};
+	for (int p = 0; p < kPlaneCount; ++p) {
+		auto& plane = planes[static_cast<size_t>(p)];
+		auto outside = lanes.Distance(
+			Float4Splat(plane.normal.x), Float4Splat(plane.normal.y), Float4Splat(plane.normal.z), Float4Splat(plane.distance)) < 0;
+
+		// Remember the first plane culling each lane
+		cullingPlane |= outside & ~culled & p;
+		culled |= outside;
+	}
+
+	if (planeCache) {
+		for (int k = 0; k < 4; ++k) {
+			if (culled[k]) {
+				planeCache[i + static_cast<size_t>(k)] = static_cast<uint8_t>(cullingPlane[k]);
+			}
+		}
+	}
+
+	auto visible = ~culled & Int4{1, 2, 4, 8};
+	return static_cast<unsigned>(visible[0] | visible[1] | visible[2] | visible[3]);
+}
+
+#else
+
+struct SphereLanes {};
+struct AABBLanes {};
+
+#endif // SIMD_FLOAT4_ENABLED
+
+template <typename Bounds, typename Lanes, typename Batch>
+void CullToMask(const Frustum& frustum, const Batch& batch, size_t count, uint32_t* visibility, uint8_t* planeCache) noexcept {
+	std::fill(visibility, visibility + (count + 31) / 32, 0u);
+
+	size_t i = 0;
+
+#if SIMD_FLOAT4_ENABLED
+	for (; i + 4 <= count; i += 4) {
+		visibility[i / 32] |= CullFour<Lanes>(frustum, batch, i, planeCache) << (i % 32);
+	}
+#endif
+
+	for (; i < count; ++i) {
+		if (!CullOne<Bounds>(frustum, batch, i, planeCache)) {
+			visibility[i / 32] |= 1u << (i % 32);
+		}
+	}
+}
+
+template <typename Bounds, typename Lanes, typename Batch>
+size_t CullToIndices(const Frustum& frustum, const Batch& batch, size_t count, uint32_t* indices, uint8_t* planeCache) noexcept {
+	size_t visibleCount = 0;
+	size_t i = 0;
+
+#if SIMD_FLOAT4_ENABLED
+	for (; i + 4 <= count; i += 4) {
+		for (auto bits = CullFour<Lanes>(frustum, batch, i, planeCache); bits; bits &= bits - 1) {
+			indices[visibleCount++] = static_cast<uint32_t>(i + static_cast<size_t>(__builtin_ctz(bits)));
+		}
+	}
+#endif
+
+	for (; i < count; ++i) {
+		if (!CullOne<Bounds>(frustum, batch, i, planeCache)) {
+			indices[visibleCount++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	return visibleCount;
+}
+
+} // namespace
+
+void FrustumCullSpheresToMask(const Frustum& frustum, const SphereBatch& spheres, size_t count, uint32_t* visibility, uint8_t* planeCache) {
+	CullToMask<SphereBounds, SphereLanes>(frustum, spheres, count, visibility, planeCache);
+}
+
+void FrustumCullAABBsToMask(const Frustum& frustum, const AABBBatch& boxes, size_t count, uint32_t* visibility, uint8_t* planeCache) {
+	CullToMask<AABBBounds, AABBLanes>(frustum, boxes, count, visibility, planeCache);
+}
+
+size_t FrustumCullSpheresToIndices(const Frustum& frustum, const SphereBatch& spheres, size_t count, uint32_t* indices, uint8_t* planeCache) {
+	return CullToIndices<SphereBounds, SphereLanes>(frustum, spheres, count, indices, planeCache);
+}
+
+size_t FrustumCullAABBsToIndices(const Frustum& frustum, const AABBBatch& boxes, size_t count, uint32_t* indices, uint8_t* planeCache) {
+	return CullToIndices<AABBBounds, AABBLanes>(frustum, boxes, count, indices, planeCache);
+}
@@ -0,0 +1,233 @@
+#include <scenegraph/math/Matrix32.h>
+#include <scenegraph/math/Trigonometry.h>
+#include "Simd.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Angles of array of structures are gathered in chunks on the stack for SinCosBatch
+constexpr size_t kTransformChunk = 64;
+
+using MultiplyBatchFunction = void(*)(const Matrix32* m1, const Matrix32* m2, Matrix32* out, size_t count);
+
+void MultiplyBatchScalar(const Matrix32* m1, const Matrix32* m2, Matrix32* out, size_t count) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = Matrix32Multiply(m1[i], m2[i]);
+	}
+}
+
+#if SIMD_FLOAT4_ENABLED
+
+// Two matrices take three vectors: [a0 b0 c0 d0] [tx0 ty0 a1 b1] [c1 d1 tx1 ty1]
+void MultiplyBatchFloat4(const Matrix32* m1, const Matrix32* m2, Matrix32* out, size_t count) noexcept {
+	static_assert(sizeof(Matrix32) == 6 * sizeof(float));
+
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		auto p1 = reinterpret_cast<const float*>(m1 + i);
+		auto p2 = reinterpret_cast<const float*>(m2 + i);
+
+		auto a0 = Float4Load(p1);
+		auto a1 = Float4Load(p1 + 4);
+		auto a2 = Float4Load(p1 + 8);
+		auto b0 = Float4Load(p2);
+		auto b1 = Float4Load(p2 + 4);
+		auto b2 = Float4Load(p2 + 8);
+
+		// First matrix, rows of m2 are [a b] and [c d]
+		auto r0 = Float4Shuffle<0, 1, 0, 1>(b0);
+		auto r1 = Float4Shuffle<2, 3, 2, 3>(b0);
+		auto linear0 = Float4Shuffle<0, 0, 2, 2>(a0) * r0 + Float4Shuffle<1, 1, 3, 3>(a0) * r1;
+		auto translation0 = Float4Shuffle<0, 0, 0, 0>(a1) * r0 + Float4Shuffle<1, 1, 1, 1>(a1) * r1 + b1;
+
+		// Second matrix
+		auto l1 = Float4Shuffle<2, 3, 4, 5>(a1, a2);
+		auto l2 = Float4Shuffle<2, 3, 4, 5>(b1, b2);
+		r0 = Float4Shuffle<0, 1, 0, 1>(l2);
+		r1 = Float4Shuffle<2, 3, 2, 3>(l2);
+		auto linear1 = Float4Shuffle<0, 0, 2, 2>(l1) * r0 + Float4Shuffle<1, 1, 3, 3>(l1) * r1;
+		auto translation1 = Float4Shuffle<2, 2, 2, 2>(a2) * r0 + Float4Shuffle<3, 3, 3, 3>(a2) * r1 + Float4Shuffle<2, 3, 2, 3>(b2);
+
+		auto p = reinterpret_cast<float*>(out + i);
+		Float4Store(p, linear0);
+		Float4Store(p + 4, Float4Shuffle<0, 1, 4, 5>(translation0, linear1));
+		Float4Store(p + 8, Float4Shuffle<2, 3, 4, 5>(linear1, translation1));
+	}
+
+	MultiplyBatchScalar(m1 + i, m2 + i, out + i, count - i);
+}
+
+#endif // SIMD_FLOAT4_ENABLED
+
+#if SIMD_AVX2_ENABLED
+
+// Same as Float4 kernel, with each 128-bit lane holding a pair of matrices, i.e. four per iteration
+SIMD_TARGET_AVX2
+__m256 LoadPairs(const float* p) noexcept {
+	return _mm256_set_m128(_mm_loadu_ps(p + 12), _mm_loadu_ps(p));
+}
+
+SIMD_TARGET_AVX2
+void StorePairs(float* p, __m256 v) noexcept {
+	_mm_storeu_ps(p, _mm256_castps256_ps128(v));
+	_mm_storeu_ps(p + 12, _mm256_extractf128_ps(v, 1));
+}
+
+SIMD_TARGET_AVX2
+void MultiplyBatchAVX2(const Matrix32* m1, const Matrix32* m2, Matrix32* out, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		auto p1 = reinterpret_cast<const float*>(m1 + i);
+		auto p2 = reinterpret_cast<const float*>(m2 + i);
+
+		auto a0 = LoadPairs(p1);
+		auto a1 = LoadPairs(p1 + 4);
+		auto a2 = LoadPairs(p1 + 8);
+		auto b0 = LoadPairs(p2);
+		auto b1 = LoadPairs(p2 + 4);
+		auto b2 = LoadPairs(p2 + 8);
+
+		auto r0 = _mm256_shuffle_ps(b0, b0, _MM_SHUFFLE(1, 0, 1, 0));
+		auto r1 = _mm256_shuffle_ps(b0, b0, _MM_SHUFFLE(3, 2, 3, 2));
+		auto linear0 = _mm256_fmadd_ps(_mm256_moveldup_ps(a0), r0, _mm256_mul_ps(_mm256_movehdup_ps(a0), r1));
+		auto translation0 = _mm256_fmadd_ps(_mm256_shuffle_ps(a1, a1, _MM_SHUFFLE(0, 0, 0, 0)), r0,
+			_mm256_fmadd_ps(_mm256_shuffle_ps(a1, a1, _MM_SHUFFLE(1, 1, 1, 1)), r1, b1));
+
+		auto l1 = _mm256_shuffle_ps(a1, a2, _MM_SHUFFLE(1, 0, 3, 2));
+		auto l2 = _mm256_shuffle_ps(b1, b2, _MM_SHUFFLE(1, 0, 3, 2));
+		r0 = _mm256_shuffle_ps(l2, l2, _MM_SHUFFLE(1, 0, 1, 0));
+		r1 = _mm256_shuffle_ps(l2, l2, _MM_SHUFFLE(3, 2, 3, 2));
+		auto linear1 = _mm256_fmadd_ps(_mm256_moveldup_ps(l1), r0, _mm256_mul_ps(_mm256_movehdup_ps(l1), r1));
+		auto translation1 = _mm256_fmadd_ps(_mm256_shuffle_ps(a2, a2, _MM_SHUFFLE(2, 2, 2, 2)), r0,
+			_mm256_fmadd_ps(_mm256_shuffle_ps(a2, a2, _MM_SHUFFLE(3, 3, 3, 3)), r1, _mm256_shuffle_ps(b2, b2, _MM_SHUFFLE(3, 2, 3, 2))));
+
+		auto p = reinterpret_cast<float*>(out + i);
+		StorePairs(p, linear0);
+		StorePairs(p + 4, _mm256_shuffle_ps(translation0, linear1, _MM_SHUFFLE(1, 0, 1, 0)));
+		StorePairs(p + 8, _mm256_shuffle_ps(linear1, translation1, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+
+	MultiplyBatchScalar(m1 + i, m2 + i, out + i, count - i);
+}
+
+#endif // SIMD_AVX2_ENABLED
+
+MultiplyBatchFunction SelectMultiplyBatch() noexcept {
+#if SIMD_AVX2_ENABLED
+	if (SimdSupportsAVX2()) {
+		return &MultiplyBatchAVX2;
+	}
+#endif
+#if SIMD_FLOAT4_ENABLED
+	return &MultiplyBatchFloat4;
+#else
+	return &MultiplyBatchScalar;
+#endif
+}
+
+} // namespace
+
+void Matrix32MultiplyBatch(const Matrix32* m1, const Matrix32* m2, Matrix32* out, size_t count) {
+	static const auto function = SelectMultiplyBatch();
+	function(m1, m2, out, count);
+}
+
+void Matrix32MakeWithTransform2DBatch(const Transform2D* transforms, Matrix32* out, size_t count) {
+	constexpr auto epsilon = std::numeric_limits<float>::epsilon();
+	
+	float sin[kTransformChunk];
+	float cos[kTransformChunk];
+	float rad[kTransformChunk];
+	
+	for (size_t i = 0; i < count; i += kTransformChunk) {
+		auto chunk = std::min(count - i, kTransformChunk);
+		for (size_t k = 0; k < chunk; ++k) {
+			rad[k] = transforms[i + k].rad;
+		}
+		
+		SinCosBatch(rad, sin, cos, chunk);
+		
+		for (size_t k = 0; k < chunk; ++k) {
+			auto& c = transforms[i + k];
+			if (c.shearX > epsilon || c.shearY > epsilon) {
+				out[i + k] = Matrix32MakeWithTransform2D(c);
+			}
+			else {
+				out[i + k] = Matrix32 {
+					 cos[k] * c.sx, sin[k] * c.sx,
+					-sin[k] * c.sy, cos[k] * c.sy,
+					 c.tx, c.ty
+				};
+			}
+		}
+	}
+}
+
+void Matrix32MakeWithTransform2DBatch(const Transform2DBatch& transforms, Matrix32* out, size_t count) {
+	size_t i = 0;
+	
+#if SIMD_FLOAT4_ENABLED
+	for (; i + 4 <= count; i += 4) {
+		auto sx = Float4Load(transforms.sx + i);
+		auto sy = Float4Load(transforms.sy + i);
+		
+		Float4 sin, cos;
+		Float4SinCos(Float4Load(transforms.rad + i), &sin, &cos);
+		
+		auto a = cos * sx;
+		auto b = sin * sx;
+		auto c = -sin * sy;
+		auto d = cos * sy;
+		auto tx = Float4Load(transforms.tx + i);
+		auto ty = Float4Load(transforms.ty + i);
+		
+		// Transpose four matrices into array of structures
+		auto abLow = Float4Shuffle<0, 4, 1, 5>(a, b);
+		auto abHigh = Float4Shuffle<2, 6, 3, 7>(a, b);
+		auto cdLow = Float4Shuffle<0, 4, 1, 5>(c, d);
+		auto cdHigh = Float4Shuffle<2, 6, 3, 7>(c, d);
+		auto tLow = Float4Shuffle<0, 4, 1, 5>(tx, ty);
+		auto tHigh = Float4Shuffle<2, 6, 3, 7>(tx, ty);
+		
+		auto p = reinterpret_cast<float*>(out + i);
+		Float4Store(p, Float4Shuffle<0, 1, 4, 5>(abLow, cdLow));
+		Float4Store(p + 4, Float4Shuffle<0, 1, 6, 7>(tLow, abLow));
+		Float4Store(p + 8, Float4Shuffle<2, 3, 6, 7>(cdLow, tLow));
+		Float4Store(p + 12, Float4Shuffle<0, 1, 4, 5>(abHigh, cdHigh));
+		Float4Store(p + 16, Float4Shuffle<0, 1, 6, 7>(tHigh, abHigh));
+		Float4Store(p + 20, Float4Shuffle<2, 3, 6, 7>(cdHigh, tHigh));
+	}
+#endif
+	
+	for (; i < count; ++i) {
+		float sin, cos;
+		SinCosBatch(transforms.rad + i, &sin, &cos, 1);
+		out[i] = Matrix32 {
+			 cos * transforms.sx[i], sin * transforms.sx[i],
+			-sin * transforms.sy[i], cos * transforms.sy[i],
+			 transforms.tx[i], transforms.ty[i]
+		};
+	}
+	
+	// Sheared transforms are rare, redo them with the generic path
+	if (transforms.shearX || transforms.shearY) {
+		constexpr auto epsilon = std::numeric_limits<float>::epsilon();
+		for (i = 0; i < count; ++i) {
+			auto shearX = transforms.shearX ? transforms.shearX[i] : 0.0f;
+			auto shearY = transforms.shearY ? transforms.shearY[i] : 0.0f;
+			if (shearX > epsilon || shearY > epsilon) {
+				out[i] = Matrix32MakeWithTransform2D(Transform2D {
+					.sx = transforms.sx[i],
+					.sy = transforms.sy[i],
+					.shearX = shearX,
+					.shearY = shearY,
+					.rad = transforms.rad[i],
+					.tx = transforms.tx[i],
+					.ty = transforms.ty[i]
+				});
+			}
+		}
+	}
+}
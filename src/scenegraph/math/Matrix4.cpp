@@ -1,16 +1,45 @@
 #include <scenegraph/math/Matrix4.h>
 #include <scenegraph/math/Quaternion.h>
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/math/Transform.h>
 #include <scenegraph/utils/FloatUtils.h>
 
 Matrix4 Matrix4MakeWithQuaternion(const Quaternion& q) {
 	return Matrix4 {
-		1 - 2 * DifferenceOfProducts(q.y, q.y, q.z, q.z), 2 * DifferenceOfProducts(q.x, q.y, -q.w, q.z), 2 * DifferenceOfProducts(q.x, q.z, q.w, q.y), 0,
-		2 * DifferenceOfProducts(q.x, q.y, q.w, q.z), 1 - 2 * DifferenceOfProducts(q.x, q.x, q.z, q.z), 2 * DifferenceOfProducts(q.y, q.z, -q.w, q.x), 0,
-		2 * DifferenceOfProducts(q.x, q.z, -q.w, q.y), 2 * DifferenceOfProducts(q.y, q.z, q.w, q.x), 1 - 2 * DifferenceOfProducts(q.x, q.x, q.y, q.y), 0,
+		1 - 2 * DifferenceOfProducts(q.y, q.y, -q.z, q.z), 2 * DifferenceOfProducts(q.x, q.y, -q.w, q.z), 2 * DifferenceOfProducts(q.x, q.z, q.w, q.y), 0,
+		2 * DifferenceOfProducts(q.x, q.y, q.w, q.z), 1 - 2 * DifferenceOfProducts(q.x, q.x, -q.z, q.z), 2 * DifferenceOfProducts(q.y, q.z, -q.w, q.x), 0,
+		2 * DifferenceOfProducts(q.x, q.z, -q.w, q.y), 2 * DifferenceOfProducts(q.y, q.z, q.w, q.x), 1 - 2 * DifferenceOfProducts(q.x, q.x, -q.y, q.y), 0,
 		0, 0, 0, 1
 	};
 }
 
+Matrix4 Matrix4MakeWithScaleRotationTranslation(const Vector3& scale, const Quaternion& rotation, const Vector3& translation) {
+	auto m = Matrix4MakeWithQuaternion(rotation);
+	
+	// Scale matrix on the left multiplies rows
+	m.m11 *= scale.x; m.m12 *= scale.x; m.m13 *= scale.x;
+	m.m21 *= scale.y; m.m22 *= scale.y; m.m23 *= scale.y;
+	m.m31 *= scale.z; m.m32 *= scale.z; m.m33 *= scale.z;
+	m.m41 = translation.x;
+	m.m42 = translation.y;
+	m.m43 = translation.z;
+	
+	return m;
+}
+
+Matrix4 Matrix4MakeWithTransform(const Transform& transform) {
+	// Quaternion product applies the right operand first
+	auto rotation =
+		QuaternionMakeRotationAxisAngle(0, 0, 1, transform.radZ) *
+		QuaternionMakeRotationAxisAngle(0, 1, 0, transform.radY) *
+		QuaternionMakeRotationAxisAngle(1, 0, 0, transform.radX);
+	
+	return Matrix4MakeWithScaleRotationTranslation(
+		Vector3Make(transform.sx, transform.sy, transform.sz),
+		rotation,
+		Vector3Make(transform.tx, transform.ty, transform.tz));
+}
+
 Matrix4 Matrix4MakeXRotation(float rad) {
 	float s = std::sinf(rad);
 	float c = std::cosf(rad);
@@ -28,10 +57,10 @@ Matrix4 Matrix4MakeYRotation(float rad) {
 	float c = std::cosf(rad);
 	
 	return Matrix4 {
-		 c, 0, s, 0,
-		 0, 1, 0, 0,
-		-s, 0, c, 0,
-		 0, 0, 0, 1
+		c, 0, -s, 0,
+		0, 1,  0, 0,
+		s, 0,  c, 0,
+		0, 0,  0, 1
 	};
 }
 
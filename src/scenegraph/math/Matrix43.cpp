@@ -1 +1,133 @@
 #include <scenegraph/math/Matrix43.h>
+#include <scenegraph/math/Matrix4.h>
+#include <scenegraph/math/Quaternion.h>
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/utils/FloatUtils.h>
+#include "Simd.h"
+
+#include <cmath>
+#include <limits>
+
+Matrix43 Matrix43MakeWithQuaternion(const Quaternion& q) {
+	return Matrix43 {
+		1 - 2 * DifferenceOfProducts(q.y, q.y, -q.z, q.z), 2 * DifferenceOfProducts(q.x, q.y, -q.w, q.z), 2 * DifferenceOfProducts(q.x, q.z, q.w, q.y),
+		2 * DifferenceOfProducts(q.x, q.y, q.w, q.z), 1 - 2 * DifferenceOfProducts(q.x, q.x, -q.z, q.z), 2 * DifferenceOfProducts(q.y, q.z, -q.w, q.x),
+		2 * DifferenceOfProducts(q.x, q.z, -q.w, q.y), 2 * DifferenceOfProducts(q.y, q.z, q.w, q.x), 1 - 2 * DifferenceOfProducts(q.x, q.x, -q.y, q.y),
+		0, 0, 0
+	};
+}
+
+Matrix43 Matrix43MakeWithScaleRotationTranslation(const Vector3& scale, const Quaternion& rotation, const Vector3& translation) {
+	auto m = Matrix43MakeWithQuaternion(rotation);
+	
+	// Scale matrix on the left multiplies rows
+	m.m11 *= scale.x; m.m12 *= scale.x; m.m13 *= scale.x;
+	m.m21 *= scale.y; m.m22 *= scale.y; m.m23 *= scale.y;
+	m.m31 *= scale.z; m.m32 *= scale.z; m.m33 *= scale.z;
+	m.m41 = translation.x;
+	m.m42 = translation.y;
+	m.m43 = translation.z;
+	
+	return m;
+}
+
+Matrix43 Matrix43MakeWithMatrix4(const Matrix4& m) {
+	return Matrix43 {
+		m.m11, m.m12, m.m13,
+		m.m21, m.m22, m.m23,
+		m.m31, m.m32, m.m33,
+		m.m41, m.m42, m.m43
+	};
+}
+
+Matrix4 Matrix43ToMatrix4(const Matrix43& m) {
+	return Matrix4 {
+		m.m11, m.m12, m.m13, 0,
+		m.m21, m.m22, m.m23, 0,
+		m.m31, m.m32, m.m33, 0,
+		m.m41, m.m42, m.m43, 1
+	};
+}
+
+Matrix43 Matrix43Multiply(const Matrix43& m1, const Matrix43& m2) {
+#if SIMD_FLOAT4_ENABLED
+	static_assert(sizeof(Matrix43) == 12 * sizeof(float));
+	
+	// Rows of the second matrix with a garbage last lane, loads stay within the matrix
+	auto p = &m2.m11;
+	auto r1 = Float4Load(p);
+	auto r2 = Float4Load(p + 3);
+	auto r3 = Float4Load(p + 6);
+	auto r4 = Float4Shuffle<1, 2, 3, 3>(Float4Load(p + 8));
+	
+	auto o1 = m1.m11 * r1 + m1.m12 * r2 + m1.m13 * r3;
+	auto o2 = m1.m21 * r1 + m1.m22 * r2 + m1.m23 * r3;
+	auto o3 = m1.m31 * r1 + m1.m32 * r2 + m1.m33 * r3;
+	auto o4 = m1.m41 * r1 + m1.m42 * r2 + m1.m43 * r3 + r4;
+	
+	// Pack four rows of three into three vectors of four
+	Matrix43 out;
+	auto q = &out.m11;
+	Float4Store(q, Float4Shuffle<0, 1, 2, 4>(o1, o2));
+	Float4Store(q + 4, Float4Shuffle<1, 2, 4, 5>(o2, o3));
+	Float4Store(q + 8, Float4Shuffle<2, 4, 5, 6>(o3, o4));
+	return out;
+#else
+	return Matrix43 {
+		m1.m11 * m2.m11 + m1.m12 * m2.m21 + m1.m13 * m2.m31,
+		m1.m11 * m2.m12 + m1.m12 * m2.m22 + m1.m13 * m2.m32,
+		m1.m11 * m2.m13 + m1.m12 * m2.m23 + m1.m13 * m2.m33,
+		
+		m1.m21 * m2.m11 + m1.m22 * m2.m21 + m1.m23 * m2.m31,
+		m1.m21 * m2.m12 + m1.m22 * m2.m22 + m1.m23 * m2.m32,
+		m1.m21 * m2.m13 + m1.m22 * m2.m23 + m1.m23 * m2.m33,
+		
+		m1.m31 * m2.m11 + m1.m32 * m2.m21 + m1.m33 * m2.m31,
+		m1.m31 * m2.m12 + m1.m32 * m2.m22 + m1.m33 * m2.m32,
+		m1.m31 * m2.m13 + m1.m32 * m2.m23 + m1.m33 * m2.m33,
+		
+		m1.m41 * m2.m11 + m1.m42 * m2.m21 + m1.m43 * m2.m31 + m2.m41,
+		m1.m41 * m2.m12 + m1.m42 * m2.m22 + m1.m43 * m2.m32 + m2.m42,
+		m1.m41 * m2.m13 + m1.m42 * m2.m23 + m1.m43 * m2.m33 + m2.m43
+	};
+#endif
+}
+
+Matrix43 Matrix43Invert(const Matrix43& m, bool* invertible) {
+	// Cofactors of the linear part
+	float c11 = DifferenceOfProducts(m.m22, m.m33, m.m23, m.m32);
+	float c12 = DifferenceOfProducts(m.m23, m.m31, m.m21, m.m33);
+	float c13 = DifferenceOfProducts(m.m21, m.m32, m.m22, m.m31);
+	
+	float det = m.m11 * c11 + m.m12 * c12 + m.m13 * c13;
+	
+	// Mirroring transforms have negative determinant and are still invertible
+	if (invertible && !(*invertible = std::abs(det) > std::numeric_limits<float>::epsilon())) {
+		return Matrix43MakeZero();
+	}
+	
+	det = 1.0f / det;
+	
+	Matrix43 out {
+		det * c11,
+		det * DifferenceOfProducts(m.m13, m.m32, m.m12, m.m33),
+		det * DifferenceOfProducts(m.m12, m.m23, m.m13, m.m22),
+		
+		det * c12,
+		det * DifferenceOfProducts(m.m11, m.m33, m.m13, m.m31),
+		det * DifferenceOfProducts(m.m13, m.m21, m.m11, m.m23),
+		
+		det * c13,
+		det * DifferenceOfProducts(m.m12, m.m31, m.m11, m.m32),
+		det * DifferenceOfProducts(m.m11, m.m22, m.m12, m.m21),
+		
+		0, 0, 0
+	};
+	
+	// Inverse translation is the negated one taken through the inverse linear part
+	out.m41 = -(m.m41 * out.m11 + m.m42 * out.m21 + m.m43 * out.m31);
+	out.m42 = -(m.m41 * out.m12 + m.m42 * out.m22 + m.m43 * out.m32);
+	out.m43 = -(m.m41 * out.m13 + m.m42 * out.m23 + m.m43 * out.m33);
+	
+	return out;
+}
@@ -0,0 +1,125 @@
+#include <scenegraph/math/Matrix4.h>
+#include "Simd.h"
+
+#include <limits>
+
+#if SIMD_FLOAT4_ENABLED
+
+namespace {
+
+struct Float4x4 {
+	Float4 r0, r1, r2, r3;
+};
+
+Float4x4 Load(const Matrix4Aligned& m) noexcept {
+	auto p = &m.m11;
+	return {Float4LoadAligned(p), Float4LoadAligned(p + 4), Float4LoadAligned(p + 8), Float4LoadAligned(p + 12)};
+}
+
+Matrix4Aligned Store(const Float4x4& m) noexcept {
+	Matrix4Aligned out;
+	auto p = &out.m11;
+	Float4StoreAligned(p, m.r0);
+	Float4StoreAligned(p + 4, m.r1);
+	Float4StoreAligned(p + 8, m.r2);
+	Float4StoreAligned(p + 12, m.r3);
+	return out;
+}
+
+// Row of m1 times m2
+Float4 MultiplyRow(Float4 row, const Float4x4& m2) noexcept {
+	return Float4Shuffle<0, 0, 0, 0>(row) * m2.r0
+		+ Float4Shuffle<1, 1, 1, 1>(row) * m2.r1
+		+ Float4Shuffle<2, 2, 2, 2>(row) * m2.r2
+		+ Float4Shuffle<3, 3, 3, 3>(row) * m2.r3;
+}
+
+// 2x2 matrices are packed in a vector as [m11 m12 m21 m22]
+
+// A * B
+Float4 Matrix2Multiply(Float4 a, Float4 b) noexcept {
+	return a * Float4Shuffle<0, 3, 0, 3>(b) + Float4Shuffle<1, 0, 3, 2>(a) * Float4Shuffle<2, 1, 2, 1>(b);
+}
+
+// Adjugate(A) * B
+Float4 Matrix2AdjugateMultiply(Float4 a, Float4 b) noexcept {
+	return Float4Shuffle<3, 3, 0, 0>(a) * b - Float4Shuffle<1, 1, 2, 2>(a) * Float4Shuffle<2, 3, 0, 1>(b);
+}
+
+// A * Adjugate(B)
+Float4 Matrix2MultiplyAdjugate(Float4 a, Float4 b) noexcept {
+	return a * Float4Shuffle<3, 0, 3, 0>(b) - Float4Shuffle<1, 0, 3, 2>(a) * Float4Shuffle<2, 1, 2, 1>(b);
+}
+
+} // namespace
+
+Matrix4Aligned Matrix4MultiplyAligned(const Matrix4Aligned& m1, const Matrix4Aligned& m2) {
+	auto a = Load(m1);
+	auto b = Load(m2);
+	return Store({MultiplyRow(a.r0, b), MultiplyRow(a.r1, b), MultiplyRow(a.r2, b), MultiplyRow(a.r3, b)});
+}
+
+// Block-wise inversion of | A B |
+//                         | C D | with 2x2 blocks, so only 2x2 determinants and adjugates are needed
+Matrix4Aligned Matrix4InvertAligned(const Matrix4Aligned& m, bool* invertible) {
+	auto r = Load(m);
+	
+	auto a = Float4Shuffle<0, 1, 4, 5>(r.r0, r.r1);
+	auto b = Float4Shuffle<2, 3, 6, 7>(r.r0, r.r1);
+	auto c = Float4Shuffle<0, 1, 4, 5>(r.r2, r.r3);
+	auto d = Float4Shuffle<2, 3, 6, 7>(r.r2, r.r3);
+	
+	// Determinants of blocks as [|A| |B| |C| |D|]
+	auto determinants =
+		Float4Shuffle<0, 2, 4, 6>(r.r0, r.r2) * Float4Shuffle<1, 3, 5, 7>(r.r1, r.r3) -
+		Float4Shuffle<1, 3, 5, 7>(r.r0, r.r2) * Float4Shuffle<0, 2, 4, 6>(r.r1, r.r3);
+	auto detA = Float4Shuffle<0, 0, 0, 0>(determinants);
+	auto detB = Float4Shuffle<1, 1, 1, 1>(determinants);
+	auto detC = Float4Shuffle<2, 2, 2, 2>(determinants);
+	auto detD = Float4Shuffle<3, 3, 3, 3>(determinants);
+	
+	auto adjDC = Matrix2AdjugateMultiply(d, c);
+	auto adjAB = Matrix2AdjugateMultiply(a, b);
+	
+	// Adjugates of the inverse blocks
+	auto x = detD * a - Matrix2Multiply(b, adjDC);
+	auto w = detA * d - Matrix2Multiply(c, adjAB);
+	auto y = detB * c - Matrix2MultiplyAdjugate(d, adjAB);
+	auto z = detC * b - Matrix2MultiplyAdjugate(a, adjDC);
+	
+	// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+	auto trace = adjAB * Float4Shuffle<0, 2, 1, 3>(adjDC);
+	trace = trace + Float4Shuffle<1, 0, 3, 2>(trace);
+	trace = trace + Float4Shuffle<2, 3, 0, 1>(trace);
+	auto det = detA * detD + detB * detC - trace;
+	
+	if (invertible && !(*invertible = det[0] > std::numeric_limits<float>::epsilon())) {
+		return Matrix4AlignedMake(Matrix4MakeZero());
+	}
+	
+	auto invDet = Float4{1.0f, -1.0f, -1.0f, 1.0f} / det;
+	x = x * invDet;
+	y = y * invDet;
+	z = z * invDet;
+	w = w * invDet;
+	
+	// Adjugate shuffle combined with placing blocks into rows
+	return Store({
+		Float4Shuffle<3, 1, 7, 5>(x, y),
+		Float4Shuffle<2, 0, 6, 4>(x, y),
+		Float4Shuffle<3, 1, 7, 5>(z, w),
+		Float4Shuffle<2, 0, 6, 4>(z, w)
+	});
+}
+
+#else
+
+Matrix4Aligned Matrix4MultiplyAligned(const Matrix4Aligned& m1, const Matrix4Aligned& m2) {
+	return Matrix4AlignedMake(Matrix4Multiply(m1, m2));
+}
+
+Matrix4Aligned Matrix4InvertAligned(const Matrix4Aligned& m, bool* invertible) {
+	return Matrix4AlignedMake(Matrix4Invert(m, invertible));
+}
+
+#endif // SIMD_FLOAT4_ENABLED
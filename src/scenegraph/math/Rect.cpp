@@ -0,0 +1,18 @@
+#include <scenegraph/math/Rect.h>
+#include <scenegraph/math/Matrix32.h>
+
+#include <cmath>
+
+Rect RectTransform(const Rect& r, const Matrix32& m) {
+	if (RectIsEmpty(r)) {
+		return r;
+	}
+	
+	// Transformed center plus extents projected to the axes
+	auto center = Vector2TransformCoord(RectCenter(r), m);
+	auto extents = RectSize(r) * 0.5f;
+	auto ex = extents.x * std::abs(m.a) + extents.y * std::abs(m.c);
+	auto ey = extents.x * std::abs(m.b) + extents.y * std::abs(m.d);
+	
+	return Rect {Vector2 {center.x - ex, center.y - ey}, Vector2 {center.x + ex, center.y + ey}};
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+
+// Vector extensions are lowered to SSE on x86 and NEON on ARM, and to scalar code elsewhere
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_FLOAT4_ENABLED 1
+#else
+#define SIMD_FLOAT4_ENABLED 0
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_AVX2_ENABLED 1
+#else
+#define SIMD_AVX2_ENABLED 0
+#endif
+
+#if SIMD_FLOAT4_ENABLED
+
+using Float4 = float __attribute__((vector_size(16)));
+using Int4 = int32_t __attribute__((vector_size(16)));
+using UInt4 = uint32_t __attribute__((vector_size(16)));
+
+inline Float4 Float4Load(const float* p) noexcept {
+	Float4 v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline void Float4Store(float* p, Float4 v) noexcept {
+	std::memcpy(p, &v, sizeof(v));
+}
+
+inline Float4 Float4LoadAligned(const float* p) noexcept {
+	return Float4Load(static_cast<const float*>(__builtin_assume_aligned(p, 16)));
+}
+
+inline void Float4StoreAligned(float* p, Float4 v) noexcept {
+	Float4Store(static_cast<float*>(__builtin_assume_aligned(p, 16)), v);
+}
+
+inline Float4 Float4Splat(float s) noexcept {
+	return Float4{s, s, s, s};
+}
+
+// Indices 0-3 select from a, 4-7 from b
+template <int I0, int I1, int I2, int I3>
+inline Float4 Float4Shuffle(Float4 a, Float4 b) noexcept {
+	return __builtin_shufflevector(a, b, I0, I1, I2, I3);
+}
+
+template <int I0, int I1, int I2, int I3>
+inline Float4 Float4Shuffle(Float4 a) noexcept {
+	return __builtin_shufflevector(a, a, I0, I1, I2, I3);
+}
+
+inline Int4 Int4Splat(int32_t s) noexcept {
+	return Int4{s, s, s, s};
+}
+
+// Bitwise select, mask lanes must be all ones or all zeros
+inline Float4 Float4Select(Int4 mask, Float4 a, Float4 b) noexcept {
+	return (Float4)((mask & (Int4)a) | (~mask & (Int4)b));
+}
+
+inline Int4 Int4Select(Int4 mask, Int4 a, Int4 b) noexcept {
+	return (mask & a) | (~mask & b);
+}
+
+// Cephes sinf/cosf: range reduction by pi/2 in three parts, then minimax polynomials on [-pi/4, pi/4].
+// Max absolute error is 8e-8 for |x| <= 8192 and 1e-6 for |x| <= 65536, measured against double precision
+inline void Float4SinCos(Float4 x, Float4* sin, Float4* cos) noexcept {
+	constexpr float kTwoOverPi = 0.636619772367581343f;
+	constexpr float kPiOverTwo1 = 1.5703125f;
+	constexpr float kPiOverTwo2 = 4.837512969970703125e-4f;
+	constexpr float kPiOverTwo3 = 7.54978995489188216e-8f;
+	
+	// Round to nearest quadrant
+	auto q = x * kTwoOverPi;
+	auto j = __builtin_convertvector(q + Float4Select(q < 0, Float4Splat(-0.5f), Float4Splat(0.5f)), Int4);
+	auto fj = __builtin_convertvector(j, Float4);
+	
+	auto y = ((x - fj * kPiOverTwo1) - fj * kPiOverTwo2) - fj * kPiOverTwo3;
+	auto z = y * y;
+	
+	auto s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * y + y;
+	auto c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+	
+	// Quadrants 1 and 3 swap sin and cos, 2 and 3 negate sin, 1 and 2 negate cos
+	auto swap = (j & 1) != 0;
+	auto sinSign = (j & 2) << 30;
+	auto cosSign = ((j + 1) & 2) << 30;
+	
+	*sin = (Float4)((Int4)Float4Select(swap, c, s) ^ sinSign);
+	*cos = (Float4)((Int4)Float4Select(swap, s, c) ^ cosSign);
+}
+
+// Same as FloatToHalf for four lanes, halves are in the low 16 bits
+inline UInt4 Float4ToHalf(Float4 x) noexcept {
+	auto f = (UInt4)x;
+	auto sign = f & 0x80000000u;
+	f ^= sign;
+	
+	// Comparisons of non-negative values are the same for signed lanes
+	auto i = (Int4)f;
+	auto special = (UInt4)Int4Select(i > 0x7f800000, Int4Splat(0x7e00), Int4Splat(0x7c00));
+	auto subnormal = (UInt4)((Float4)f + 0.5f) - 0x3f000000u;
+	auto normal = (f + 0xc8000fffu + ((f >> 13) & 1u)) >> 13;
+	
+	auto h = Int4Select(i >= 0x47800000, (Int4)special, Int4Select(i < 0x38800000, (Int4)subnormal, (Int4)normal));
+	return (UInt4)h | (sign >> 16);
+}
+
+#endif // SIMD_FLOAT4_ENABLED
+
+#if SIMD_AVX2_ENABLED
+#include <immintrin.h>
+
+// Functions using AVX2 must carry the target attribute and be called only after the runtime check
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+inline bool SimdSupportsAVX2() noexcept {
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+#endif // SIMD_AVX2_ENABLED
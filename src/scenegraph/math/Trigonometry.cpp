@@ -0,0 +1,36 @@
+#include <scenegraph/math/Trigonometry.h>
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SinCosBatch(const float* rad, float* sin, float* cos, size_t count) {
+	size_t i = 0;
+	
+#if SIMD_FLOAT4_ENABLED
+	for (; i + 4 <= count; i += 4) {
+		Float4 s, c;
+		Float4SinCos(Float4Load(rad + i), &s, &c);
+		Float4Store(sin + i, s);
+		Float4Store(cos + i, c);
+	}
+	
+	// Tail goes through the same polynomial, so results do not depend on position in the array
+	if (i < count) {
+		float tail[4] = {};
+		std::copy(rad + i, rad + count, tail);
+		
+		Float4 s, c;
+		Float4SinCos(Float4Load(tail), &s, &c);
+		for (size_t k = 0; i < count; ++i, ++k) {
+			sin[i] = s[k];
+			cos[i] = c[k];
+		}
+	}
+#else
+	for (; i < count; ++i) {
+		sin[i] = std::sinf(rad[i]);
+		cos[i] = std::cosf(rad[i]);
+	}
+#endif
+}
@@ -4,13 +4,13 @@
 Vector2 Vector2TransformCoord(Vector2 v, const Matrix32& m) {
 	Vector2 out;
 	out.x = v.x * m.a + v.y * m.c + m.tx;
-	out.x = v.x * m.b + v.y * m.b + m.ty;
+	out.y = v.x * m.b + v.y * m.d + m.ty;
 	return out;
 }
 
 Vector2 Vector2TransformNormal(Vector2 v, const Matrix32& m) {
 	Vector2 out;
 	out.x = v.x * m.a + v.y * m.c;
-	out.x = v.x * m.b + v.y * m.b;
+	out.y = v.x * m.b + v.y * m.d;
 	return out;
 }
@@ -0,0 +1,75 @@
+#include <scenegraph/math/Vector3.h>
+#include <scenegraph/math/Matrix4.h>
+#include <scenegraph/math/Matrix43.h>
+#include "Simd.h"
+
+namespace {
+
+#if SIMD_FLOAT4_ENABLED
+
+// Four points take three vectors [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3], transposed to [x0 x1 x2 x3] etc.
+template <bool Project>
+void TransformArray(const Vector3* v, const Matrix4& m, Vector3* out, size_t count) noexcept {
+	static_assert(sizeof(Vector3) == 3 * sizeof(float));
+	
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		auto p = reinterpret_cast<const float*>(v + i);
+		auto v0 = Float4Load(p);
+		auto v1 = Float4Load(p + 4);
+		auto v2 = Float4Load(p + 8);
+		
+		auto x = Float4Shuffle<0, 1, 2, 5>(Float4Shuffle<0, 3, 6, 0>(v0, v1), v2);
+		auto y = Float4Shuffle<0, 1, 2, 6>(Float4Shuffle<1, 4, 7, 0>(v0, v1), v2);
+		auto z = Float4Shuffle<0, 1, 4, 7>(Float4Shuffle<2, 5, 0, 0>(v0, v1), v2);
+		
+		auto tx = x * m.m11 + y * m.m21 + z * m.m31 + m.m41;
+		auto ty = x * m.m12 + y * m.m22 + z * m.m32 + m.m42;
+		auto tz = x * m.m13 + y * m.m23 + z * m.m33 + m.m43;
+		
+		if constexpr (Project) {
+			auto w = 1.0f / (x * m.m14 + y * m.m24 + z * m.m34 + m.m44);
+			tx *= w;
+			ty *= w;
+			tz *= w;
+		}
+		
+		auto xy = Float4Shuffle<0, 4, 1, 5>(tx, ty);
+		auto yz = Float4Shuffle<1, 5, 2, 6>(ty, tz);
+		auto xy3 = Float4Shuffle<3, 7, 3, 7>(tx, ty);
+		
+		auto q = reinterpret_cast<float*>(out + i);
+		Float4Store(q, Float4Shuffle<0, 1, 4, 2>(xy, tz));
+		Float4Store(q + 4, Float4Shuffle<0, 1, 6, 2>(yz, tx));
+		Float4Store(q + 8, Float4Shuffle<6, 0, 1, 7>(xy3, tz));
+	}
+	
+	for (; i < count; ++i) {
+		out[i] = Project ? Vector3TransformAndProjectCoord(v[i], m) : Vector3Transform(v[i], m);
+	}
+}
+
+#else
+
+template <bool Project>
+void TransformArray(const Vector3* v, const Matrix4& m, Vector3* out, size_t count) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = Project ? Vector3TransformAndProjectCoord(v[i], m) : Vector3Transform(v[i], m);
+	}
+}
+
+#endif // SIMD_FLOAT4_ENABLED
+
+} // namespace
+
+void Vector3TransformArray(const Vector3* v, const Matrix4& m, Vector3* out, size_t count) {
+	TransformArray<false>(v, m, out, count);
+}
+
+void Vector3TransformArray(const Vector3* v, const Matrix43& m, Vector3* out, size_t count) {
+	TransformArray<false>(v, Matrix43ToMatrix4(m), out, count);
+}
+
+void Vector3TransformAndProjectCoordArray(const Vector3* v, const Matrix4& m, Vector3* out, size_t count) {
+	TransformArray<true>(v, m, out, count);
+}
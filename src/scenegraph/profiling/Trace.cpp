@@ -0,0 +1,222 @@
+#include <scenegraph/profiling/Trace.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct TraceEvent {
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+///
+/// Single producer single consumer ring of zones, written by the owning thread only
+///
+struct TraceBuffer {
+	static constexpr uint32_t kCapacity = 1 << 14;
+
+	TraceEvent events[kCapacity];
+	std::atomic<uint32_t> head = 0;
+	std::atomic<uint32_t> tail = 0;
+	std::atomic<uint32_t> dropped = 0;
+	uint32_t threadId = 0;
+	char name[32] = {};
+	// Owning thread has exited, the buffer is reused once its zones are written out
+	bool released = false;
+	std::unique_ptr<TraceBuffer> next;
+};
+
+struct TraceRegistry {
+	std::mutex mutex;
+	std::unique_ptr<TraceBuffer> buffers;
+	uint32_t threadCount = 0;
+	uint64_t startTicks = TraceTimestamp();
+	uint64_t startNanoseconds = TraceTimestampFallback();
+};
+
+// Never destroyed, threads may still record while static objects are being destroyed
+TraceRegistry& GetRegistry() noexcept {
+	static auto registry = new TraceRegistry;
+	return *registry;
+}
+
+thread_local TraceBuffer* tls_buffer = nullptr;
+thread_local bool tls_bufferReleased = false;
+
+TraceBuffer* AcquireBuffer() noexcept {
+	auto& registry = GetRegistry();
+	std::lock_guard lock{registry.mutex};
+
+	auto buffer = registry.buffers.get();
+	while (buffer && !(buffer->released && buffer->tail.load(std::memory_order::relaxed) == buffer->head.load(std::memory_order::relaxed))) {
+		buffer = buffer->next.get();
+	}
+
+	if (buffer) {
+		buffer->released = false;
+		buffer->dropped.store(0, std::memory_order::relaxed);
+		buffer->name[0] = '\0';
+	}
+	else {
+		auto newBuffer = std::make_unique<TraceBuffer>();
+		newBuffer->next = std::move(registry.buffers);
+		registry.buffers = std::move(newBuffer);
+		buffer = registry.buffers.get();
+	}
+
+	buffer->threadId = registry.threadCount++;
+	return buffer;
+}
+
+///
+/// Returns the buffer of the thread to the registry when the thread exits
+///
+struct TraceBufferOwner {
+	~TraceBufferOwner() {
+		std::lock_guard lock{GetRegistry().mutex};
+		tls_buffer->released = true;
+		tls_buffer = nullptr;
+		// Zones recorded by destructors of thread locals destroyed later are lost
+		tls_bufferReleased = true;
+	}
+};
+
+TraceBuffer* GetThreadBuffer() noexcept {
+	if (!tls_buffer && !tls_bufferReleased) {
+		tls_buffer = AcquireBuffer();
+		thread_local TraceBufferOwner owner;
+	}
+
+	return tls_buffer;
+}
+
+void WriteJsonString(FILE* file, const char* str) noexcept {
+	fputc('"', file);
+	for (; *str; ++str) {
+		auto c = static_cast<unsigned char>(*str);
+		if (c == '"' || c == '\\') {
+			fputc('\\', file);
+			fputc(c, file);
+		}
+		else if (c < 0x20) {
+			fprintf(file, "\\u%04x", c);
+		}
+		else {
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+} // namespace
+
+uint64_t TraceTimestampFallback() noexcept {
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+void TraceSetThreadName(const char* name) noexcept {
+	auto buffer = GetThreadBuffer();
+	if (!buffer) {
+		return;
+	}
+
+	std::lock_guard lock{GetRegistry().mutex};
+	snprintf(buffer->name, sizeof(buffer->name), "%s", name ? name : "");
+}
+
+void TraceRecord(const char* name, uint64_t begin, uint64_t end) noexcept {
+	auto buffer = GetThreadBuffer();
+	if (!buffer) {
+		return;
+	}
+
+	auto head = buffer->head.load(std::memory_order::relaxed);
+	if (head - buffer->tail.load(std::memory_order::acquire) >= TraceBuffer::kCapacity) {
+		// Older zones are kept, the newest ones are lost until the trace is written out
+		buffer->dropped.fetch_add(1, std::memory_order::relaxed);
+		return;
+	}
+
+	buffer->events[head % TraceBuffer::kCapacity] = {name, begin, end};
+	buffer->head.store(head + 1, std::memory_order::release);
+}
+
+bool TraceWriteChromeJson(FILE* file) noexcept {
+	if (!file) {
+		return false;
+	}
+
+	auto& registry = GetRegistry();
+	std::lock_guard lock{registry.mutex};
+
+	// Calibrate timestamp counter against the monotonic clock over the lifetime of the trace
+	auto elapsedTicks = TraceTimestamp() - registry.startTicks;
+	auto elapsedNanoseconds = TraceTimestampFallback() - registry.startNanoseconds;
+	auto microsecondsPerTick = elapsedTicks && elapsedNanoseconds
+		? static_cast<double>(elapsedNanoseconds) / static_cast<double>(elapsedTicks) / 1000.0
+		: 0.001;
+
+	auto toMicroseconds = [&](uint64_t ticks) {
+		return static_cast<double>(static_cast<int64_t>(ticks - registry.startTicks)) * microsecondsPerTick;
+	};
+
+	fputs("{\"traceEvents\":[", file);
+
+	bool first = true;
+	for (auto buffer = registry.buffers.get(); buffer; buffer = buffer->next.get()) {
+		if (buffer->name[0]) {
+			fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",", buffer->threadId);
+			WriteJsonString(file, buffer->name);
+			fputs("}}", file);
+			first = false;
+		}
+
+		auto head = buffer->head.load(std::memory_order::acquire);
+		auto tail = buffer->tail.load(std::memory_order::relaxed);
+		for (; tail != head; ++tail) {
+			auto& event = buffer->events[tail % TraceBuffer::kCapacity];
+			fprintf(file, "%s\n{\"name\":", first ? "" : ",");
+			WriteJsonString(file, event.name);
+			fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				buffer->threadId, toMicroseconds(event.begin), static_cast<double>(event.end - event.begin) * microsecondsPerTick);
+			first = false;
+		}
+		buffer->tail.store(head, std::memory_order::release);
+
+		if (auto dropped = buffer->dropped.exchange(0, std::memory_order::relaxed)) {
+			fprintf(file, "%s\n{\"name\":\"dropped %u zones\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+				first ? "" : ",", dropped, buffer->threadId, toMicroseconds(TraceTimestamp()));
+			first = false;
+		}
+	}
+
+	fputs("\n]}\n", file);
+
+	return !ferror(file);
+}
+
+size_t TraceGetThreadBufferCount() noexcept {
+	auto& registry = GetRegistry();
+	std::lock_guard lock{registry.mutex};
+
+	size_t count = 0;
+	for (auto buffer = registry.buffers.get(); buffer; buffer = buffer->next.get()) {
+		++count;
+	}
+	return count;
+}
+
+void TraceClear() noexcept {
+	auto& registry = GetRegistry();
+	std::lock_guard lock{registry.mutex};
+
+	for (auto buffer = registry.buffers.get(); buffer; buffer = buffer->next.get()) {
+		buffer->tail.store(buffer->head.load(std::memory_order::acquire), std::memory_order::release);
+		buffer->dropped.store(0, std::memory_order::relaxed);
+	}
+}
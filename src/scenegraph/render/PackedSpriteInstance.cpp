@@ -0,0 +1,123 @@
+#include <scenegraph/render/PackedSpriteInstance.h>
+#include <scenegraph/utils/FloatUtils.h>
+#include <scenegraph/utils/MurmurHash.h>
+#include "../math/Simd.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace {
+
+uint8_t QuantizeUnorm8(float x) noexcept {
+	return static_cast<uint8_t>(Clamp(x, 0, 1) * 255.0f + 0.5f);
+}
+
+#if SIMD_FLOAT4_ENABLED
+
+using UShort4 = uint16_t __attribute__((vector_size(8)));
+using UChar4 = uint8_t __attribute__((vector_size(4)));
+
+void PackTransformAndColor(const SpriteInstance& instance, PackedSpriteInstance& out) noexcept {
+	static_assert(offsetof(Matrix32, d) == 3 * sizeof(float));
+	
+	auto halves = __builtin_convertvector(Float4ToHalf(Float4Load(&instance.transform.a)), UShort4);
+	std::memcpy(&out.a, &halves, sizeof(halves));
+	
+	auto color = Float4Load(&instance.color.r);
+	color = Float4Select(color < 0.0f, Float4Splat(0), Float4Select(color > 1.0f, Float4Splat(1), color));
+	auto bytes = __builtin_convertvector(__builtin_convertvector(color * 255.0f + 0.5f, Int4), UChar4);
+	std::memcpy(&out.color, &bytes, sizeof(bytes));
+}
+
+#else
+
+void PackTransformAndColor(const SpriteInstance& instance, PackedSpriteInstance& out) noexcept {
+	out.a = FloatToHalf(instance.transform.a);
+	out.b = FloatToHalf(instance.transform.b);
+	out.c = FloatToHalf(instance.transform.c);
+	out.d = FloatToHalf(instance.transform.d);
+	out.color = ColorMakeWithVector4(FloatColorToVector4(instance.color));
+}
+
+#endif // SIMD_FLOAT4_ENABLED
+
+} // namespace
+
+void SpriteRectTable::Clear() noexcept {
+	_rects.clear();
+	_indices.clear();
+	_lastIndex = 0;
+}
+
+uint16_t SpriteRectTable::Add(const SpriteRect& rect) noexcept {
+	auto same = [&rect](const SpriteRect& other) { return std::memcmp(&rect, &other, sizeof(SpriteRect)) == 0; };
+	
+	if (_lastIndex < _rects.size() && same(_rects[_lastIndex])) {
+		return _lastIndex;
+	}
+	
+	auto hash = Hash(rect);
+	auto [first, last] = _indices.equal_range(hash);
+	for (auto it = first; it != last; ++it) {
+		if (same(_rects[it->second])) {
+			_lastIndex = it->second;
+			return _lastIndex;
+		}
+	}
+	
+	assert(_rects.size() < kMaxRects);
+	if (_rects.size() >= kMaxRects) {
+		return 0;
+	}
+	
+	_lastIndex = static_cast<uint16_t>(_rects.size());
+	_rects.push_back(rect);
+	_indices.emplace(hash, _lastIndex);
+	
+	return _lastIndex;
+}
+
+uint64_t SpriteRectTable::Hash(const SpriteRect& rect) noexcept {
+	uint64_t bits[2];
+	std::memcpy(bits, &rect, sizeof(bits));
+	return Murmur3Finalize64(bits[0] ^ Murmur3Finalize64(bits[1]));
+}
+
+void SpriteInstancePack(const SpriteInstance* instances, PackedSpriteInstance* out, size_t count, SpriteRectTable& rects) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		auto& instance = instances[i];
+		auto& packed = out[i];
+		
+		packed.tx = instance.transform.tx;
+		packed.ty = instance.transform.ty;
+		PackTransformAndColor(instance, packed);
+		packed.rectIndex = rects.Add(SpriteRect {
+			.u = instance.texU,
+			.v = instance.texV,
+			.w = instance.texW,
+			.h = instance.texH
+		});
+		packed.pivotX = QuantizeUnorm8(instance.pivotX);
+		packed.pivotY = QuantizeUnorm8(instance.pivotY);
+	}
+}
+
+SpriteInstance SpriteInstanceUnpack(const PackedSpriteInstance& instance, const SpriteRectTable& rects) noexcept {
+	constexpr float kUnorm8 = 1.0f / 255.0f;
+	
+	auto& rect = rects.GetRects()[instance.rectIndex];
+	return SpriteInstance {
+		.transform = {
+			HalfToFloat(instance.a), HalfToFloat(instance.b),
+			HalfToFloat(instance.c), HalfToFloat(instance.d),
+			instance.tx, instance.ty
+		},
+		.pivotX = instance.pivotX * kUnorm8,
+		.pivotY = instance.pivotY * kUnorm8,
+		.color = FloatColorMakeWithColor(instance.color),
+		.texU = rect.u,
+		.texV = rect.v,
+		.texW = rect.w,
+		.texH = rect.h
+	};
+}
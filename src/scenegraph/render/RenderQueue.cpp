@@ -0,0 +1,165 @@
+#include <scenegraph/render/RenderQueue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <numeric>
+
+namespace {
+
+// Below this size the fixed cost of histograms outweighs the comparison sort
+constexpr size_t kRadixSortThreshold = 256;
+
+constexpr uint32_t kRadixBits = 11;
+constexpr uint32_t kRadixBuckets = 1u << kRadixBits;
+constexpr uint32_t kRadixPasses = (sizeof(RenderSortKey) * CHAR_BIT + kRadixBits - 1) / kRadixBits;
+
+void* GetObject(const std::vector<void*>& objects, uint32_t id) noexcept {
+	return id < objects.size() ? objects[id] : nullptr;
+}
+
+} // namespace
+
+uint32_t RenderQueue::Register(std::vector<void*>& objects, void* object, uint32_t maxCount) noexcept {
+	auto it = std::find(objects.begin(), objects.end(), object);
+	if (it != objects.end()) {
+		return static_cast<uint32_t>(it - objects.begin());
+	}
+	
+	assert(objects.size() < maxCount);
+	if (objects.size() >= maxCount) {
+		return 0;
+	}
+	
+	objects.push_back(object);
+	return static_cast<uint32_t>(objects.size() - 1);
+}
+
+void RenderQueue::Clear() noexcept {
+	_keys.clear();
+	_ranges.clear();
+	_sortedKeys.clear();
+	_sortedItems.clear();
+	_draws.clear();
+}
+
+void RenderQueue::Add(RenderSortKey key, uint32_t firstInstance, uint32_t instanceCount) noexcept {
+	_keys.push_back(key);
+	_ranges.push_back(InstanceRange {
+		.first = firstInstance,
+		.count = instanceCount
+	});
+}
+
+void RenderQueue::Sort() noexcept {
+	RadixSort();
+	MergeDraws();
+}
+
+void RenderQueue::RadixSort() noexcept {
+	auto count = _keys.size();
+	
+	_sortedKeys.resize(count);
+	_sortedItems.resize(count);
+	
+	// Items with equal keys keep the order they were added in both cases
+	if (count < kRadixSortThreshold) {
+		std::iota(_sortedItems.begin(), _sortedItems.end(), 0u);
+		std::stable_sort(_sortedItems.begin(), _sortedItems.end(), [this](uint32_t a, uint32_t b) { return _keys[a] < _keys[b]; });
+		for (size_t i = 0; i < count; ++i) {
+			_sortedKeys[i] = _keys[_sortedItems[i]];
+		}
+		return;
+	}
+	
+	_entries.resize(count);
+	_tempEntries.resize(count);
+	
+	// Histograms of all digits in one pass over the keys
+	uint32_t histograms[kRadixPasses][kRadixBuckets] = {};
+	for (size_t i = 0; i < count; ++i) {
+		auto key = _keys[i];
+		_entries[i] = SortEntry {
+			.key = key,
+			.item = static_cast<uint32_t>(i)
+		};
+		for (uint32_t pass = 0; pass < kRadixPasses; ++pass) {
+			++histograms[pass][(key >> (pass * kRadixBits)) & (kRadixBuckets - 1)];
+		}
+	}
+	
+	for (uint32_t pass = 0; pass < kRadixPasses; ++pass) {
+		auto shift = pass * kRadixBits;
+		auto& histogram = histograms[pass];
+		
+		// Digits equal in all keys, e.g. unused layers, do not change the order
+		if (histogram[(_keys[0] >> shift) & (kRadixBuckets - 1)] == count) {
+			continue;
+		}
+		
+		uint32_t offsets[kRadixBuckets];
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < kRadixBuckets; ++bucket) {
+			offsets[bucket] = offset;
+			offset += histogram[bucket];
+		}
+		
+		// Key and item move together, so each element is written once
+		for (auto& entry : _entries) {
+			_tempEntries[offsets[(entry.key >> shift) & (kRadixBuckets - 1)]++] = entry;
+		}
+		
+		std::swap(_entries, _tempEntries);
+	}
+	
+	for (size_t i = 0; i < count; ++i) {
+		_sortedKeys[i] = _entries[i].key;
+		_sortedItems[i] = _entries[i].item;
+	}
+}
+
+void RenderQueue::MergeDraws() noexcept {
+	_draws.clear();
+	
+	uint32_t state = UINT32_MAX;
+	for (size_t i = 0; i < _sortedKeys.size(); ++i) {
+		auto key = _sortedKeys[i];
+		auto& range = _ranges[_sortedItems[i]];
+		auto previousState = state;
+		state = RenderKeyGetState(key);
+		
+		if (state == previousState) {
+			auto& draw = _draws.back();
+			if (draw.firstInstance + draw.instanceCount == range.first) {
+				draw.instanceCount += range.count;
+				continue;
+			}
+		}
+		
+		auto pipeline = GetObject(_pipelines, RenderKeyGetPipeline(key));
+		auto texture = GetObject(_textures, RenderKeyGetTexture(key));
+		auto sampler = GetObject(_samplers, RenderKeyGetSampler(key));
+		
+		// Only state differing from the previous draw is bound again
+		auto binds = RenderBind::None;
+		auto previous = _draws.empty() ? nullptr : &_draws.back();
+		if (!previous || previous->pipeline != pipeline) {
+			binds = binds | RenderBind::Pipeline;
+		}
+		if (!previous || previous->texture != texture) {
+			binds = binds | RenderBind::Texture;
+		}
+		if (!previous || previous->sampler != sampler) {
+			binds = binds | RenderBind::Sampler;
+		}
+		
+		_draws.push_back(RenderDraw {
+			.pipeline = pipeline,
+			.texture = texture,
+			.sampler = sampler,
+			.firstInstance = range.first,
+			.instanceCount = range.count,
+			.binds = binds
+		});
+	}
+}
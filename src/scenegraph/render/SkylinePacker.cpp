@@ -0,0 +1,255 @@
+#include <scenegraph/render/SkylinePacker.h>
+
+#include <algorithm>
+#include <cassert>
+
+void SkylinePacker::Reset(uint32_t width, uint32_t height) noexcept {
+	_width = width;
+	_height = height;
+	_usedArea = 0;
+	_minWidth = UINT32_MAX;
+	_minHeight = UINT32_MAX;
+	
+	_skyline.clear();
+	_skyline.push_back({0, 0, width});
+	_freeRects.clear();
+}
+
+bool SkylinePacker::Insert(uint32_t width, uint32_t height, AtlasRect* rect) noexcept {
+	assert(width > 0 && height > 0);
+	
+	_minWidth = std::min(_minWidth, width);
+	_minHeight = std::min(_minHeight, height);
+	
+	if (!InsertFree(width, height, rect) && !InsertSkyline(width, height, rect)) {
+		return false;
+	}
+	
+	_usedArea += uint64_t{width} * height;
+	return true;
+}
+
+void SkylinePacker::Free(const AtlasRect& rect) noexcept {
+	assert(rect.x + rect.width <= _width && rect.y + rect.height <= _height);
+	assert(_usedArea >= uint64_t{rect.width} * rect.height);
+	
+	_usedArea -= uint64_t{rect.width} * rect.height;
+	if (_usedArea == 0) {
+		Reset(_width, _height);
+		return;
+	}
+	
+	// Nothing is above a rectangle touching the skyline along its whole top, so the skyline is lowered instead
+	auto first = std::find_if(_skyline.begin(), _skyline.end(), [&rect](const Segment& s) { return s.x + s.width > rect.x; });
+	auto last = first;
+	while (last != _skyline.end() && last->x < rect.x + rect.width && last->y == rect.y + rect.height) {
+		++last;
+	}
+	if (first == last || (last != _skyline.end() && last->x < rect.x + rect.width)) {
+		AddFreeRect(rect);
+		return;
+	}
+	
+	// Cut segments at the edges of the rectangle and replace the span by one lowered segment
+	auto top = first->y;
+	auto right = std::prev(last)->x + std::prev(last)->width;
+	auto leftSegment = Segment {first->x, top, rect.x - first->x};
+	auto rightSegment = Segment {rect.x + rect.width, top, right - rect.x - rect.width};
+	auto index = static_cast<size_t>(first - _skyline.begin());
+	_skyline.erase(first, last);
+	
+	Segment lowered {rect.x, rect.y, rect.width};
+	// Free rectangles stacked right under the freed one go down with it
+	for (auto it = _freeRects.begin(); it != _freeRects.end();) {
+		if (it->x == lowered.x && it->width == lowered.width && it->y + it->height == lowered.y) {
+			lowered.y = it->y;
+			*it = _freeRects.back();
+			_freeRects.pop_back();
+			it = _freeRects.begin();
+		}
+		else {
+			++it;
+		}
+	}
+	
+	Segment segments[3];
+	size_t count = 0;
+	if (leftSegment.width) {
+		segments[count++] = leftSegment;
+	}
+	segments[count++] = lowered;
+	if (rightSegment.width) {
+		segments[count++] = rightSegment;
+	}
+	_skyline.insert(_skyline.begin() + static_cast<ptrdiff_t>(index), segments, segments + count);
+	
+	// Merge neighbours of the same height
+	auto begin = index ? index - 1 : 0;
+	auto end = std::min(index + count + 1, _skyline.size());
+	for (auto i = begin; i + 1 < end;) {
+		if (_skyline[i].y == _skyline[i + 1].y) {
+			_skyline[i].width += _skyline[i + 1].width;
+			_skyline.erase(_skyline.begin() + static_cast<ptrdiff_t>(i) + 1);
+			--end;
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+float SkylinePacker::GetOccupancy() const noexcept {
+	auto area = uint64_t{_width} * _height;
+	return area ? static_cast<float>(static_cast<double>(_usedArea) / static_cast<double>(area)) : 0.0f;
+}
+
+bool SkylinePacker::InsertFree(uint32_t width, uint32_t height, AtlasRect* rect) noexcept {
+	auto best = _freeRects.end();
+	auto bestArea = UINT64_MAX;
+	for (auto it = _freeRects.begin(); it != _freeRects.end(); ++it) {
+		if (it->width < width || it->height < height) {
+			continue;
+		}
+		auto area = uint64_t{it->width} * it->height;
+		if (area < bestArea) {
+			best = it;
+			bestArea = area;
+		}
+	}
+	
+	if (best == _freeRects.end()) {
+		return false;
+	}
+	
+	auto free = *best;
+	*best = _freeRects.back();
+	_freeRects.pop_back();
+	
+	*rect = AtlasRect {free.x, free.y, width, height};
+	
+	// Split along the shorter leftover side, which keeps the larger part in one piece
+	auto leftoverWidth = free.width - width;
+	auto leftoverHeight = free.height - height;
+	if (leftoverWidth < leftoverHeight) {
+		AddFreeRect({free.x + width, free.y, leftoverWidth, height});
+		AddFreeRect({free.x, free.y + height, free.width, leftoverHeight});
+	}
+	else {
+		AddFreeRect({free.x + width, free.y, leftoverWidth, free.height});
+		AddFreeRect({free.x, free.y + height, width, leftoverHeight});
+	}
+	
+	return true;
+}
+
+bool SkylinePacker::InsertSkyline(uint32_t width, uint32_t height, AtlasRect* rect) noexcept {
+	auto bestSegment = _skyline.size();
+	uint32_t bestY = 0;
+	uint32_t bestTop = UINT32_MAX;
+	uint32_t bestWidth = UINT32_MAX;
+	for (size_t i = 0; i < _skyline.size(); ++i) {
+		uint32_t y;
+		if (!Fit(i, width, height, &y)) {
+			continue;
+		}
+		// Lowest top first, then the narrowest segment which leaves wider ones for larger rectangles
+		if (y + height < bestTop || (y + height == bestTop && _skyline[i].width < bestWidth)) {
+			bestSegment = i;
+			bestY = y;
+			bestTop = y + height;
+			bestWidth = _skyline[i].width;
+		}
+	}
+	
+	if (bestSegment == _skyline.size()) {
+		return false;
+	}
+	
+	auto x = _skyline[bestSegment].x;
+	*rect = AtlasRect {x, bestY, width, height};
+	
+	// Gaps under the rectangle become free rectangles, then covered segments are cut
+	auto right = x + width;
+	auto i = bestSegment;
+	while (i < _skyline.size() && _skyline[i].x < right) {
+		auto& segment = _skyline[i];
+		auto segmentRight = segment.x + segment.width;
+		// Slivers smaller than any rectangle so far would only slow down the search
+		if (bestY - segment.y >= _minHeight && std::min(segmentRight, right) - segment.x >= _minWidth) {
+			AddFreeRect({segment.x, segment.y, std::min(segmentRight, right) - segment.x, bestY - segment.y});
+		}
+		if (segmentRight <= right) {
+			++i;
+			continue;
+		}
+		segment.width = segmentRight - right;
+		segment.x = right;
+		break;
+	}
+	_skyline.erase(_skyline.begin() + static_cast<ptrdiff_t>(bestSegment), _skyline.begin() + static_cast<ptrdiff_t>(i));
+	_skyline.insert(_skyline.begin() + static_cast<ptrdiff_t>(bestSegment), Segment {x, bestTop, width});
+	
+	// Merge with neighbours of the same height
+	if (bestSegment + 1 < _skyline.size() && _skyline[bestSegment + 1].y == bestTop) {
+		_skyline[bestSegment].width += _skyline[bestSegment + 1].width;
+		_skyline.erase(_skyline.begin() + static_cast<ptrdiff_t>(bestSegment) + 1);
+	}
+	if (bestSegment > 0 && _skyline[bestSegment - 1].y == bestTop) {
+		_skyline[bestSegment - 1].width += _skyline[bestSegment].width;
+		_skyline.erase(_skyline.begin() + static_cast<ptrdiff_t>(bestSegment));
+	}
+	
+	return true;
+}
+
+bool SkylinePacker::Fit(size_t segment, uint32_t width, uint32_t height, uint32_t* y) const noexcept {
+	auto x = _skyline[segment].x;
+	if (x + width > _width) {
+		return false;
+	}
+	
+	uint32_t top = 0;
+	for (auto i = segment; i < _skyline.size() && _skyline[i].x < x + width; ++i) {
+		top = std::max(top, _skyline[i].y);
+		if (top + height > _height) {
+			return false;
+		}
+	}
+	
+	*y = top;
+	return true;
+}
+
+void SkylinePacker::AddFreeRect(AtlasRect rect) noexcept {
+	if (!rect.width || !rect.height) {
+		return;
+	}
+	
+	// Merge with neighbours sharing a whole edge until none is left
+	for (size_t i = 0; i < _freeRects.size();) {
+		auto& free = _freeRects[i];
+		bool vertical = free.x == rect.x && free.width == rect.width &&
+			(free.y + free.height == rect.y || rect.y + rect.height == free.y);
+		bool horizontal = free.y == rect.y && free.height == rect.height &&
+			(free.x + free.width == rect.x || rect.x + rect.width == free.x);
+		if (!vertical && !horizontal) {
+			++i;
+			continue;
+		}
+		
+		if (vertical) {
+			rect.y = std::min(rect.y, free.y);
+			rect.height += free.height;
+		}
+		else {
+			rect.x = std::min(rect.x, free.x);
+			rect.width += free.width;
+		}
+		
+		free = _freeRects.back();
+		_freeRects.pop_back();
+		i = 0;
+	}
+	
+	_freeRects.push_back(rect);
+}
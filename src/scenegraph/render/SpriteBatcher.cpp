@@ -0,0 +1,175 @@
+#include <scenegraph/render/SpriteBatcher.h>
+#include <scenegraph/render/UploadManager.h>
+#include <scenegraph/threading/ThreadPool.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/components/SpriteComponent.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/profiling/Trace.h>
+
+namespace {
+
+constexpr auto kIdentity = Matrix32MakeIdentity();
+
+const Matrix32& FindWorldTransform(SceneObject object) noexcept {
+	auto transform = object.FindComponent<Transform2DComponent>();
+	if (!transform) {
+		transform = object.FindComponentInParent<Transform2DComponent>();
+	}
+	return transform ? transform->GetWorldTransform() : kIdentity;
+}
+
+// Hidden sprites hide their children too
+bool HasHiddenParentSprite(SceneObject object) noexcept {
+	while ((object = object.Parent())) {
+		if (auto sprite = object.FindComponent<SpriteComponent>(); sprite && !sprite->visible) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace
+
+SpriteInstance SpriteInstanceMake(const SpriteComponent& sprite, const Matrix32& worldTransform) noexcept {
+	auto& m = worldTransform;
+	auto& uv = sprite.textureRect;
+	return SpriteInstance {
+		.transform = {
+			m.a * sprite.size.x, m.b * sprite.size.x,
+			m.c * sprite.size.y, m.d * sprite.size.y,
+			m.tx, m.ty
+		},
+		.pivotX = sprite.pivot.x,
+		.pivotY = sprite.pivot.y,
+		.color = sprite.color,
+		.texU = uv.min.x,
+		.texV = uv.min.y,
+		.texW = uv.max.x - uv.min.x,
+		.texH = uv.max.y - uv.min.y
+	};
+}
+
+void SpriteBatcher::Clear() noexcept {
+	_items.clear();
+	_instances.clear();
+	_batches.clear();
+}
+
+void SpriteBatcher::Build(SceneObject root) noexcept {
+	TRACE_ZONE("SpriteBatcher::Build");
+	
+	AppendChildren(root, true);
+}
+
+void SpriteBatcher::Build(const SceneObject* objects, size_t count) noexcept {
+	TRACE_ZONE("SpriteBatcher::Build");
+	
+	AppendObjects(objects, count, true);
+}
+
+void SpriteBatcher::Gather(SceneObject root) noexcept {
+	TRACE_ZONE("SpriteBatcher::Gather");
+	
+	AppendChildren(root, false);
+}
+
+void SpriteBatcher::Gather(const SceneObject* objects, size_t count) noexcept {
+	TRACE_ZONE("SpriteBatcher::Gather");
+	
+	AppendObjects(objects, count, false);
+}
+
+void SpriteBatcher::Write(SpriteInstance* instances, ThreadPool* pool) const noexcept {
+	TRACE_ZONE("SpriteBatcher::Write");
+	
+	if (!pool) {
+		WriteRange(instances, 0, _items.size());
+		return;
+	}
+	
+	pool->ParallelFor(0, _items.size(), kChunkSize, [this, instances](size_t first, size_t last) {
+		WriteRange(instances + first, first, last);
+	});
+}
+
+void SpriteBatcher::Upload(UploadManager& uploads, void* buffer, uint32_t offset, ThreadPool* pool) const noexcept {
+	TRACE_ZONE("SpriteBatcher::Upload");
+	
+	if (_items.empty()) {
+		return;
+	}
+	
+	// Chunks take consecutive ranges of the ring in any order, their places in the buffer are fixed
+	auto upload = [this, &uploads, buffer, offset](size_t first, size_t last) {
+		auto size = static_cast<uint32_t>((last - first) * sizeof(SpriteInstance));
+		auto data = uploads.Upload(buffer, offset + static_cast<uint32_t>(first * sizeof(SpriteInstance)), size);
+		WriteRange(static_cast<SpriteInstance*>(data), first, last);
+	};
+	
+	if (!pool) {
+		upload(0, _items.size());
+		return;
+	}
+	
+	uploads.Reserve(static_cast<uint32_t>(_items.size() * sizeof(SpriteInstance)));
+	pool->ParallelFor(0, _items.size(), kChunkSize, upload);
+}
+
+void SpriteBatcher::AppendChildren(SceneObject root, bool write) noexcept {
+	_path.clear();
+	_path.push_back({&FindWorldTransform(root), false});
+	
+	root.WalkChildren(EnumDirection::FirstToLast, EnumCallOrder::PreOrder | EnumCallOrder::PostOrder,
+		[this, write](SceneObject object, EnumCallOrder callOrder, bool&) {
+			if (callOrder == EnumCallOrder::PostOrder) {
+				_path.pop_back();
+				return;
+			}
+			
+			auto entry = _path.back();
+			if (auto transform = object.FindComponent<Transform2DComponent>()) {
+				entry.worldTransform = &transform->GetWorldTransform();
+			}
+			
+			if (auto sprite = object.FindComponent<SpriteComponent>(); sprite && !entry.hidden) {
+				if (sprite->visible) {
+					Append(*sprite, *entry.worldTransform, write);
+				}
+				else {
+					entry.hidden = true;
+				}
+			}
+			
+			_path.push_back(entry);
+		});
+}
+
+void SpriteBatcher::AppendObjects(const SceneObject* objects, size_t count, bool write) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		auto object = objects[i];
+		if (auto sprite = object.FindComponent<SpriteComponent>(); sprite && sprite->visible && !HasHiddenParentSprite(object)) {
+			Append(*sprite, FindWorldTransform(object), write);
+		}
+	}
+}
+
+void SpriteBatcher::Append(const SpriteComponent& sprite, const Matrix32& worldTransform, bool write) noexcept {
+	auto index = static_cast<uint32_t>(_items.size());
+	if (_batches.empty() || _batches.back().texture != sprite.texture || _batches.back().pipeline != sprite.pipeline) {
+		_batches.push_back({sprite.texture, sprite.pipeline, index, 0});
+	}
+	++_batches.back().instanceCount;
+	
+	_items.push_back({&sprite, &worldTransform});
+	
+	// Writing while the sprite is in cache is cheaper than a separate pass
+	if (write) {
+		_instances.push_back(SpriteInstanceMake(sprite, worldTransform));
+	}
+}
+
+void SpriteBatcher::WriteRange(SpriteInstance* instances, size_t first, size_t last) const noexcept {
+	for (auto i = first; i < last; ++i) {
+		*instances++ = SpriteInstanceMake(*_items[i].sprite, *_items[i].worldTransform);
+	}
+}
@@ -0,0 +1,126 @@
+#include <scenegraph/render/SpriteInstanceBuffer.h>
+#include <scenegraph/render/UploadManager.h>
+#include <scenegraph/Scene.h>
+#include <scenegraph/components/SpriteComponent.h>
+#include <scenegraph/components/Transform2DComponent.h>
+#include <scenegraph/profiling/Trace.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr auto kIdentity = Matrix32MakeIdentity();
+
+const Transform2DComponent* FindTransform(SceneObject object) noexcept {
+	auto transform = object.FindComponent<Transform2DComponent>();
+	return transform ? transform : object.FindComponentInParent<Transform2DComponent>();
+}
+
+} // namespace
+
+void SpriteInstanceBuffer::Update(SceneObject root) noexcept {
+	TRACE_ZONE("SpriteInstanceBuffer::Update");
+	
+	_batches.clear();
+	_count = 0;
+	
+	_path.clear();
+	_path.push_back({FindTransform(root), false});
+	
+	root.WalkChildren(EnumDirection::FirstToLast, EnumCallOrder::PreOrder | EnumCallOrder::PostOrder,
+		[this](SceneObject object, EnumCallOrder callOrder, bool&) {
+			if (callOrder == EnumCallOrder::PostOrder) {
+				_path.pop_back();
+				return;
+			}
+			
+			auto entry = _path.back();
+			if (auto transform = object.FindComponent<Transform2DComponent>()) {
+				entry.transform = transform;
+			}
+			
+			if (auto sprite = object.FindComponent<SpriteComponent>(); sprite && !entry.hidden) {
+				if (sprite->visible) {
+					Write(*sprite, entry.transform);
+				}
+				else {
+					entry.hidden = true;
+				}
+			}
+			
+			_path.push_back(entry);
+		});
+		
+	// Slots of sprites gone from the end need no upload
+	_instances.resize(_count);
+	_slots.resize(_count);
+	
+	std::erase_if(_dirtyRanges, [this](const SpriteDirtyRange& range) { return range.first >= _count; });
+	for (auto& range : _dirtyRanges) {
+		range.count = std::min(range.count, _count - range.first);
+	}
+}
+
+void SpriteInstanceBuffer::Upload(UploadManager& uploads, void* buffer) noexcept {
+	for (auto& range : _dirtyRanges) {
+		auto size = static_cast<uint32_t>(range.count * sizeof(SpriteInstance));
+		auto data = uploads.Upload(buffer, static_cast<uint32_t>(range.first * sizeof(SpriteInstance)), size);
+		std::memcpy(data, _instances.data() + range.first, size);
+	}
+	
+	_dirtyRanges.clear();
+}
+
+void SpriteInstanceBuffer::Invalidate() noexcept {
+	_dirtyRanges.clear();
+	if (!_instances.empty()) {
+		_dirtyRanges.push_back({0, static_cast<uint32_t>(_instances.size())});
+	}
+}
+
+void SpriteInstanceBuffer::Write(const SpriteComponent& sprite, const Transform2DComponent* transform) noexcept {
+	auto index = _count++;
+	if (_batches.empty() || _batches.back().texture != sprite.texture || _batches.back().pipeline != sprite.pipeline) {
+		_batches.push_back({sprite.texture, sprite.pipeline, index, 0});
+	}
+	++_batches.back().instanceCount;
+	
+	auto worldVersion = transform ? transform->GetWorldVersion() : 0;
+	if (index < _slots.size()) {
+		auto& slot = _slots[index];
+		if (slot.sprite == &sprite && slot.spriteVersion == sprite.GetVersion() && slot.worldVersion == worldVersion) {
+			return;
+		}
+	}
+	else {
+		_slots.resize(index + 1);
+		_instances.resize(index + 1);
+	}
+	
+	_slots[index] = Slot {
+		.sprite = &sprite,
+		.spriteVersion = sprite.GetVersion(),
+		.worldVersion = worldVersion
+	};
+	_instances[index] = SpriteInstanceMake(sprite, transform ? transform->GetWorldTransform() : kIdentity);
+	
+	MarkDirty(index);
+}
+
+void SpriteInstanceBuffer::MarkDirty(uint32_t slot) noexcept {
+	if (!_dirtyRanges.empty()) {
+		auto& last = _dirtyRanges.back();
+		auto end = last.first + last.count;
+		// Ranges left from an update without upload may start later
+		if (slot >= last.first && slot < end) {
+			return;
+		}
+		if (slot >= end && slot - end < kMergeGap) {
+			last.count = slot + 1 - last.first;
+			return;
+		}
+	}
+	
+	_dirtyRanges.push_back({slot, 1});
+}
@@ -0,0 +1,123 @@
+#include <scenegraph/render/TextureAtlas.h>
+#include <scenegraph/profiling/Trace.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+AtlasRect AtlasRectUnion(const AtlasRect& r1, const AtlasRect& r2) noexcept {
+	if (!r1.width) {
+		return r2;
+	}
+	auto x = std::min(r1.x, r2.x);
+	auto y = std::min(r1.y, r2.y);
+	auto right = std::max(r1.x + r1.width, r2.x + r2.width);
+	auto bottom = std::max(r1.y + r1.height, r2.y + r2.height);
+	return AtlasRect {x, y, right - x, bottom - y};
+}
+
+} // namespace
+
+TextureAtlas::TextureAtlas(uint32_t pageSize, uint32_t padding, uint32_t maxPages) noexcept
+	: _pageSize(pageSize)
+	, _padding(padding)
+	, _maxPages(maxPages)
+{
+	assert(pageSize > 2 * padding);
+}
+
+TextureAtlas::RegionId TextureAtlas::Insert(const Color* pixels, uint32_t width, uint32_t height) noexcept {
+	TRACE_ZONE("TextureAtlas::Insert");
+	
+	assert(pixels && width > 0 && height > 0);
+	
+	auto paddedWidth = width + 2 * _padding;
+	auto paddedHeight = height + 2 * _padding;
+	if (paddedWidth > _pageSize || paddedHeight > _pageSize) {
+		return kInvalidRegion;
+	}
+	
+	AtlasRect rect;
+	auto page = std::find_if(_pages.begin(), _pages.end(), [&](auto& p) { return p->packer.Insert(paddedWidth, paddedHeight, &rect); });
+	if (page == _pages.end()) {
+		if (_pages.size() >= _maxPages) {
+			return kInvalidRegion;
+		}
+		
+		auto newPage = std::make_unique<Page>(Page {
+			.packer = SkylinePacker(_pageSize, _pageSize),
+			.pixels = std::make_unique<Color[]>(size_t{_pageSize} * _pageSize),
+			.dirtyRect = {}
+		});
+		newPage->packer.Insert(paddedWidth, paddedHeight, &rect);
+		_pages.push_back(std::move(newPage));
+		page = std::prev(_pages.end());
+	}
+	
+	CopyPixels(**page, rect, pixels);
+	
+	RegionId region;
+	if (_freeHead != kInvalidRegion) {
+		region = _freeHead;
+		_freeHead = _regions[region].nextFree;
+		--_freeCount;
+	}
+	else {
+		region = static_cast<RegionId>(_regions.size());
+		_regions.emplace_back();
+	}
+	
+	_regions[region] = Region {
+		.page = static_cast<uint32_t>(page - _pages.begin()),
+		.rect = {rect.x + _padding, rect.y + _padding, width, height},
+		.nextFree = kInvalidRegion
+	};
+	
+	return region;
+}
+
+void TextureAtlas::Remove(RegionId region) noexcept {
+	assert(region < _regions.size() && _regions[region].rect.width);
+	
+	auto& r = _regions[region];
+	auto& page = *_pages[r.page];
+	
+	// Texels stay until overwritten, the page is not read outside of live regions
+	page.packer.Free({r.rect.x - _padding, r.rect.y - _padding, r.rect.width + 2 * _padding, r.rect.height + 2 * _padding});
+	
+	r = Region {0, {}, _freeHead};
+	_freeHead = region;
+	++_freeCount;
+}
+
+Rect TextureAtlas::GetTextureRect(RegionId region) const noexcept {
+	auto& rect = _regions[region].rect;
+	auto scale = 1.0f / static_cast<float>(_pageSize);
+	return RectMakeWithOriginAndSize(static_cast<float>(rect.x) * scale, static_cast<float>(rect.y) * scale,
+		static_cast<float>(rect.width) * scale, static_cast<float>(rect.height) * scale);
+}
+
+void TextureAtlas::ClearDirtyRects() noexcept {
+	for (auto& page : _pages) {
+		page->dirtyRect = {};
+	}
+}
+
+void TextureAtlas::CopyPixels(Page& page, const AtlasRect& rect, const Color* pixels) noexcept {
+	auto width = rect.width - 2 * _padding;
+	auto height = rect.height - 2 * _padding;
+	
+	// Padding rows and columns repeat the nearest edge of the image
+	for (uint32_t y = 0; y < rect.height; ++y) {
+		auto sourceY = std::clamp(y, _padding, _padding + height - 1) - _padding;
+		auto source = pixels + size_t{sourceY} * width;
+		auto target = page.pixels.get() + size_t{rect.y + y} * _pageSize + rect.x;
+		
+		std::fill_n(target, _padding, source[0]);
+		std::copy_n(source, width, target + _padding);
+		std::fill_n(target + _padding + width, _padding, source[width - 1]);
+	}
+	
+	page.dirtyRect = AtlasRectUnion(page.dirtyRect, rect);
+}
@@ -0,0 +1,224 @@
+#include <scenegraph/render/UploadManager.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+UploadManager::UploadManager(UploadDevice& device, uint32_t capacity, uint32_t maxFramesInFlight) noexcept
+	: _device(device)
+	, _capacity(std::bit_ceil(std::max(capacity, kDefaultAlignment)))
+	, _maxFramesInFlight(std::max(maxFramesInFlight, 1u))
+{
+	_transferBuffer = _device.CreateTransferBuffer(_capacity);
+	assert(_transferBuffer != nullptr);
+}
+
+UploadManager::~UploadManager() {
+	WaitIdle();
+	
+	// Buffers retired during the last unsubmitted frame are left
+	for (auto& retired : _retiredBuffers) {
+		if (retired.mapped) {
+			_device.UnmapTransferBuffer(retired.transferBuffer);
+		}
+		_device.ReleaseTransferBuffer(retired.transferBuffer);
+	}
+	
+	if (_mappedData) {
+		_device.UnmapTransferBuffer(_transferBuffer);
+	}
+	_device.ReleaseTransferBuffer(_transferBuffer);
+}
+
+void UploadManager::BeginFrame() noexcept {
+	while (!_frames.empty() && _device.IsFenceSignaled(_frames.front().fence)) {
+		CompleteFrame();
+	}
+	
+	while (_frames.size() >= _maxFramesInFlight) {
+		_device.WaitForFence(_frames.front().fence);
+		CompleteFrame();
+	}
+	
+	ReleaseRetiredBuffers();
+}
+
+void UploadManager::Reserve(uint32_t size, uint32_t alignment) noexcept {
+	assert(std::has_single_bit(alignment));
+	
+	// Trial allocation is rolled back, uploads take the same space in order
+	auto head = _head;
+	uint32_t offset;
+	if (Allocate(size, alignment, &offset)) {
+		_head = head;
+	}
+	else {
+		Grow(size, alignment);
+	}
+	
+	Map();
+}
+
+void* UploadManager::Upload(void* buffer, uint32_t offset, uint32_t size, uint32_t alignment) noexcept {
+	assert(buffer != nullptr);
+	assert(size > 0);
+	assert(std::has_single_bit(alignment));
+	
+	std::lock_guard lock{_mutex};
+	
+	uint32_t transferOffset = 0;
+	if (!Allocate(size, alignment, &transferOffset)) {
+		Grow(size, alignment);
+		
+		[[maybe_unused]] auto allocated = Allocate(size, alignment, &transferOffset);
+		assert(allocated);
+	}
+	
+	Map();
+	
+	// Consecutive uploads into consecutive ranges of the buffer are copied at once
+	if (!_regions.empty()) {
+		auto& last = _regions.back();
+		if (last.transferBuffer == _transferBuffer && last.buffer == buffer &&
+			last.transferOffset + last.size == transferOffset && last.bufferOffset + last.size == offset)
+		{
+			last.size += size;
+			return _mappedData + transferOffset;
+		}
+	}
+	
+	_regions.push_back(UploadRegion {
+		.transferBuffer = _transferBuffer,
+		.transferOffset = transferOffset,
+		.buffer = buffer,
+		.bufferOffset = offset,
+		.size = size
+	});
+	
+	return _mappedData + transferOffset;
+}
+
+void UploadManager::Flush(void* commandBuffer) noexcept {
+	if (_regions.empty()) {
+		return;
+	}
+	
+	// Transfer buffers must be unmapped before the copy
+	if (_mappedData) {
+		_device.UnmapTransferBuffer(_transferBuffer);
+		_mappedData = nullptr;
+	}
+	
+	for (auto& retired : _retiredBuffers) {
+		if (retired.mapped) {
+			_device.UnmapTransferBuffer(retired.transferBuffer);
+			retired.mapped = false;
+		}
+	}
+	
+	_device.UploadToBuffers(commandBuffer, _regions.data(), _regions.size());
+	_regions.clear();
+}
+
+void UploadManager::EndFrame(void* commandBuffer) noexcept {
+	Flush(commandBuffer);
+	
+	_frames.push_back(Frame {
+		.fence = _device.Submit(commandBuffer),
+		.transferBuffer = _transferBuffer,
+		.serial = ++_serial,
+		.head = _head
+	});
+}
+
+void UploadManager::WaitIdle() noexcept {
+	while (!_frames.empty()) {
+		_device.WaitForFence(_frames.front().fence);
+		CompleteFrame();
+	}
+	
+	ReleaseRetiredBuffers();
+}
+
+bool UploadManager::Allocate(uint32_t size, uint32_t alignment, uint32_t* offset) noexcept {
+	uint64_t capacity = _capacity;
+	auto position = (_head + alignment - 1) & ~uint64_t{alignment - 1};
+	
+	// Data must not wrap around the end of the buffer, skip to the start of the next lap
+	if ((position & (capacity - 1)) + size > capacity) {
+		position = (position | (capacity - 1)) + 1;
+	}
+	
+	if (position + size - _tail > capacity) {
+		return false;
+	}
+	
+	*offset = static_cast<uint32_t>(position & (capacity - 1));
+	_head = position + size;
+	
+	return true;
+}
+
+void UploadManager::Map() noexcept {
+	if (!_mappedData) {
+		_mappedData = static_cast<std::byte*>(_device.MapTransferBuffer(_transferBuffer));
+		assert(_mappedData != nullptr);
+	}
+}
+
+void UploadManager::Grow(uint32_t size, uint32_t alignment) noexcept {
+	assert(_capacity <= UINT32_MAX / 2);
+	
+	// Data in the current buffer stays until the frame being recorded completes
+	_retiredBuffers.push_back(RetiredBuffer {
+		.transferBuffer = _transferBuffer,
+		.serial = _serial + 1,
+		.mapped = _mappedData != nullptr
+	});
+	
+	_capacity = std::max({_capacity * 2, std::bit_ceil(size), alignment});
+	_transferBuffer = _device.CreateTransferBuffer(_capacity);
+	assert(_transferBuffer != nullptr);
+	
+	_mappedData = nullptr;
+	_head = 0;
+	_tail = 0;
+}
+
+void UploadManager::CompleteFrame() noexcept {
+	auto& frame = _frames.front();
+	
+	// Frames using retired buffers give nothing back to the ring
+	if (frame.transferBuffer == _transferBuffer) {
+		_tail = frame.head;
+		
+		// Empty ring starts over, so allocations of its whole capacity fit again. Frames still in flight uploaded
+		// nothing past the tail, their heads start over too
+		if (_tail == _head) {
+			for (auto& next : _frames) {
+				if (next.transferBuffer == _transferBuffer) {
+					next.head = 0;
+				}
+			}
+			_head = 0;
+			_tail = 0;
+		}
+	}
+	
+	_device.ReleaseFence(frame.fence);
+	_completedSerial = frame.serial;
+	
+	_frames.erase(_frames.begin());
+}
+
+void UploadManager::ReleaseRetiredBuffers() noexcept {
+	auto retired = std::remove_if(_retiredBuffers.begin(), _retiredBuffers.end(), [this](const RetiredBuffer& buffer) {
+		if (buffer.serial > _completedSerial) {
+			return false;
+		}
+		assert(!buffer.mapped);
+		_device.ReleaseTransferBuffer(buffer.transferBuffer);
+		return true;
+	});
+	_retiredBuffers.erase(retired, _retiredBuffers.end());
+}
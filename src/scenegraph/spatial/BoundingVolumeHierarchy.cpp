@@ -0,0 +1,474 @@
+#include <scenegraph/spatial/BoundingVolumeHierarchy.h>
+#include <scenegraph/math/Frustum.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kBinCount = 16;
+// Changes since the last build relative to the number of proxies which trigger a rebuild
+constexpr size_t kRebuildChangeRatio = 2;
+// Small trees are cheap to refit however poor they are
+constexpr size_t kMinRebuildSize = 64;
+
+bool AABBEqual(const AABB& b1, const AABB& b2) noexcept {
+	return std::memcmp(&b1, &b2, sizeof(AABB)) == 0;
+}
+
+float AxisOf(const Vector3& v, int axis) noexcept {
+	return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+bool AABBIntersectSphere(const AABB& b, const Sphere& s) noexcept {
+	auto closest = Vector3Min(Vector3Max(s.origin, b.min), b.max);
+	return Vector3LengthSq(closest - s.origin) <= s.radius * s.radius;
+}
+
+} // namespace
+
+BoundingVolumeHierarchy::ProxyId BoundingVolumeHierarchy::Insert(SceneObject sceneObject, const AABB& bounds) noexcept {
+	ProxyId proxy;
+	if (_freeProxy != kInvalidProxy) {
+		proxy = _freeProxy;
+		_freeProxy = _proxies[proxy].nextFree;
+		--_freeCount;
+	}
+	else {
+		proxy = static_cast<ProxyId>(_proxies.size());
+		_proxies.emplace_back();
+	}
+	
+	auto leaf = AllocateNode();
+	_nodes[static_cast<size_t>(leaf)] = Node {bounds, kNullNode, {kNullNode, kNullNode}, proxy, false};
+	_proxies[proxy] = Proxy {bounds, sceneObject, leaf, kInvalidProxy};
+	
+	InsertLeaf(leaf);
+	++_changesSinceBuild;
+	
+	return proxy;
+}
+
+void BoundingVolumeHierarchy::Move(ProxyId proxy, const AABB& bounds) noexcept {
+	assert(proxy < _proxies.size());
+	
+	auto& p = _proxies[proxy];
+	p.bounds = bounds;
+	
+	auto& leaf = _nodes[static_cast<size_t>(p.leaf)];
+	leaf.bounds = bounds;
+	if (!leaf.moved) {
+		leaf.moved = true;
+		_movedLeaves.push_back(p.leaf);
+	}
+}
+
+void BoundingVolumeHierarchy::Remove(ProxyId proxy) noexcept {
+	assert(proxy < _proxies.size());
+	
+	auto& p = _proxies[proxy];
+	auto leaf = p.leaf;
+	
+	if (_nodes[static_cast<size_t>(leaf)].moved) {
+		auto it = std::find(_movedLeaves.begin(), _movedLeaves.end(), leaf);
+		*it = _movedLeaves.back();
+		_movedLeaves.pop_back();
+	}
+	
+	RemoveLeaf(leaf);
+	FreeNode(leaf);
+	
+	p = Proxy {AABBMakeEmpty(), SceneObject{}, kNullNode, _freeProxy};
+	_freeProxy = proxy;
+	++_freeCount;
+	++_changesSinceBuild;
+}
+
+void BoundingVolumeHierarchy::Clear() noexcept {
+	_nodes.clear();
+	_root = kNullNode;
+	_freeNode = kNullNode;
+	_proxies.clear();
+	_freeProxy = kInvalidProxy;
+	_freeCount = 0;
+	_movedLeaves.clear();
+	_changesSinceBuild = 0;
+}
+
+void BoundingVolumeHierarchy::Refit() noexcept {
+	_changesSinceBuild += _movedLeaves.size();
+	
+	if (Size() >= kMinRebuildSize && _changesSinceBuild > Size() * kRebuildChangeRatio) {
+		Rebuild();
+		return;
+	}
+	
+	for (auto leaf : _movedLeaves) {
+		auto& node = _nodes[static_cast<size_t>(leaf)];
+		node.moved = false;
+		RefitAncestors(node.parent);
+	}
+	
+	_movedLeaves.clear();
+}
+
+void BoundingVolumeHierarchy::Rebuild() noexcept {
+	_nodes.clear();
+	_nodes.reserve(Size() * 2);
+	_freeNode = kNullNode;
+	_root = kNullNode;
+	_movedLeaves.clear();
+	_changesSinceBuild = 0;
+	
+	std::vector<NodeIndex> leaves;
+	leaves.reserve(Size());
+	
+	for (ProxyId proxy = 0; proxy < _proxies.size(); ++proxy) {
+		auto& p = _proxies[proxy];
+		if (p.leaf == kNullNode) {
+			continue;
+		}
+		
+		p.leaf = static_cast<NodeIndex>(_nodes.size());
+		_nodes.push_back(Node {p.bounds, kNullNode, {kNullNode, kNullNode}, proxy, false});
+		leaves.push_back(p.leaf);
+	}
+	
+	if (!leaves.empty()) {
+		_root = Build(leaves.data(), leaves.size());
+		_nodes[static_cast<size_t>(_root)].parent = kNullNode;
+	}
+}
+
+float BoundingVolumeHierarchy::Cost() const noexcept {
+	if (_root == kNullNode) {
+		return 0;
+	}
+	
+	// Free nodes have no children and are skipped along with leaves
+	float area = 0;
+	for (auto& node : _nodes) {
+		if (!node.IsLeaf()) {
+			area += AABBSurfaceArea(node.bounds);
+		}
+	}
+	
+	auto rootArea = AABBSurfaceArea(_nodes[static_cast<size_t>(_root)].bounds);
+	return rootArea > 0 ? area / rootArea : 0;
+}
+
+bool BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, QueryCallback callback, void* context) noexcept {
+	if (!callback || _root == kNullNode) {
+		return false;
+	}
+	
+	bool stop = false;
+	
+	_stack.clear();
+	_stack.push_back({_root, false});
+	
+	while (!_stack.empty()) {
+		auto entry = _stack.back();
+		_stack.pop_back();
+		
+		auto& node = _nodes[static_cast<size_t>(entry.node)];
+		auto inside = entry.inside;
+		if (!inside) {
+			if (FrustumCullAABB(frustum, node.bounds)) {
+				continue;
+			}
+			// Whole subtree is visible, no more tests needed
+			inside = FrustumContainsAABB(frustum, node.bounds);
+		}
+		
+		if (node.IsLeaf()) {
+			callback(_proxies[node.proxy].sceneObject, stop, context);
+			if (stop) {
+				return true;
+			}
+		}
+		else {
+			_stack.push_back({node.children[1], inside});
+			_stack.push_back({node.children[0], inside});
+		}
+	}
+	
+	return false;
+}
+
+bool BoundingVolumeHierarchy::QuerySphere(const Sphere& sphere, QueryCallback callback, void* context) noexcept {
+	if (!callback || _root == kNullNode) {
+		return false;
+	}
+	
+	bool stop = false;
+	
+	_stack.clear();
+	_stack.push_back({_root, false});
+	
+	while (!_stack.empty()) {
+		auto& node = _nodes[static_cast<size_t>(_stack.back().node)];
+		_stack.pop_back();
+		
+		if (!AABBIntersectSphere(node.bounds, sphere)) {
+			continue;
+		}
+		
+		if (node.IsLeaf()) {
+			callback(_proxies[node.proxy].sceneObject, stop, context);
+			if (stop) {
+				return true;
+			}
+		}
+		else {
+			_stack.push_back({node.children[1], false});
+			_stack.push_back({node.children[0], false});
+		}
+	}
+	
+	return false;
+}
+
+bool BoundingVolumeHierarchy::RayCast(const Vector3& origin, const Vector3& direction, float maxDistance, RayCastCallback callback, void* context) noexcept {
+	if (!callback || _root == kNullNode) {
+		return false;
+	}
+	
+	// Division by zero gives infinities which slab test handles
+	auto inverse = Vector3Make(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	
+	auto intersect = [&origin, &inverse, maxDistance](const AABB& b, float& distance) {
+		auto tx1 = (b.min.x - origin.x) * inverse.x;
+		auto tx2 = (b.max.x - origin.x) * inverse.x;
+		auto ty1 = (b.min.y - origin.y) * inverse.y;
+		auto ty2 = (b.max.y - origin.y) * inverse.y;
+		auto tz1 = (b.min.z - origin.z) * inverse.z;
+		auto tz2 = (b.max.z - origin.z) * inverse.z;
+		
+		auto tmin = std::max({std::min(tx1, tx2), std::min(ty1, ty2), std::min(tz1, tz2), 0.0f});
+		auto tmax = std::min({std::max(tx1, tx2), std::max(ty1, ty2), std::max(tz1, tz2), maxDistance});
+		
+		distance = tmin;
+		return tmin <= tmax;
+	};
+	
+	bool stop = false;
+	
+	_stack.clear();
+	_stack.push_back({_root, false});
+	
+	while (!_stack.empty()) {
+		auto& node = _nodes[static_cast<size_t>(_stack.back().node)];
+		_stack.pop_back();
+		
+		float distance;
+		if (!intersect(node.bounds, distance)) {
+			continue;
+		}
+		
+		if (node.IsLeaf()) {
+			callback(_proxies[node.proxy].sceneObject, distance, stop, context);
+			if (stop) {
+				return true;
+			}
+		}
+		else {
+			_stack.push_back({node.children[1], false});
+			_stack.push_back({node.children[0], false});
+		}
+	}
+	
+	return false;
+}
+
+BoundingVolumeHierarchy::NodeIndex BoundingVolumeHierarchy::AllocateNode() noexcept {
+	if (_freeNode != kNullNode) {
+		auto node = _freeNode;
+		_freeNode = _nodes[static_cast<size_t>(node)].parent;
+		return node;
+	}
+	
+	_nodes.emplace_back();
+	return static_cast<NodeIndex>(_nodes.size() - 1);
+}
+
+void BoundingVolumeHierarchy::FreeNode(NodeIndex node) noexcept {
+	// Free nodes are linked through parent
+	_nodes[static_cast<size_t>(node)] = Node {AABBMakeEmpty(), _freeNode, {kNullNode, kNullNode}, kInvalidProxy, false};
+	_freeNode = node;
+}
+
+void BoundingVolumeHierarchy::InsertLeaf(NodeIndex leaf) noexcept {
+	if (_root == kNullNode) {
+		_root = leaf;
+		_nodes[static_cast<size_t>(leaf)].parent = kNullNode;
+		return;
+	}
+	
+	auto bounds = _nodes[static_cast<size_t>(leaf)].bounds;
+	
+	// Descend to the sibling with the least surface area cost, creating a parent adds union area
+	// and every ancestor grows by its enlargement
+	auto sibling = _root;
+	while (!_nodes[static_cast<size_t>(sibling)].IsLeaf()) {
+		auto& node = _nodes[static_cast<size_t>(sibling)];
+		auto area = AABBSurfaceArea(node.bounds);
+		auto combinedArea = AABBSurfaceArea(AABBUnion(node.bounds, bounds));
+		
+		auto cost = 2 * combinedArea;
+		auto inheritanceCost = 2 * (combinedArea - area);
+		
+		float childCost[2];
+		for (int i = 0; i < 2; ++i) {
+			auto& child = _nodes[static_cast<size_t>(node.children[i])];
+			auto enlarged = AABBSurfaceArea(AABBUnion(child.bounds, bounds));
+			childCost[i] = (child.IsLeaf() ? enlarged : enlarged - AABBSurfaceArea(child.bounds)) + inheritanceCost;
+		}
+		
+		if (cost < childCost[0] && cost < childCost[1]) {
+			break;
+		}
+		
+		sibling = childCost[0] <= childCost[1] ? node.children[0] : node.children[1];
+	}
+	
+	auto oldParent = _nodes[static_cast<size_t>(sibling)].parent;
+	auto newParent = AllocateNode();
+	
+	_nodes[static_cast<size_t>(newParent)] = Node {
+		AABBUnion(_nodes[static_cast<size_t>(sibling)].bounds, bounds), oldParent, {sibling, leaf}, kInvalidProxy, false
+	};
+	_nodes[static_cast<size_t>(sibling)].parent = newParent;
+	_nodes[static_cast<size_t>(leaf)].parent = newParent;
+	
+	if (oldParent == kNullNode) {
+		_root = newParent;
+	}
+	else {
+		auto& children = _nodes[static_cast<size_t>(oldParent)].children;
+		children[children[0] == sibling ? 0 : 1] = newParent;
+		RefitAncestors(oldParent);
+	}
+}
+
+void BoundingVolumeHierarchy::RemoveLeaf(NodeIndex leaf) noexcept {
+	if (leaf == _root) {
+		_root = kNullNode;
+		return;
+	}
+	
+	auto parent = _nodes[static_cast<size_t>(leaf)].parent;
+	auto& parentNode = _nodes[static_cast<size_t>(parent)];
+	auto grandParent = parentNode.parent;
+	auto sibling = parentNode.children[parentNode.children[0] == leaf ? 1 : 0];
+	
+	_nodes[static_cast<size_t>(sibling)].parent = grandParent;
+	FreeNode(parent);
+	
+	if (grandParent == kNullNode) {
+		_root = sibling;
+	}
+	else {
+		auto& children = _nodes[static_cast<size_t>(grandParent)].children;
+		children[children[0] == parent ? 0 : 1] = sibling;
+		RefitAncestors(grandParent);
+	}
+}
+
+void BoundingVolumeHierarchy::RefitAncestors(NodeIndex node) noexcept {
+	while (node != kNullNode) {
+		auto& n = _nodes[static_cast<size_t>(node)];
+		auto bounds = AABBUnion(_nodes[static_cast<size_t>(n.children[0])].bounds, _nodes[static_cast<size_t>(n.children[1])].bounds);
+		// Ancestors already enclose unchanged bounds
+		if (AABBEqual(bounds, n.bounds)) {
+			break;
+		}
+		n.bounds = bounds;
+		node = n.parent;
+	}
+}
+
+BoundingVolumeHierarchy::NodeIndex BoundingVolumeHierarchy::Build(NodeIndex* leaves, size_t count) noexcept {
+	if (count == 1) {
+		return leaves[0];
+	}
+	
+	auto centroid = [this](NodeIndex leaf) { return AABBCenter(_nodes[static_cast<size_t>(leaf)].bounds); };
+	
+	auto bounds = AABBMakeEmpty();
+	auto centroidBounds = AABBMakeEmpty();
+	for (size_t i = 0; i < count; ++i) {
+		bounds = AABBUnion(bounds, _nodes[static_cast<size_t>(leaves[i])].bounds);
+		centroidBounds = AABBAddPoint(centroidBounds, centroid(leaves[i]));
+	}
+	
+	// Split along the longest axis of centroids
+	auto extents = centroidBounds.max - centroidBounds.min;
+	int axis = extents.x >= extents.y && extents.x >= extents.z ? 0 : extents.y >= extents.z ? 1 : 2;
+	auto axisMin = AxisOf(centroidBounds.min, axis);
+	auto axisExtent = AxisOf(extents, axis);
+	
+	size_t middle = count / 2;
+	
+	if (axisExtent > 0) {
+		struct Bin {
+			AABB bounds = AABBMakeEmpty();
+			size_t count = 0;
+		};
+		
+		Bin bins[kBinCount];
+		auto binScale = static_cast<float>(kBinCount) / axisExtent;
+		auto binOf = [&](NodeIndex leaf) {
+			auto bin = static_cast<size_t>((AxisOf(centroid(leaf), axis) - axisMin) * binScale);
+			return std::min(bin, kBinCount - 1);
+		};
+		
+		for (size_t i = 0; i < count; ++i) {
+			auto& bin = bins[binOf(leaves[i])];
+			bin.bounds = AABBUnion(bin.bounds, _nodes[static_cast<size_t>(leaves[i])].bounds);
+			++bin.count;
+		}
+		
+		// Cost of splitting after each bin, accumulated from both sides
+		float rightCost[kBinCount];
+		auto accumulated = AABBMakeEmpty();
+		size_t accumulatedCount = 0;
+		for (size_t i = kBinCount - 1; i > 0; --i) {
+			accumulated = AABBUnion(accumulated, bins[i].bounds);
+			accumulatedCount += bins[i].count;
+			rightCost[i - 1] = accumulatedCount ? AABBSurfaceArea(accumulated) * static_cast<float>(accumulatedCount) : 0;
+		}
+		
+		auto bestCost = std::numeric_limits<float>::max();
+		size_t bestSplit = 0;
+		accumulated = AABBMakeEmpty();
+		accumulatedCount = 0;
+		for (size_t i = 0; i + 1 < kBinCount; ++i) {
+			accumulated = AABBUnion(accumulated, bins[i].bounds);
+			accumulatedCount += bins[i].count;
+			auto cost = (accumulatedCount ? AABBSurfaceArea(accumulated) * static_cast<float>(accumulatedCount) : 0) + rightCost[i];
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestSplit = i;
+			}
+		}
+		
+		auto it = std::partition(leaves, leaves + count, [&](NodeIndex leaf) { return binOf(leaf) <= bestSplit; });
+		auto split = static_cast<size_t>(it - leaves);
+		if (split > 0 && split < count) {
+			middle = split;
+		}
+	}
+	
+	auto node = AllocateNode();
+	auto left = Build(leaves, middle);
+	auto right = Build(leaves + middle, count - middle);
+	
+	_nodes[static_cast<size_t>(node)] = Node {bounds, kNullNode, {left, right}, kInvalidProxy, false};
+	_nodes[static_cast<size_t>(left)].parent = node;
+	_nodes[static_cast<size_t>(right)].parent = node;
+	
+	return node;
+}
@@ -0,0 +1,253 @@
+#include <scenegraph/spatial/SpatialGrid2D.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+// Keeps cell coordinates of huge or infinite bounds in range of int32_t
+int32_t CellCoordinate(float x) noexcept {
+	constexpr float kLimit = 1 << 30;
+	return static_cast<int32_t>(std::floor(std::clamp(x, -kLimit, kLimit)));
+}
+
+} // namespace
+
+bool SpatialGrid2D::CellRange::Oversized() const noexcept {
+	auto width = static_cast<int64_t>(maxX) - minX + 1;
+	auto height = static_cast<int64_t>(maxY) - minY + 1;
+	return width * height > kMaxCellsPerProxy;
+}
+
+SpatialGrid2D::SpatialGrid2D(float cellSize) noexcept
+	: _cellSize(cellSize)
+	, _inverseCellSize(1.0f / cellSize)
+{
+	assert(cellSize > 0);
+}
+
+SpatialGrid2D::ProxyId SpatialGrid2D::Insert(SceneObject sceneObject, const Rect& bounds) noexcept {
+	ProxyId proxy;
+	if (_freeHead != kInvalidProxy) {
+		proxy = _freeHead;
+		_freeHead = _proxies[proxy].nextFree;
+		--_freeCount;
+	}
+	else {
+		proxy = static_cast<ProxyId>(_proxies.size());
+		_proxies.emplace_back();
+	}
+	
+	auto cells = GetCellRange(bounds);
+	_proxies[proxy] = Proxy {bounds, sceneObject, cells, _queryStamp, kInvalidProxy};
+	Link(proxy, cells);
+	
+	return proxy;
+}
+
+void SpatialGrid2D::Update(ProxyId proxy, const Rect& bounds) noexcept {
+	assert(proxy < _proxies.size());
+	
+	auto& p = _proxies[proxy];
+	p.bounds = bounds;
+	
+	auto cells = GetCellRange(bounds);
+	if (cells == p.cells) {
+		return;
+	}
+	
+	Unlink(proxy, p.cells);
+	p.cells = cells;
+	Link(proxy, cells);
+}
+
+void SpatialGrid2D::Remove(ProxyId proxy) noexcept {
+	assert(proxy < _proxies.size());
+	
+	auto& p = _proxies[proxy];
+	Unlink(proxy, p.cells);
+	
+	p = Proxy {RectMakeEmpty(), SceneObject{}, GetCellRange(RectMakeEmpty()), 0, _freeHead};
+	_freeHead = proxy;
+	++_freeCount;
+}
+
+void SpatialGrid2D::Clear() noexcept {
+	_proxies.clear();
+	_freeHead = kInvalidProxy;
+	_freeCount = 0;
+	_cells.clear();
+	_emptyCellCount = 0;
+	_oversized.clear();
+}
+
+void SpatialGrid2D::Compact() noexcept {
+	std::erase_if(_cells, [](const auto& cell) { return cell.second.empty(); });
+	_emptyCellCount = 0;
+}
+
+bool SpatialGrid2D::QueryPoint(Vector2 p, QueryCallback callback, void* context) noexcept {
+	if (!callback) {
+		return false;
+	}
+	
+	bool stop = false;
+	
+	for (auto proxy : _oversized) {
+		if (RectContainsPoint(_proxies[proxy].bounds, p)) {
+			callback(_proxies[proxy].sceneObject, stop, context);
+			if (stop) {
+				return true;
+			}
+		}
+	}
+	
+	// Point falls into a single cell, no duplicates possible
+	auto it = _cells.find(CellKey(CellCoordinate(p.x * _inverseCellSize), CellCoordinate(p.y * _inverseCellSize)));
+	if (it != _cells.end()) {
+		for (auto proxy : it->second) {
+			if (RectContainsPoint(_proxies[proxy].bounds, p)) {
+				callback(_proxies[proxy].sceneObject, stop, context);
+				if (stop) {
+					return true;
+				}
+			}
+		}
+	}
+	
+	return false;
+}
+
+bool SpatialGrid2D::QueryRect(const Rect& r, QueryCallback callback, void* context) noexcept {
+	if (!callback || RectIsEmpty(r)) {
+		return false;
+	}
+	
+	if (++_queryStamp == 0) {
+		for (auto& p : _proxies) {
+			p.queryStamp = 0;
+		}
+		_queryStamp = 1;
+	}
+	
+	bool stop = false;
+	
+	auto report = [this, &r, &stop, callback, context](ProxyId proxy) {
+		auto& p = _proxies[proxy];
+		if (p.queryStamp != _queryStamp && RectIntersect(p.bounds, r)) {
+			p.queryStamp = _queryStamp;
+			callback(p.sceneObject, stop, context);
+		}
+		return stop;
+	};
+	
+	for (auto proxy : _oversized) {
+		if (report(proxy)) {
+			return true;
+		}
+	}
+	
+	auto cells = GetCellRange(r);
+	auto cellCount = (static_cast<int64_t>(cells.maxX) - cells.minX + 1) * (static_cast<int64_t>(cells.maxY) - cells.minY + 1);
+	
+	if (cellCount > static_cast<int64_t>(_cells.size())) {
+		// Query covers more cells than there are occupied ones
+		for (auto& [key, proxies] : _cells) {
+			auto x = static_cast<int32_t>(key >> 32);
+			auto y = static_cast<int32_t>(key & 0xffffffff);
+			if (x >= cells.minX && x <= cells.maxX && y >= cells.minY && y <= cells.maxY) {
+				for (auto proxy : proxies) {
+					if (report(proxy)) {
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+	
+	for (auto y = cells.minY; y <= cells.maxY; ++y) {
+		for (auto x = cells.minX; x <= cells.maxX; ++x) {
+			auto it = _cells.find(CellKey(x, y));
+			if (it == _cells.end()) {
+				continue;
+			}
+			for (auto proxy : it->second) {
+				if (report(proxy)) {
+					return true;
+				}
+			}
+		}
+	}
+	
+	return false;
+}
+
+SpatialGrid2D::CellRange SpatialGrid2D::GetCellRange(const Rect& bounds) const noexcept {
+	if (RectIsEmpty(bounds)) {
+		return CellRange {0, 0, -1, -1};
+	}
+	
+	return CellRange {
+		CellCoordinate(bounds.min.x * _inverseCellSize),
+		CellCoordinate(bounds.min.y * _inverseCellSize),
+		CellCoordinate(bounds.max.x * _inverseCellSize),
+		CellCoordinate(bounds.max.y * _inverseCellSize)
+	};
+}
+
+void SpatialGrid2D::Link(ProxyId proxy, const CellRange& cells) noexcept {
+	if (cells.Empty()) {
+		return;
+	}
+	
+	if (cells.Oversized()) {
+		_oversized.push_back(proxy);
+		return;
+	}
+	
+	for (auto y = cells.minY; y <= cells.maxY; ++y) {
+		for (auto x = cells.minX; x <= cells.maxX; ++x) {
+			auto [it, inserted] = _cells.try_emplace(CellKey(x, y));
+			if (!inserted && it->second.empty()) {
+				--_emptyCellCount;
+			}
+			it->second.push_back(proxy);
+		}
+	}
+}
+
+void SpatialGrid2D::Unlink(ProxyId proxy, const CellRange& cells) noexcept {
+	auto erase = [proxy](std::vector<ProxyId>& proxies) {
+		auto it = std::find(proxies.begin(), proxies.end(), proxy);
+		assert(it != proxies.end());
+		*it = proxies.back();
+		proxies.pop_back();
+	};
+	
+	if (cells.Empty()) {
+		return;
+	}
+	
+	if (cells.Oversized()) {
+		erase(_oversized);
+		return;
+	}
+	
+	for (auto y = cells.minY; y <= cells.maxY; ++y) {
+		for (auto x = cells.minX; x <= cells.maxX; ++x) {
+			auto it = _cells.find(CellKey(x, y));
+			assert(it != _cells.end());
+			erase(it->second);
+			if (it->second.empty()) {
+				++_emptyCellCount;
+			}
+		}
+	}
+	
+	// Cells are freed in bulk, so objects moving back and forth across a cell boundary do not allocate
+	if (_emptyCellCount > kMinPrunedCells && _emptyCellCount > _cells.size() - _emptyCellCount) {
+		Compact();
+	}
+}
@@ -0,0 +1,131 @@
+#include <scenegraph/threading/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace {
+
+struct ParallelForJob {
+	std::atomic<size_t> next;
+	size_t end;
+	size_t grain;
+	void (*callback)(size_t begin, size_t end, void* context);
+	void* context;
+};
+
+void RunChunks(ParallelForJob& job) noexcept {
+	for (;;) {
+		auto begin = job.next.fetch_add(job.grain, std::memory_order::relaxed);
+		if (begin >= job.end) {
+			break;
+		}
+
+		job.callback(begin, std::min(job.end - begin, job.grain) + begin, job.context);
+	}
+}
+
+void RunChunks(void* param) noexcept {
+	RunChunks(*static_cast<ParallelForJob*>(param));
+}
+
+} // namespace
+
+size_t ThreadPool::DefaultThreadCount() noexcept {
+	auto concurrency = static_cast<size_t>(std::thread::hardware_concurrency());
+	return concurrency > 1 ? concurrency - 1 : 1;
+}
+
+ThreadPool::ThreadPool(size_t threadCount, const WorkThreadOptions& options) noexcept
+	: _parallelTasks(std::make_unique<PipeTask[]>(threadCount))
+{
+	_threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		_threads.push_back(std::make_unique<WorkThread>(options));
+	}
+}
+
+WorkThreadStats ThreadPool::GetStats() const noexcept {
+	WorkThreadStats stats;
+	for (auto& thread : _threads) {
+		auto threadStats = thread->GetStats();
+		stats.tasksExecuted += threadStats.tasksExecuted;
+		stats.busyNanoseconds += threadStats.busyNanoseconds;
+		stats.idleNanoseconds += threadStats.idleNanoseconds;
+	}
+	return stats;
+}
+
+void ThreadPool::Push(PipeTask* task) noexcept {
+	if (_threads.empty()) {
+		assert(false);
+		return;
+	}
+
+	_threads[_nextThread]->Push(task);
+	_nextThread = (_nextThread + 1) % _threads.size();
+}
+
+PipeTask* ThreadPool::TryPop() noexcept {
+	for (auto& thread : _threads) {
+		if (auto task = thread->TryPop()) {
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+void ThreadPool::WaitAll() noexcept {
+	for (auto& thread : _threads) {
+		thread->WaitAll();
+	}
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain, ParallelForCallback callback, void* context) noexcept {
+	if (begin >= end) {
+		return;
+	}
+
+	if (grain == 0) {
+		grain = 1;
+	}
+
+	ParallelForJob job{{begin}, end, grain, callback, context};
+
+	// Pipe tasks are preallocated per thread, so a nested loop runs inline
+	auto chunkCount = (end - begin + grain - 1) / grain;
+	if (chunkCount == 1 || _threads.empty() || _inParallelFor) {
+		RunChunks(job);
+		return;
+	}
+
+	_inParallelFor = true;
+
+	// The calling thread takes one share of chunks itself
+	auto taskCount = std::min(_threads.size(), chunkCount - 1);
+	for (size_t i = 0; i < taskCount; ++i) {
+		_parallelTasks[i] = {
+			.callbackIn = &RunChunks,
+			.param = &job
+		};
+		_threads[i]->Push(&_parallelTasks[i]);
+	}
+
+	RunChunks(job);
+
+	// Tasks must be popped before the job goes out of scope. Other completed tasks are popped
+	// along the way, their callbacks out run here as they would in the main loop
+	for (size_t i = 0; i < taskCount; ++i) {
+		auto& thread = *_threads[i];
+		for (bool done = false; !done;) {
+			thread.WaitOne();
+			while (auto task = thread.TryPop()) {
+				if (task == &_parallelTasks[i]) {
+					done = true;
+				}
+			}
+		}
+	}
+
+	_inParallelFor = false;
+}
@@ -1,4 +1,27 @@
 #include <scenegraph/threading/WorkThread.h>
+#include <scenegraph/profiling/Trace.h>
+
+#include <chrono>
+#include <cassert>
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint64_t NowNanoseconds() noexcept {
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+} // namespace
 
 void Pipe::Push(PipeTask* task) noexcept {
 	auto tail = task;
@@ -6,8 +29,16 @@ void Pipe::Push(PipeTask* task) noexcept {
 		tail = tail->next;
 	}
 	
+	Push(task, tail);
+}
+
+void Pipe::Push(PipeTask* head, PipeTask* tail) noexcept {
+	TRACE_ZONE("Pipe::Push");
+	
+	assert(head && tail && !tail->next);
+	
 	tail->next = _incomingHead.load(std::memory_order::relaxed);
-	while (!_incomingHead.compare_exchange_weak(tail->next, task, std::memory_order::release, std::memory_order::relaxed))
+	while (!_incomingHead.compare_exchange_weak(tail->next, head, std::memory_order::seq_cst, std::memory_order::relaxed))
 		;
 	
 	Notify();
@@ -15,7 +46,7 @@ void Pipe::Push(PipeTask* task) noexcept {
 
 PipeTask* Pipe::Peek() noexcept {
 	if (!_outcomingHead) {
-		if (!(_outcomingHead = _incomingHead.exchange(nullptr, std::memory_order::relaxed))) {
+		if (!(_outcomingHead = _incomingHead.exchange(nullptr, std::memory_order::seq_cst))) {
 			return nullptr;
 		}
 		
@@ -35,6 +66,8 @@ PipeTask* Pipe::Peek() noexcept {
 }
 
 PipeTask* Pipe::TryPop() noexcept {
+	TRACE_ZONE("Pipe::TryPop");
+	
 	if (!Peek()) {
 		return nullptr;
 	}
@@ -43,8 +76,10 @@ PipeTask* Pipe::TryPop() noexcept {
 	_outcomingHead = _outcomingHead->next;
 	task->next = nullptr;
 	
+	// Sequentially consistent with Push, so either the consumer sees new tasks on the next Peek
+	// or the producer sees the flag cleared and wakes it up
 	if (!_outcomingHead) {
-		_busy.clear(std::memory_order::relaxed);
+		_busy.clear(std::memory_order::seq_cst);
 	}
 	
 	return task;
@@ -59,12 +94,42 @@ void Pipe::Wait() noexcept {
 }
 
 void Pipe::Notify() noexcept {
-	_busy.test_and_set(std::memory_order::relaxed);
-	_busy.notify_one();
+	// Only the transition to busy needs a wake-up, the consumer drains the queue before waiting again
+	if (!_busy.test_and_set(std::memory_order::seq_cst)) {
+		_busy.notify_one();
+	}
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 
+PipeTask* PipeTaskArena::New(void (*callbackIn)(void*), void (*callbackOut)(void*), void* param) noexcept {
+	auto pageIndex = _size / kPageSize;
+	if (pageIndex == _pages.size()) {
+		_pages.push_back(std::make_unique<PipeTask[]>(kPageSize));
+	}
+	
+	auto task = &_pages[pageIndex][_size++ % kPageSize];
+	*task = {
+		.callbackIn = callbackIn,
+		.callbackOut = callbackOut,
+		.param = param
+	};
+	return task;
+}
+
+void PipeTaskArena::Reset() noexcept {
+	_size = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+WorkThread::WorkThread(const WorkThreadOptions& options) noexcept
+	: _name(options.name ? options.name : "")
+	, _affinityMask(options.affinityMask)
+	, _priority(options.priority)
+{
+}
+
 WorkThread::~WorkThread() {
 	_stop.test_and_set(std::memory_order::relaxed);
 	_incoming.Notify();
@@ -86,13 +151,22 @@ void WorkThread::Push(PipeTask* task) noexcept {
 	_incoming.Push(task);
 }
 
+void WorkThread::Push(PipeTaskBatch& batch) noexcept {
+	if (batch.Empty()) {
+		return;
+	}
+	
+	_incoming.Push(batch.Head(), batch.Tail());
+	batch.Clear();
+}
+
 PipeTask* WorkThread::TryPop() noexcept {
-	if (auto task = _outcoming.Peek()) {
-		if (task->callbackOut) {
-			task->callbackOut(task->param);
-		}
+	// Pop before calling back, so the callback is free to push the task again
+	auto task = _outcoming.TryPop();
+	if (task && task->callbackOut) {
+		task->callbackOut(task->param);
 	}
-	return _outcoming.TryPop();
+	return task;
 }
 
 void WorkThread::WaitOne() noexcept {
@@ -107,16 +181,92 @@ void WorkThread::WaitAll() noexcept {
 	}
 }
 
+WorkThreadStats WorkThread::GetStats() const noexcept {
+	return {
+		.tasksExecuted = _tasksExecuted.load(std::memory_order::relaxed),
+		.busyNanoseconds = _busyNanoseconds.load(std::memory_order::relaxed),
+		.idleNanoseconds = _idleNanoseconds.load(std::memory_order::relaxed)
+	};
+}
+
 void WorkThread::ThreadBody() noexcept {
+	ApplyOptions();
+	
+	auto idleStart = NowNanoseconds();
+	
 	do {
 		_incoming.Wait();
 		
+		auto busyStart = NowNanoseconds();
+		_idleNanoseconds.fetch_add(busyStart - idleStart, std::memory_order::relaxed);
+		
 		while (auto task = _incoming.Peek()) {
+			TRACE_ZONE("WorkThread::Task");
+			
 			if (task->callbackIn) {
 				task->callbackIn(task->param);
 			}
+			// Counted before the task is handed back, so the counter is up to date once it's popped
+			_tasksExecuted.fetch_add(1, std::memory_order::relaxed);
 			_outcoming.Push(_incoming.TryPop());
 		}
+		
+		idleStart = NowNanoseconds();
+		_busyNanoseconds.fetch_add(idleStart - busyStart, std::memory_order::relaxed);
 	}
 	while (!_stop.test(std::memory_order::relaxed));
 }
+
+// Options are applied by the thread itself, so there is no need to keep the native handle around
+void WorkThread::ApplyOptions() noexcept {
+	TRACE_THREAD_NAME(_name.empty() ? "WorkThread" : _name.c_str());
+	
+#if defined(__APPLE__)
+	if (!_name.empty()) {
+		pthread_setname_np(_name.c_str());
+	}
+	
+	// There is no affinity on Apple platforms, quality of service picks the core type instead
+	switch (_priority) {
+	case WorkThreadPriority::Low:
+		pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+		break;
+	case WorkThreadPriority::High:
+		pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+		break;
+	case WorkThreadPriority::Normal:
+		break;
+	}
+#elif defined(__linux__)
+	if (!_name.empty()) {
+		// The name is limited to 16 bytes including the terminating null
+		char name[16] = {};
+		_name.copy(name, sizeof(name) - 1);
+		pthread_setname_np(pthread_self(), name);
+	}
+	
+	if (_affinityMask) {
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+			if (_affinityMask & (uint64_t{1} << cpu)) {
+				CPU_SET(cpu, &cpuSet);
+			}
+		}
+		pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+	}
+	
+	// Nice value applies to the calling thread only on Linux. Raising priority requires privileges,
+	// so failures are ignored and the thread keeps running with normal priority
+	switch (_priority) {
+	case WorkThreadPriority::Low:
+		setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 10);
+		break;
+	case WorkThreadPriority::High:
+		setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), -5);
+		break;
+	case WorkThreadPriority::Normal:
+		break;
+	}
+#endif
+}